@@ -3,6 +3,7 @@
 #include <cstdlib>
 
 #include "HalideBuffer.h"
+#include "halide_benchmark.h"
 #include "pipeline_c.h"
 #include "pipeline_native.h"
 
@@ -62,6 +63,17 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Compare the speed of the C backend's output, compiled by the C++
+    // compiler, with the speed of the LLVM backend's output.
+    double t_native = Halide::Tools::benchmark(10, 10, [&]() {
+        pipeline_native(in, out_native);
+    });
+    double t_c = Halide::Tools::benchmark(10, 10, [&]() {
+        pipeline_c(in, out_c);
+    });
+    printf("Native time: %gms\n", t_native * 1e3);
+    printf("C backend time: %gms\n", t_c * 1e3);
+
     printf("Success!\n");
     return 0;
 }
@@ -513,6 +513,14 @@ function(_halide_runtime_target_name HALIDE_TARGET OUTVAR)
         check_unsafe_promises
         hexagon_dma
         embed_bitcode
+        avx512_cascadelake
+        avx512_cooperlake
+        arm_dot_prod
+        arm_fp16
+        arena_allocations
+        memory_budget
+        multiversion_loops
+        relaxed_float16
       )
     # Synthesize a one-or-two-char abbreviation based on the feature's position
     # in the KNOWN_FEATURES list.
@@ -0,0 +1,71 @@
+"""
+Measures the overhead of calling a small jit-compiled pipeline from
+Python on NumPy data, for comparison with the C++ numbers reported by
+test/performance/realize_overhead.cpp.
+"""
+
+import halide as hl
+
+import numpy as np
+import threading
+import time
+
+def get_pipeline():
+    x, y = hl.Var("x"), hl.Var("y")
+    input = hl.ImageParam(hl.Float(32), 2, "input")
+    f = hl.Func("f")
+    f[x, y] = input[x, y] * 2 + 1
+    return input, f
+
+def benchmark(fn, iterations):
+    best = float("inf")
+    for trial in range(5):
+        t = time.time()
+        for i in range(iterations):
+            fn()
+        best = min(best, (time.time() - t) / iterations)
+    return best
+
+def main():
+    input, f = get_pipeline()
+    f.compile_jit()
+
+    # Wrap the NumPy arrays once; the Buffers share their storage.
+    in_array = np.ones((16, 16), dtype=np.float32)
+    out_array = np.zeros((16, 16), dtype=np.float32)
+    in_buf = hl.Buffer(in_array, reverse_axes=True)
+    out_buf = hl.Buffer(out_array, reverse_axes=True)
+    input.set(in_buf)
+
+    iterations = 1000
+    t = benchmark(lambda: f.realize(out_buf), iterations)
+    assert np.all(out_array == 3)
+    print("Realize into an existing buffer: %f us per call" % (t * 1e6))
+
+    t = benchmark(lambda: f.realize([16, 16]), iterations)
+    print("Realize into a new buffer: %f us per call" % (t * 1e6))
+
+    # The GIL is released while the pipeline runs, so several threads
+    # can run it at once.
+    num_threads = 4
+    outputs = [np.zeros((16, 16), dtype=np.float32) for i in range(num_threads)]
+    def run(out):
+        buf = hl.Buffer(out, reverse_axes=True)
+        for i in range(iterations):
+            f.realize(buf)
+    start = time.time()
+    threads = [threading.Thread(target=run, args=(out,)) for out in outputs]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.time() - start
+    for out in outputs:
+        assert np.all(out == 3)
+    print("Realize from %d threads: %f us per call" % (num_threads, elapsed * 1e6 / (iterations * num_threads)))
+
+    print("Success!")
+    return 0
+
+if __name__ == "__main__":
+    main()
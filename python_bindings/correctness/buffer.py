@@ -123,6 +123,102 @@ def test_float16():
     hl_img = hl.Buffer(array_in)
     array_out = np.array(hl_img, copy = False)
 
+def test_ndarray_strides():
+    a0 = np.arange(24 * 30, dtype=np.int16).reshape((24, 30))
+
+    # Non-contiguous views are shared, not copied, with the
+    # view's strides (including negative ones) in the Buffer.
+    strided = a0[::2, ::3]
+    b0 = hl.Buffer(strided)
+    assert b0.dim(0).extent() == 12
+    assert b0.dim(0).stride() == 60
+    assert b0.dim(1).extent() == 10
+    assert b0.dim(1).stride() == 3
+    assert b0[5, 7] == strided[5, 7]
+    b0[5, 7] = -1
+    assert a0[10, 21] == -1
+
+    flipped = a0[::-1, :]
+    b1 = hl.Buffer(flipped)
+    assert b1.dim(0).stride() == -30
+    assert b1[0, 4] == a0[23, 4]
+
+    # Read-only arrays can still be wrapped without copying.
+    a1 = np.arange(24 * 30, dtype=np.int16).reshape((24, 30))
+    a1.flags.writeable = False
+    b2 = hl.Buffer(a1)
+    assert b2[3, 4] == a1[3, 4]
+
+    # But writing to them, including realizing into them, is an error.
+    x, y = hl.Var("x"), hl.Var("y")
+    f = hl.Func("f")
+    f[x, y] = hl.cast(hl.Int(16), 0)
+    for write in [lambda: b2.__setitem__([3, 4], 0),
+                  lambda: b2.fill(0),
+                  lambda: f.realize(b2)]:
+        try:
+            write()
+        except ValueError as e:
+            assert 'read-only' in str(e)
+        else:
+            assert False, 'Writing to a read-only Buffer should be an error'
+    assert a1[3, 4] == 3 * 30 + 4
+
+
+def test_reverse_axes():
+    # Row-major data indexed as [y, x] in NumPy is indexed as [x, y] in Halide.
+    a0 = np.zeros((20, 30), dtype=np.float32)
+    a0[2, 3] = 42
+    b0 = hl.Buffer(a0, reverse_axes=True)
+    assert b0.width() == 30
+    assert b0.height() == 20
+    assert b0.dim(0).stride() == 1
+    assert b0[3, 2] == 42
+
+    # And back again, still sharing storage.
+    b0[4, 5] = 7
+    a1 = np.array(b0.reverse_axes(), copy = False)
+    assert a1.shape == (20, 30)
+    assert a1[5, 4] == 7
+    a1[6, 7] = 8
+    assert a0[6, 7] == 8
+
+
+def test_realize_releases_gil():
+    import threading
+
+    x, y = hl.Var("x"), hl.Var("y")
+    f = hl.Func("f")
+    f[x, y] = x + y * 3
+    f.compile_jit()
+
+    # Several Python threads can realize into their own (NumPy-backed)
+    # outputs concurrently.
+    outputs = [np.zeros((64, 32), dtype=np.int32) for i in range(8)]
+    def run(out):
+        buf = hl.Buffer(out, reverse_axes=True)
+        for i in range(10):
+            f.realize(buf)
+    threads = [threading.Thread(target=run, args=(out,)) for out in outputs]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    for out in outputs:
+        assert out[5, 4] == 4 + 5 * 3
+
+
+def test_print_without_gil():
+    # Pipelines that print call back into Python while realize has
+    # released the GIL.
+    x = hl.Var("x")
+    f = hl.Func("f")
+    f[x] = hl.print(x)
+    b = f.realize(10)
+    assert b[7] == 7
+
+
 if __name__ == "__main__":
     test_ndarray_to_buffer()
     test_buffer_to_ndarray()
@@ -130,4 +226,7 @@ if __name__ == "__main__":
     test_fill_all_equal()
     test_bufferinfo_sharing()
     test_float16()
-
+    test_ndarray_strides()
+    test_reverse_axes()
+    test_realize_releases_gil()
+    test_print_without_gil()
@@ -0,0 +1,44 @@
+import halide as hl
+
+
+def test_pipeline_state():
+    x = hl.Var('x')
+    previous = hl.ImageParam(hl.Int(32), 1, 'previous')
+
+    # A running sum over calls to realize.
+    f = hl.Func('f')
+    f[x] = previous[x] + x
+
+    p = hl.Pipeline(f)
+    p.add_state(f, previous)
+
+    for n in range(1, 4):
+        out = p.realize(10)
+        for i in range(10):
+            assert out[i] == n * i
+
+    # Realizing into a buffer we made also updates the state.
+    buf = hl.Buffer(hl.Int(32), [10])
+    p.realize(buf)
+    assert buf[3] == 12
+    out = p.realize(10)
+    assert out[3] == 15
+
+    # After a reset, the previous values are zero again.
+    p.reset_state()
+    out = p.realize(10)
+    assert out[3] == 3
+
+    # Only outputs of the pipeline can be state.
+    g = hl.Func('g')
+    g[x] = x
+    try:
+        p.add_state(g, previous)
+    except RuntimeError as e:
+        assert 'not an output of the Pipeline' in str(e)
+    else:
+        assert False, 'Did not see expected exception!'
+
+
+if __name__ == "__main__":
+    test_pipeline_state()
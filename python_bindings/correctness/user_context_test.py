@@ -8,5 +8,20 @@ def test():
     assert output == bytearray("qqqq", "ascii")
 
 
+def test_batch():
+    # A list of outputs, with one constant per item.
+    outputs = [bytearray(4) for i in range(3)]
+    user_context.user_context_batch(None, [ord('a'), ord('b'), ord('c')], outputs)
+    assert outputs == [bytearray(c * 4, "ascii") for c in "abc"]
+
+    # Outputs stacked along an extra outermost dimension, with the
+    # constant shared by every item.
+    stacked = bytearray(8)
+    view = memoryview(stacked).cast('B', (2, 4))
+    user_context.user_context_batch(None, ord('z'), view)
+    assert stacked == bytearray("zzzzzzzz", "ascii")
+
+
 if __name__ == "__main__":
     test()
+    test_batch()
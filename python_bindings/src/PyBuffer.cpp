@@ -1,5 +1,8 @@
 #include "PyBuffer.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "PyFunc.h"
 #include "PyType.h"
 
@@ -62,6 +65,7 @@ inline std::string format_descriptor<float16_t>() {
 }
 
 void call_fill(Buffer<> &b, py::object value) {
+    check_writable(b);
 
     #define HANDLE_BUFFER_TYPE(TYPE) \
         if (b.type() == type_of<TYPE>()) { b.as<TYPE>().fill(value_cast<TYPE>(value)); return; }
@@ -216,30 +220,66 @@ py::object buffer_setitem_operator(Buffer<> &buf, const std::vector<int> &pos, p
 
 // Use an alias class so that if we are created via a py::buffer, we can
 // keep the py::buffer_info class alive for the life of the Buffer<>,
-// ensuring the data isn't collected out from under us.
+// ensuring the data isn't collected out from under us. The data is
+// never copied: any strides (including negative ones, as produced by
+// reversed slices) are expressed directly in the Buffer<>'s shape.
 class PyBuffer : public Buffer<> {
     py::buffer_info info;
 
-    static std::vector<halide_dimension_t> make_dim_vec(const py::buffer_info &info) {
+    static std::vector<halide_dimension_t> make_dim_vec(const py::buffer_info &info, bool reverse_axes) {
         const Type t = format_descriptor_to_type(info.format);
         std::vector<halide_dimension_t> dims;
         dims.reserve(info.ndim);
         for (int i = 0; i < info.ndim; i++) {
-            // TODO: check for ssize_t -> int32_t overflow
-            dims.push_back({0, (int32_t) info.shape[i], (int32_t) (info.strides[i] / t.bytes())});
+            if (info.strides[i] % t.bytes() != 0) {
+                throw py::value_error("Buffer strides must be a multiple of the element size.");
+            }
+            const ssize_t extent = info.shape[i];
+            const ssize_t stride = info.strides[i] / t.bytes();
+            if (extent > std::numeric_limits<int32_t>::max() ||
+                stride > std::numeric_limits<int32_t>::max() ||
+                stride < std::numeric_limits<int32_t>::min()) {
+                throw py::value_error("Buffer extents and strides must fit in 32 bits.");
+            }
+            dims.push_back({0, (int32_t) extent, (int32_t) stride});
+        }
+        if (reverse_axes) {
+            std::reverse(dims.begin(), dims.end());
         }
         return dims;
     }
 
-    PyBuffer(py::buffer_info &&info, const std::string &name)
+    struct Request {
+        py::buffer_info info;
+        bool read_only;
+    };
+
+    // Read-only buffers (e.g. ndarrays with writeable=False) are
+    // still useful as pipeline inputs, so fall back to requesting
+    // them without write access rather than failing. The resulting
+    // Buffer is marked read-only, so that writing to it is an error.
+    static Request request(py::buffer &buffer) {
+        try {
+            return {buffer.request(/*writable*/ true), false};
+        } catch (py::error_already_set &) {
+            PyErr_Clear();
+            return {buffer.request(/*writable*/ false), true};
+        }
+    }
+
+    PyBuffer(Request &&r, const std::string &name, bool reverse_axes)
         : Buffer<>(
-            format_descriptor_to_type(info.format),
-            info.ptr,
-            (int) info.ndim,
-            make_dim_vec(info).data(),
+            format_descriptor_to_type(r.info.format),
+            r.info.ptr,
+            (int) r.info.ndim,
+            make_dim_vec(r.info, reverse_axes).data(),
             name
         ),
-        info(std::move(info)) {}
+        info(std::move(r.info)) {
+        if (r.read_only) {
+            raw_buffer()->flags |= buffer_flag_read_only;
+        }
+    }
 
 public:
     PyBuffer()
@@ -248,14 +288,20 @@ public:
     explicit PyBuffer(const Buffer<> &b)
         : Buffer<>(b), info() {}
 
-    PyBuffer(py::buffer buffer, const std::string &name)
-        : PyBuffer(buffer.request(/*writable*/ true), name) {}
+    PyBuffer(py::buffer buffer, const std::string &name, bool reverse_axes)
+        : PyBuffer(request(buffer), name, reverse_axes) {}
 
     virtual ~PyBuffer() {}
 };
 
 }  // namespace
 
+void check_writable(const Buffer<> &b) {
+    if (b.defined() && (b.raw_buffer()->flags & buffer_flag_read_only)) {
+        throw py::value_error("Buffer " + b.name() + " wraps a read-only Python buffer and cannot be written to.");
+    }
+}
+
 void define_buffer(py::module &m) {
     using BufferDimension = Halide::Runtime::Buffer<>::Dimension;
 
@@ -296,8 +342,11 @@ void define_buffer(py::module &m) {
         })
 
         // This allows us to use any buffer-like python entity to create a Buffer<>
-        // (most notably, an ndarray)
-        .def(py::init_alias<py::buffer, const std::string &>(), py::arg("buffer"), py::arg("name") = "")
+        // (most notably, an ndarray). The data is shared, not copied. If reverse_axes
+        // is true, the dimensions are reversed, so that a row-major ndarray indexed
+        // as [y, x] becomes a Buffer<> indexed as [x, y].
+        .def(py::init_alias<py::buffer, const std::string &, bool>(),
+            py::arg("buffer"), py::arg("name") = "", py::arg("reverse_axes") = false)
         .def(py::init_alias<>())
         .def(py::init_alias<const Buffer<> &>())
         .def(py::init([](Type type, const std::vector<int> &sizes, const std::string &name) -> Buffer<> {
@@ -347,12 +396,17 @@ void define_buffer(py::module &m) {
         }, py::arg("dirty") = true)
 
         .def("copy", &Buffer<>::copy)
-        .def("copy_from", &Buffer<>::copy_from<void>)
+        .def("copy_from", [](Buffer<> &b, const Buffer<> &other) -> void {
+            check_writable(b);
+            b.copy_from(other);
+        })
 
         .def("add_dimension", (void (Buffer<>::*)()) &Buffer<>::add_dimension)
 
         .def("allocate", [](Buffer<> &b) -> void {
             b.allocate(nullptr, nullptr);
+            // The new allocation is our own, so it can be written.
+            b.raw_buffer()->flags &= ~buffer_flag_read_only;
         })
         .def("deallocate", (void (Buffer<>::*)()) &Buffer<>::deallocate)
         .def("device_deallocate", (void (Buffer<>::*)()) &Buffer<>::device_deallocate)
@@ -419,6 +473,17 @@ void define_buffer(py::module &m) {
             b.transpose(d1, d2);
         }, py::arg("d1"), py::arg("d2"))
 
+        // Return a Buffer<> that shares storage with this one, but with the
+        // dimensions in the opposite order. Useful for handing row-major data
+        // to and from NumPy without copying.
+        .def("reverse_axes", [](Buffer<> &b) -> Buffer<> {
+            Buffer<> reversed(Runtime::Buffer<>(*b.get()), b.name());
+            for (int i = 0; i < b.dimensions() / 2; i++) {
+                reversed.transpose(i, b.dimensions() - 1 - i);
+            }
+            return reversed;
+        }, py::keep_alive<0, 1>()) // Keep the source alive while the view exists
+
         // Present in Runtime::Buffer but not Buffer
         // .def("transposed", [](Buffer<> &b, int d1, int d2) -> Buffer<> {
         //     return b.transposed(d1, d2);
@@ -504,9 +569,11 @@ void define_buffer(py::module &m) {
         })
 
         .def("__setitem__", [](Buffer<> &buf, const int &pos, py::object value) -> py::object {
+            check_writable(buf);
             return buffer_setitem_operator(buf, {pos}, value);
         })
         .def("__setitem__", [](Buffer<> &buf, const std::vector<int> &pos, py::object value) -> py::object {
+            check_writable(buf);
             return buffer_setitem_operator(buf, pos, value);
         })
 
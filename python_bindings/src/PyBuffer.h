@@ -8,6 +8,16 @@ namespace PythonBindings {
 
 void define_buffer(py::module &m);
 
+// Set in the flags of a Buffer that wraps a read-only Python buffer
+// (e.g. an ndarray with writeable=False). The runtime ignores flags it
+// doesn't know about.
+constexpr uint64_t buffer_flag_read_only = (uint64_t) 1 << 63;
+
+// Throw a ValueError if the Buffer wraps a read-only Python buffer.
+// Call this before anything that writes to a Buffer, including
+// realizing into it.
+void check_writable(const Buffer<> &b);
+
 }  // namespace PythonBindings
 }  // namespace Halide
 
@@ -129,6 +129,14 @@ void define_enums(py::module &m) {
         .value("AVX512_KNL", Target::Feature::AVX512_KNL)
         .value("AVX512_Skylake", Target::Feature::AVX512_Skylake)
         .value("AVX512_Cannonlake", Target::Feature::AVX512_Cannonlake)
+        .value("AVX512_Cascadelake", Target::Feature::AVX512_Cascadelake)
+        .value("AVX512_Cooperlake", Target::Feature::AVX512_Cooperlake)
+        .value("ARMDotProd", Target::Feature::ARMDotProd)
+        .value("ARMFp16", Target::Feature::ARMFp16)
+        .value("ArenaAllocations", Target::Feature::ArenaAllocations)
+        .value("MemoryBudget", Target::Feature::MemoryBudget)
+        .value("MultiversionLoops", Target::Feature::MultiversionLoops)
+        .value("RelaxedFloat16", Target::Feature::RelaxedFloat16)
         .value("TraceLoads", Target::Feature::TraceLoads)
         .value("TraceStores", Target::Feature::TraceStores)
         .value("TraceRealizations", Target::Feature::TraceRealizations)
@@ -9,13 +9,17 @@ void halide_python_error(void *, const char *msg) {
     throw Error(msg);
 }
 
+// realize and compile_jit release the GIL, so these may be called
+// without it.
 void halide_python_print(void *, const char *msg) {
+    py::gil_scoped_acquire acquire;
     py::print(msg, py::arg("end") = "");
 }
 
 class HalidePythonCompileTimeErrorReporter : public CompileTimeErrorReporter {
 public:
     void warning(const char* msg) {
+        py::gil_scoped_acquire acquire;
         py::print(msg, py::arg("end") = "");
     }
 
@@ -46,6 +46,18 @@ py::object realization_to_object(const Realization &r) {
     return to_python_tuple(r);
 }
 
+// Run a realization with the GIL released, so that other Python threads
+// (including ones running other pipelines) can make progress meanwhile.
+template<typename Fn>
+py::object realize_without_gil(Fn &&realize) {
+    std::unique_ptr<Realization> r;
+    {
+        py::gil_scoped_release release;
+        r.reset(new Realization(realize()));
+    }
+    return realization_to_object(*r);
+}
+
 }  // namespace
 
 void define_func(py::module &m) {
@@ -83,36 +95,42 @@ void define_func(py::module &m) {
         .def(py::init([](const ImageParam &im) -> Func { return im; }))
 
         .def("realize", [](Func &f, Buffer<> buffer, const Target &target, const ParamMap &param_map) -> void {
-            f.realize(buffer, target);
+            check_writable(buffer);
+            py::gil_scoped_release release;
+            f.realize(buffer, target, param_map);
         }, py::arg("dst"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // This will actually allow a list-of-buffers as well as a tuple-of-buffers, but that's OK.
         .def("realize", [](Func &f, std::vector<Buffer<>> buffers, const Target &t, const ParamMap &param_map) -> void {
-            f.realize(Realization(buffers), t);
+            for (const Buffer<> &b : buffers) {
+                check_writable(b);
+            }
+            py::gil_scoped_release release;
+            f.realize(Realization(buffers), t, param_map);
         }, py::arg("dst"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         .def("realize", [](Func &f, std::vector<int32_t> sizes, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(sizes, target, param_map));
+            return realize_without_gil([&]() { return f.realize(sizes, target, param_map); });
         }, py::arg("sizes") = std::vector<int32_t>{}, py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Func &f, int x_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(x_size, target, param_map));
+            return realize_without_gil([&]() { return f.realize(x_size, target, param_map); });
         }, py::arg("x_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Func &f, int x_size, int y_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(x_size, y_size, target, param_map));
+            return realize_without_gil([&]() { return f.realize(x_size, y_size, target, param_map); });
         }, py::arg("x_size"), py::arg("y_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Func &f, int x_size, int y_size, int z_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(x_size, y_size, z_size, target, param_map));
+            return realize_without_gil([&]() { return f.realize(x_size, y_size, z_size, target, param_map); });
         }, py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Func &f, int x_size, int y_size, int z_size, int w_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(f.realize(x_size, y_size, z_size, w_size, target, param_map));
+            return realize_without_gil([&]() { return f.realize(x_size, y_size, z_size, w_size, target, param_map); });
         }, py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("w_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         .def("defined", &Func::defined)
@@ -150,6 +168,7 @@ void define_func(py::module &m) {
             py::arg("loop_level"))
 
         .def("memoize", &Func::memoize)
+        .def("auto_fuse", &Func::auto_fuse)
         .def("compute_inline", &Func::compute_inline)
         .def("compute_root", &Func::compute_root)
         .def("store_root", &Func::store_root)
@@ -213,7 +232,10 @@ void define_func(py::module &m) {
         .def("compile_to_module", &Func::compile_to_module,
             py::arg("arguments"), py::arg("fn_name") = "", py::arg("target") = get_target_from_environment())
 
-        .def("compile_jit", &Func::compile_jit, py::arg("target") = get_jit_target_from_environment())
+        .def("compile_jit", (void *(Func::*)(const Target &)) &Func::compile_jit, py::arg("target") = get_jit_target_from_environment(),
+            py::call_guard<py::gil_scoped_release>())
+        .def("compile_jit", (void *(Func::*)(const std::vector<Target> &)) &Func::compile_jit, py::arg("targets"),
+            py::call_guard<py::gil_scoped_release>())
 
         .def("has_update_definition", &Func::has_update_definition)
         .def("num_update_definitions", &Func::num_update_definitions)
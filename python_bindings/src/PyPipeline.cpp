@@ -1,5 +1,6 @@
 #include "PyPipeline.h"
 
+#include "PyBuffer.h"
 #include "PyTuple.h"
 
 namespace Halide {
@@ -17,6 +18,18 @@ py::object realization_to_object(const Realization &r) {
     return to_python_tuple(r);
 }
 
+// Run a realization with the GIL released, so that other Python threads
+// (including ones running other pipelines) can make progress meanwhile.
+template<typename Fn>
+py::object realize_without_gil(Fn &&realize) {
+    std::unique_ptr<Realization> r;
+    {
+        py::gil_scoped_release release;
+        r.reset(new Realization(realize()));
+    }
+    return realization_to_object(*r);
+}
+
 }  // namespace
 
 void define_pipeline(py::module &m) {
@@ -80,41 +93,51 @@ void define_pipeline(py::module &m) {
             py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment(), py::arg("linkage") = LinkageType::ExternalPlusMetadata)
 
         .def("compile_jit", [](Pipeline &p, const Target &target) -> void {
-            (void) p.compile_jit();
-        }, py::arg("target") = get_jit_target_from_environment())
+            (void) p.compile_jit(target);
+        }, py::arg("target") = get_jit_target_from_environment(),
+            py::call_guard<py::gil_scoped_release>())
 
+        .def("add_state", &Pipeline::add_state,
+            py::arg("state"), py::arg("previous"))
+        .def("reset_state", &Pipeline::reset_state)
 
         .def("realize", [](Pipeline &p, Buffer<> buffer, const Target &target, const ParamMap &param_map) -> void {
-            p.realize(Realization(buffer), target);
+            check_writable(buffer);
+            py::gil_scoped_release release;
+            p.realize(Realization(buffer), target, param_map);
         }, py::arg("dst"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // This will actually allow a list-of-buffers as well as a tuple-of-buffers, but that's OK.
         .def("realize", [](Pipeline &p, std::vector<Buffer<>> buffers, const Target &t, const ParamMap &param_map) -> void {
-            p.realize(Realization(buffers), t);
+            for (const Buffer<> &b : buffers) {
+                check_writable(b);
+            }
+            py::gil_scoped_release release;
+            p.realize(Realization(buffers), t, param_map);
         }, py::arg("dst"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         .def("realize", [](Pipeline &p, std::vector<int32_t> sizes, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(sizes, target, param_map));
+            return realize_without_gil([&]() { return p.realize(sizes, target, param_map); });
         }, py::arg("sizes") = std::vector<int32_t>{}, py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Pipeline &p, int x_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(x_size, target, param_map));
+            return realize_without_gil([&]() { return p.realize(x_size, target, param_map); });
         }, py::arg("x_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Pipeline &p, int x_size, int y_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(x_size, y_size, target, param_map));
+            return realize_without_gil([&]() { return p.realize(x_size, y_size, target, param_map); });
         }, py::arg("x_size"), py::arg("y_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Pipeline &p, int x_size, int y_size, int z_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(x_size, y_size, z_size, target, param_map));
+            return realize_without_gil([&]() { return p.realize(x_size, y_size, z_size, target, param_map); });
         }, py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         // TODO: deprecate in favor of std::vector<int32_t> size version?
         .def("realize", [](Pipeline &p, int x_size, int y_size, int z_size, int w_size, const Target &target, const ParamMap &param_map) -> py::object {
-            return realization_to_object(p.realize(x_size, y_size, z_size, w_size, target, param_map));
+            return realize_without_gil([&]() { return p.realize(x_size, y_size, z_size, w_size, target, param_map); });
         }, py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("w_size"), py::arg("target") = Target(), py::arg("param_map") = ParamMap())
 
         .def("infer_input_bounds", [](Pipeline &p, int x_size, int y_size, int z_size, int w_size, const ParamMap &param_map) -> void {
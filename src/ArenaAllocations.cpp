@@ -0,0 +1,337 @@
+#include <algorithm>
+
+#include "ArenaAllocations.h"
+#include "CodeGen_Internal.h"
+#include "ExprUsesVar.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Simplify.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Each slice of the arena is rounded up to this many bytes, which is
+// as aligned as any halide_malloc implementation promises to be.
+const int arena_alignment = 128;
+
+// Can an expression be evaluated earlier than where it appears in
+// the program? Loads and impure calls might depend on side-effects
+// of the code we'd be hoisting it above.
+class CanHoist : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) override {
+        result = false;
+    }
+
+    void visit(const Call *op) override {
+        if (!op->is_pure() && !starts_with(op->name, "_halide_buffer_get_")) {
+            result = false;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = true;
+};
+
+bool can_hoist(Expr e) {
+    CanHoist c;
+    e.accept(&c);
+    return c.result;
+}
+
+bool is_heap_allocation(const Allocate *op) {
+    if (op->new_expr.defined() || !op->free_function.empty() || op->extents.empty()) {
+        return false;
+    }
+    if (op->memory_type == MemoryType::Heap) {
+        return true;
+    }
+    if (op->memory_type == MemoryType::Auto) {
+        // Small constant-sized allocations go on the stack.
+        int64_t size = op->constant_allocation_size();
+        return size == 0 || !can_allocation_fit_on_stack(size * (int64_t)op->type.bytes());
+    }
+    return false;
+}
+
+// A heap allocation that could be moved into an arena.
+struct Slice {
+    const Allocate *op;
+    // The statements from the root of the region down to and
+    // including the Allocate node.
+    vector<const IRNode *> path;
+    // The LetStmts on the path above the Allocate node, and their
+    // depth in the path.
+    vector<std::pair<const LetStmt *, size_t>> lets;
+    // The positions in the region of the Allocate node and the
+    // corresponding Free node.
+    int start, end;
+};
+
+// Walk the straight-line code at one loop level in program order,
+// numbering the statements and recording where each heap allocation
+// begins and ends.
+class FindSlices {
+    vector<const IRNode *> path;
+    vector<std::pair<const LetStmt *, size_t>> lets;
+    map<string, size_t> open;
+    int pos = 0;
+
+public:
+    vector<Slice> slices;
+
+    void walk(const Stmt &s) {
+        path.push_back(s.get());
+        if (const LetStmt *op = s.as<LetStmt>()) {
+            lets.push_back({op, path.size() - 1});
+            walk(op->body);
+            lets.pop_back();
+        } else if (const Block *op = s.as<Block>()) {
+            walk(op->first);
+            walk(op->rest);
+        } else if (const ProducerConsumer *op = s.as<ProducerConsumer>()) {
+            walk(op->body);
+        } else if (const Allocate *op = s.as<Allocate>()) {
+            if (is_heap_allocation(op)) {
+                size_t idx = slices.size();
+                slices.push_back({op, path, lets, pos++, -1});
+                open[op->name] = idx;
+                walk(op->body);
+                if (open.count(op->name)) {
+                    // There was no Free at this level, so it's live
+                    // for its entire body.
+                    slices[idx].end = pos++;
+                    open.erase(op->name);
+                }
+            } else {
+                pos++;
+                walk(op->body);
+            }
+        } else if (const Free *op = s.as<Free>()) {
+            auto it = open.find(op->name);
+            if (it != open.end()) {
+                slices[it->second].end = pos;
+                open.erase(it);
+            }
+            pos++;
+        } else {
+            // Anything else (loops, if statements, forks, stores,
+            // etc) is a single step in the program as far as the
+            // allocations at this level are concerned.
+            pos++;
+        }
+        path.pop_back();
+    }
+};
+
+// The number of bytes of the arena needed for a slice, as an
+// expression that can be evaluated at the given depth of its path.
+Expr slice_size(const Slice &slice, size_t depth) {
+    const Allocate *op = slice.op;
+    int elem_bytes = op->type.bytes() * op->type.lanes();
+    Expr size = make_const(Int(64), elem_bytes);
+    for (const Expr &e : op->extents) {
+        size *= cast(Int(64), e);
+    }
+    // Codegen pads heap allocations by one element, because we may
+    // load a scalar past the end when vectorizing.
+    size += elem_bytes;
+    size = ((size + arena_alignment - 1) / arena_alignment) * arena_alignment;
+    if (!is_one(op->condition)) {
+        size = select(op->condition, size, make_zero(Int(64)));
+    }
+
+    // Wrap it in any lets between the arena and the allocation.
+    for (auto it = slice.lets.rbegin(); it != slice.lets.rend(); it++) {
+        if (it->second >= depth && expr_uses_var(size, it->first->name)) {
+            size = Let::make(it->first->name, it->first->value, size);
+        }
+    }
+    return size;
+}
+
+// The depth of the deepest statement that contains all the slices.
+size_t common_depth(const vector<Slice> &slices) {
+    size_t depth = slices[0].path.size() - 1;
+    for (const Slice &s : slices) {
+        size_t d = 0;
+        while (d < depth && d + 1 < s.path.size() &&
+               s.path[d + 1] == slices[0].path[d + 1]) {
+            d++;
+        }
+        depth = std::min(depth, d);
+    }
+    return depth;
+}
+
+// Rewrite the slices to point into the arena, and wrap the
+// statement at the common depth in the arena allocation.
+class InjectArena : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Stmt visit(const Allocate *op) override {
+        auto it = offsets.find(op);
+        if (it == offsets.end()) {
+            return IRMutator2::visit(op);
+        }
+        Expr base = reinterpret(UInt(64), Variable::make(Handle(), arena));
+        Expr ptr = reinterpret(Handle(), base + it->second);
+        // The arena is freed as a whole, so freeing a slice does
+        // nothing.
+        return Allocate::make(op->name, op->type, op->memory_type, op->extents, op->condition,
+                              mutate(op->body), ptr, "halide_device_host_nop_free");
+    }
+
+    Stmt make_arena(Stmt body) {
+        Expr total = Variable::make(Int(64), arena + ".size");
+        // The extent of the arena is 32-bit, so it is subject to
+        // the same size limit as any other buffer.
+        Expr max_size = make_const(Int(64), ((int64_t)1 << 31) - 1);
+        Expr error = Call::make(Int(32), "halide_error_buffer_allocation_too_large",
+                                {arena, cast(UInt(64), total), cast(UInt(64), max_size)},
+                                Call::Extern);
+        Stmt stmt = Allocate::make(arena, UInt(8), MemoryType::Heap,
+                                   {cast(Int(32), total)}, const_true(), body);
+        stmt = Block::make(AssertStmt::make(total <= max_size, error), stmt);
+        for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+            stmt = LetStmt::make(it->first, it->second, stmt);
+        }
+        return stmt;
+    }
+
+public:
+    const IRNode *root;
+    string arena;
+    map<const Allocate *, Expr> offsets;
+    // The sizes of the slots and of the whole arena.
+    vector<std::pair<string, Expr>> lets;
+
+    using IRMutator2::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        Stmt result = IRMutator2::mutate(s);
+        if (s.get() == root) {
+            result = make_arena(result);
+        }
+        return result;
+    }
+};
+
+Stmt pack_region(Stmt s) {
+    FindSlices finder;
+    finder.walk(s);
+    vector<Slice> slices = finder.slices;
+
+    // Drop the slices whose sizes can't be computed at the top of the
+    // arena. Moving the arena deeper can only make this easier, so
+    // iterate until nothing changes.
+    size_t depth = 0;
+    while (slices.size() > 1) {
+        depth = common_depth(slices);
+        size_t old_size = slices.size();
+        slices.erase(std::remove_if(slices.begin(), slices.end(),
+                                    [&](const Slice &slice) {
+                                        return !can_hoist(slice_size(slice, depth));
+                                    }),
+                     slices.end());
+        if (slices.size() == old_size) {
+            break;
+        }
+    }
+
+    if (slices.size() < 2) {
+        return s;
+    }
+
+    // Assign the slices to slots with interval graph coloring. Sort
+    // by start, then put each slice in the first slot that is free.
+    std::sort(slices.begin(), slices.end(),
+              [](const Slice &a, const Slice &b) { return a.start < b.start; });
+    vector<Expr> slot_size;
+    vector<int> slot_free_at;
+    vector<size_t> slot_of(slices.size());
+    for (size_t i = 0; i < slices.size(); i++) {
+        Expr size = slice_size(slices[i], depth);
+        size_t slot = 0;
+        while (slot < slot_size.size() && slot_free_at[slot] >= slices[i].start) {
+            slot++;
+        }
+        if (slot == slot_size.size()) {
+            slot_size.push_back(size);
+            slot_free_at.push_back(slices[i].end);
+        } else {
+            slot_size[slot] = max(slot_size[slot], size);
+            slot_free_at[slot] = slices[i].end;
+        }
+        slot_of[i] = slot;
+    }
+
+    InjectArena injector;
+    injector.root = slices[0].path[depth];
+    injector.arena = unique_name("arena");
+    debug(3) << "Packing " << slices.size() << " allocations into "
+             << slot_size.size() << " slots of " << injector.arena << "\n";
+
+    // Compute the offset of each slot, and the total size.
+    vector<Expr> slot_offset;
+    Expr total = make_zero(Int(64));
+    for (size_t i = 0; i < slot_size.size(); i++) {
+        string size_name = injector.arena + ".slot." + std::to_string(i) + ".size";
+        injector.lets.push_back({size_name, simplify(slot_size[i])});
+        slot_offset.push_back(total);
+        total += Variable::make(Int(64), size_name);
+    }
+    injector.lets.push_back({injector.arena + ".size", simplify(total)});
+
+    for (size_t i = 0; i < slices.size(); i++) {
+        injector.offsets[slices[i].op] = cast(UInt(64), slot_offset[slot_of[i]]);
+    }
+    return injector.mutate(s);
+}
+
+class PackAllocationsIntoArenas : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Stmt visit(const For *op) override {
+        Stmt stmt = IRMutator2::visit(op);
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            return stmt;
+        }
+        op = stmt.as<For>();
+        internal_assert(op);
+        Stmt body = pack_region(op->body);
+        if (body.same_as(op->body)) {
+            return stmt;
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+    }
+};
+
+}  // namespace
+
+Stmt pack_allocations_into_arenas(Stmt s, const Target &t) {
+    if (t.has_gpu_feature() ||
+        t.features_any_of({Target::OpenGL, Target::OpenGLCompute}) ||
+        t.features_any_of({Target::HVX_64, Target::HVX_128}) ||
+        t.arch == Target::Hexagon ||
+        t.has_large_buffers() ||
+        t.has_feature(Target::Profile)) {
+        debug(1) << "Not packing allocations into arenas for target " << t.to_string() << "\n";
+        return s;
+    }
+    s = PackAllocationsIntoArenas().mutate(s);
+    return pack_region(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
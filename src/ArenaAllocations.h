@@ -0,0 +1,28 @@
+#ifndef HALIDE_ARENA_ALLOCATIONS_H
+#define HALIDE_ARENA_ALLOCATIONS_H
+
+/** \file
+ * Defines the lowering pass that packs the heap allocations at each
+ * loop level into a single arena.
+ */
+
+#include "IR.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Replace the heap allocations made at the same loop level with
+ * slices of a single heap allocation, so that a pipeline with many
+ * compute_root stages makes one call to halide_malloc per invocation
+ * instead of one per stage. Allocations whose lifetimes (as delimited
+ * by the Free nodes injected by inject_early_frees) don't overlap
+ * share the same slice, so the arena can also be smaller than the
+ * sum of the original allocations. Does nothing for targets with
+ * device APIs, Hexagon offload, large buffers, or profiling. */
+Stmt pack_allocations_into_arenas(Stmt s, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -0,0 +1,209 @@
+#include "AutoFuse.h"
+#include "Bounds.h"
+#include "ExprUsesVar.h"
+#include "FindCalls.h"
+#include "Func.h"
+#include "Function.h"
+#include "IROperator.h"
+#include "Simplify.h"
+
+#include <algorithm>
+#include <set>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// A Func that is eligible to be fused with its siblings, along with
+// the information we need to decide who its siblings are.
+struct Candidate {
+    Function func;
+    // The outermost loop (excluding __outermost) of the pure definition.
+    Dim outer;
+    // The region of each input read by one point of the Func, in terms
+    // of the Func's pure vars.
+    map<string, Box> footprint;
+    // The names of all Funcs this one depends on, including itself.
+    set<string> callees;
+};
+
+bool is_candidate(const Function &f, const set<string> &fuse_targets) {
+    if (!f.schedule().auto_fuse()) {
+        return false;
+    }
+
+    const char *reason = nullptr;
+    if (f.has_extern_definition()) {
+        reason = "it has an extern definition";
+    } else if (f.schedule().compute_level().is_inlined()) {
+        reason = "it is inlined";
+    } else if (f.has_update_definition()) {
+        // Fusing the pure definitions would interleave them with the
+        // other Func's loops but not the updates, which would need a
+        // dependence analysis over the RDoms we don't do here.
+        reason = "it has update definitions";
+    } else if (!f.definition().specializations().empty()) {
+        reason = "it has specializations";
+    } else if (!f.definition().schedule().fuse_level().level.is_inlined() ||
+               fuse_targets.count(f.name())) {
+        reason = "it already has a compute_with schedule";
+    } else if (f.schedule().async() || f.schedule().memoized()) {
+        reason = "it is async or memoized";
+    }
+
+    if (reason) {
+        debug(3) << "Not auto-fusing " << f.name() << " because " << reason << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Check whether the two Funcs read the same region of some input
+// along one dimension per iteration of the shared outermost loop, up
+// to a constant offset. The outermost loop then walks through that
+// input in lockstep in both Funcs, so fusing them means each load of
+// the input is reused while it is still in cache.
+bool shares_input(const Candidate &a, const Candidate &b) {
+    for (const auto &it : a.footprint) {
+        const string &input = it.first;
+        if (input == a.func.name() || input == b.func.name()) {
+            continue;
+        }
+        auto other = b.footprint.find(input);
+        if (other == b.footprint.end()) {
+            continue;
+        }
+        const Box &box_a = it.second;
+        const Box &box_b = other->second;
+        if (box_a.size() != box_b.size()) {
+            continue;
+        }
+        for (size_t i = 0; i < box_a.size(); i++) {
+            const Interval &ia = box_a[i];
+            const Interval &ib = box_b[i];
+            if (!ia.is_bounded() || !ib.is_bounded() ||
+                !expr_uses_var(ia.min, a.outer.var)) {
+                continue;
+            }
+            if (is_const(simplify(ia.min - ib.min)) &&
+                is_const(simplify(ia.max - ib.max))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool can_fuse(const Candidate &a, const Candidate &b) {
+    return (a.func.schedule().compute_level() == b.func.schedule().compute_level() &&
+            a.func.schedule().store_level() == b.func.schedule().store_level() &&
+            a.outer.var == b.outer.var &&
+            a.outer.for_type == b.outer.for_type &&
+            a.outer.device_api == b.outer.device_api &&
+            !a.callees.count(b.func.name()) &&
+            !b.callees.count(a.func.name()));
+}
+
+}  // namespace
+
+void auto_fuse_siblings(const map<string, Function> &env) {
+    // Funcs that something else is already computed with.
+    set<string> fuse_targets;
+    for (const auto &it : env) {
+        const Function &f = it.second;
+        if (!f.definition().defined()) {
+            continue;
+        }
+        vector<Definition> defs = f.updates();
+        defs.push_back(f.definition());
+        for (const Definition &def : defs) {
+            const LoopLevel &level = def.schedule().fuse_level().level;
+            if (!level.is_inlined() && !level.is_root()) {
+                fuse_targets.insert(level.func());
+            }
+        }
+    }
+
+    vector<Candidate> candidates;
+    for (const auto &it : env) {
+        const Function &f = it.second;
+        if (!is_candidate(f, fuse_targets)) {
+            continue;
+        }
+
+        // The outermost real loop must be over one of the pure vars
+        // of the Func, and not something produced by a split or
+        // fuse, so that the footprint can be expressed in terms of
+        // it.
+        const vector<Dim> &dims = f.definition().schedule().dims();
+        internal_assert(!dims.empty());
+        if (dims.size() < 2) {
+            continue;
+        }
+        const Dim &outer = dims[dims.size() - 2];
+        const vector<string> &args = f.args();
+        if (outer.dim_type != Dim::PureVar ||
+            std::find(args.begin(), args.end(), outer.var) == args.end() ||
+            (outer.for_type != ForType::Serial && outer.for_type != ForType::Parallel) ||
+            outer.device_api != DeviceAPI::None) {
+            debug(3) << "Not auto-fusing " << f.name()
+                     << " because its outermost loop is not a serial or parallel pure var\n";
+            continue;
+        }
+
+        Candidate c;
+        c.func = f;
+        c.outer = outer;
+        for (const Expr &v : f.values()) {
+            for (const auto &b : boxes_required(v)) {
+                merge_boxes(c.footprint[b.first], b.second);
+            }
+        }
+        for (const auto &callee : find_transitive_calls(f)) {
+            c.callees.insert(callee.first);
+        }
+        candidates.push_back(c);
+    }
+
+    // Greedily group the candidates. The first member of each group
+    // is the one the others are computed with.
+    vector<bool> grouped(candidates.size(), false);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (grouped[i]) {
+            continue;
+        }
+        grouped[i] = true;
+        vector<size_t> group = {i};
+        for (size_t j = i + 1; j < candidates.size(); j++) {
+            if (grouped[j] || !shares_input(candidates[i], candidates[j])) {
+                continue;
+            }
+            bool ok = true;
+            for (size_t k : group) {
+                ok = ok && can_fuse(candidates[k], candidates[j]);
+            }
+            if (ok) {
+                grouped[j] = true;
+                group.push_back(j);
+            }
+        }
+
+        const Candidate &parent = candidates[i];
+        for (size_t k = 1; k < group.size(); k++) {
+            Function child = candidates[group[k]].func;
+            debug(2) << "Auto-fusing " << child.name() << " with "
+                     << parent.func.name() << " at " << parent.outer.var << "\n";
+            LoopLevel level(parent.func, VarOrRVar(parent.outer.var, false), 0);
+            child.definition().schedule().fuse_level() = FuseLoopLevel(level.lock(), {});
+        }
+    }
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,29 @@
+#ifndef HALIDE_AUTO_FUSE_H
+#define HALIDE_AUTO_FUSE_H
+
+/** \file
+ *
+ * Defines a pass that fuses the outermost loops of independent sibling
+ * Funcs that read overlapping regions of a common input.
+ */
+
+#include <map>
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find groups of Funcs marked with Func::auto_fuse that are computed
+ * at the same loop level, have no dependencies on each other, and
+ * read the same region of some common input per iteration of their
+ * outermost loop. Schedule each such group with compute_with at that
+ * outermost loop, so that the input loaded by one is still in cache
+ * for the others. Funcs with update definitions are left alone. The
+ * loop levels in the environment must already be locked. */
+void auto_fuse_siblings(const std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
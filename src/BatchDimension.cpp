@@ -0,0 +1,250 @@
+#include "BatchDimension.h"
+#include "IROperator.h"
+#include "WrapExternStages.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+Expr buffer_field(const char *accessor, Type t, Expr buf) {
+    return Call::make(t, accessor, {buf}, Call::Extern);
+}
+
+Expr buffer_dim_field(const char *accessor, Expr buf, int d) {
+    return Call::make(Int(32), accessor, {buf, d}, Call::Extern);
+}
+
+// Make a call and return the result upwards immediately if it's
+// non-zero. The callee will already have reported the error.
+Stmt make_checked_call(Expr call) {
+    string result_var_name = unique_name('t');
+    Expr result_var = Variable::make(Int(32), result_var_name);
+    Stmt s = AssertStmt::make(result_var == 0, result_var);
+    return LetStmt::make(result_var_name, call, s);
+}
+
+Stmt wrap_lets(Stmt s, vector<pair<string, Expr>> lets) {
+    while (!lets.empty()) {
+        s = LetStmt::make(lets.back().first, lets.back().second, s);
+        lets.pop_back();
+    }
+    return s;
+}
+
+}  // namespace
+
+Module add_batch_dimension(const Module &m, const string &function_name) {
+    const Target &target = m.target();
+    user_assert(!target.has_gpu_feature() &&
+                !target.has_feature(Target::OpenGL) &&
+                !target.has_feature(Target::OpenGLCompute) &&
+                !target.has_feature(Target::HVX_64) &&
+                !target.has_feature(Target::HVX_128))
+        << "Adding a batch dimension to " << function_name
+        << " is not supported for targets with a device API: " << target.to_string() << "\n";
+
+    Module result(m.name(), target);
+    for (const auto &b : m.buffers()) {
+        result.append(b);
+    }
+    for (const auto &s : m.submodules()) {
+        result.append(s);
+    }
+    for (const auto &e : m.external_code()) {
+        result.append(e);
+    }
+    result.set_any_strict_float(m.any_strict_float());
+
+    // The first function with this name is the pipeline. Any later
+    // ones are legacy buffer_t wrappers of it, which we replace with
+    // wrappers of the batched pipeline.
+    const LoweredFunc *pipeline = nullptr;
+    for (const LoweredFunc &f : m.functions()) {
+        if (f.name == function_name && !pipeline) {
+            pipeline = &f;
+        } else if (f.name != function_name && f.name != function_name + "_old_buffer_t") {
+            result.append(f);
+        }
+    }
+    user_assert(pipeline) << "Can't add a batch dimension to " << function_name
+                          << ", which is not a function in Module " << m.name() << "\n";
+
+    // Keep the pipeline for a single element as an internal function.
+    LoweredFunc item = *pipeline;
+    item.name = function_name + "_batch_item";
+    item.linkage = LinkageType::Internal;
+    result.append(item);
+
+    Call::CallType call_type = Call::Extern;
+    if (item.name_mangling == NameMangling::CPlusPlus ||
+        (item.name_mangling == NameMangling::Default &&
+         target.has_feature(Target::CPlusPlusMangling))) {
+        call_type = Call::ExternCPlusPlus;
+    }
+
+    // The batch is the range of the extra dimension of the first output.
+    const LoweredArgument *batch_output = nullptr;
+    for (const LoweredArgument &arg : item.args) {
+        if (arg.is_output()) {
+            batch_output = &arg;
+            break;
+        }
+    }
+    internal_assert(batch_output) << "Pipeline " << function_name << " has no outputs\n";
+
+    const string batch_min_name = item.name + ".batch.min";
+    const string batch_extent_name = item.name + ".batch.extent";
+    const string batch_var_name = item.name + ".b";
+    Expr batch_min = Variable::make(Int(32), batch_min_name);
+    Expr batch_extent = Variable::make(Int(32), batch_extent_name);
+    Expr batch_max = batch_min + batch_extent - 1;
+    Expr batch_var = Variable::make(Int(32), batch_var_name);
+
+    vector<LoweredArgument> args;
+    vector<Stmt> dimension_checks, batch_checks, query_results;
+    vector<pair<string, Expr>> slices, query_slices;
+    vector<Expr> slice_args, query_slice_args;
+    Expr any_bounds_query = const_false();
+    for (LoweredArgument arg : item.args) {
+        if (arg.is_scalar()) {
+            args.push_back(arg);
+            Expr v = Variable::make(arg.type, arg.name);
+            slice_args.push_back(v);
+            query_slice_args.push_back(v);
+            continue;
+        }
+
+        const int d = arg.dimensions;
+        user_assert(d < 255) << "Buffer " << arg.name << " has too many dimensions to add a batch dimension\n";
+        arg.dimensions = d + 1;
+        args.push_back(arg);
+
+        Expr buf = Variable::make(type_of<struct halide_buffer_t *>(), arg.name + ".buffer");
+        Expr error_name = (arg.is_input() ? "Input buffer " : "Output buffer ") + arg.name;
+
+        Expr dims = buffer_field(Call::buffer_get_dimensions, Int(32), buf);
+        Expr dims_error = Call::make(Int(32), "halide_error_bad_dimensions",
+                                     {error_name, dims, d + 1}, Call::Extern);
+        dimension_checks.push_back(AssertStmt::make(dims == d + 1, dims_error));
+
+        Expr actual_min = buffer_dim_field(Call::buffer_get_min, buf, d);
+        Expr actual_max = actual_min + buffer_dim_field(Call::buffer_get_extent, buf, d) - 1;
+        Expr oob_error = Call::make(Int(32), "halide_error_access_out_of_bounds",
+                                    {error_name, d, batch_min, batch_max, actual_min, actual_max},
+                                    Call::Extern);
+        batch_checks.push_back(AssertStmt::make(actual_min <= batch_min && actual_max >= batch_max,
+                                                oob_error));
+
+        vector<Expr> mins, extents, strides;
+        for (int i = 0; i < d; i++) {
+            mins.push_back(buffer_dim_field(Call::buffer_get_min, buf, i));
+            extents.push_back(buffer_dim_field(Call::buffer_get_extent, buf, i));
+            strides.push_back(buffer_dim_field(Call::buffer_get_stride, buf, i));
+        }
+
+        // Find the host pointer of a slice by cropping the batch
+        // dimension to a single element.
+        vector<Expr> crop_mins = mins, crop_extents = extents;
+        crop_mins.push_back(batch_var);
+        crop_extents.push_back(1);
+        Expr crop_size = Call::make(Int(32), Call::size_of_halide_buffer_t, {}, Call::Intrinsic);
+        Expr crop = Call::make(type_of<struct halide_buffer_t *>(), Call::buffer_crop,
+                               {Call::make(type_of<struct halide_buffer_t *>(), Call::alloca,
+                                           {crop_size}, Call::Intrinsic),
+                                Call::make(type_of<struct halide_dimension_t *>(), Call::alloca,
+                                           {(int)sizeof(halide_dimension_t) * (d + 1)}, Call::Intrinsic),
+                                buf,
+                                Call::make(type_of<const int *>(), Call::make_struct, crop_mins, Call::Intrinsic),
+                                Call::make(type_of<const int *>(), Call::make_struct, crop_extents, Call::Intrinsic)},
+                               Call::Extern);
+        const string crop_name = arg.name + ".batch_crop.buffer";
+        slices.emplace_back(crop_name, crop);
+        Expr crop_var = Variable::make(type_of<struct halide_buffer_t *>(), crop_name);
+
+        BufferBuilder slice;
+        slice.host = buffer_field(Call::buffer_get_host, type_of<void *>(), crop_var);
+        slice.type = arg.type;
+        slice.dimensions = d;
+        slice.mins = mins;
+        slice.extents = extents;
+        slice.strides = strides;
+        slice.host_dirty = buffer_field(Call::buffer_get_host_dirty, Bool(), buf);
+        const string slice_name = arg.name + ".batch_item.buffer";
+        slices.emplace_back(slice_name, slice.build());
+        slice_args.push_back(Variable::make(type_of<struct halide_buffer_t *>(), slice_name));
+
+        // In a bounds query, hand the pipeline a single element that
+        // is a bounds query exactly when the whole buffer is.
+        BufferBuilder query_slice = slice;
+        query_slice.host = buffer_field(Call::buffer_get_host, type_of<void *>(), buf);
+        query_slice.device = buffer_field(Call::buffer_get_device, UInt(64), buf);
+        query_slice.device_interface = buffer_field(Call::buffer_get_device_interface,
+                                                    type_of<struct halide_device_interface_t *>(), buf);
+        query_slice.host_dirty = Expr();
+        query_slices.emplace_back(slice_name, query_slice.build());
+        query_slice_args.push_back(Variable::make(type_of<struct halide_buffer_t *>(), slice_name));
+
+        // Then give a queried buffer the shape the pipeline asked for,
+        // with the whole batch stacked densely along the extra dimension.
+        Expr slice_var = query_slice_args.back();
+        BufferBuilder queried;
+        queried.buffer_memory = buf;
+        queried.shape_memory = buffer_field(Call::buffer_get_shape, type_of<struct halide_dimension_t *>(), buf);
+        queried.host = query_slice.host;
+        queried.device = query_slice.device;
+        queried.device_interface = query_slice.device_interface;
+        queried.type = arg.type;
+        queried.dimensions = d + 1;
+        Expr batch_stride = 1;
+        for (int i = 0; i < d; i++) {
+            queried.mins.push_back(buffer_dim_field(Call::buffer_get_min, slice_var, i));
+            queried.extents.push_back(buffer_dim_field(Call::buffer_get_extent, slice_var, i));
+            queried.strides.push_back(buffer_dim_field(Call::buffer_get_stride, slice_var, i));
+            batch_stride = max(batch_stride, queried.strides.back() * queried.extents.back());
+        }
+        queried.mins.push_back(batch_min);
+        queried.extents.push_back(batch_extent);
+        queried.strides.push_back(batch_stride);
+        Expr is_bounds_query = buffer_field(Call::buffer_is_bounds_query, Bool(), buf);
+        query_results.push_back(IfThenElse::make(is_bounds_query, Evaluate::make(queried.build())));
+        any_bounds_query = any_bounds_query || is_bounds_query;
+    }
+
+    Stmt query = make_checked_call(Call::make(Int(32), item.name, query_slice_args, call_type));
+    query = Block::make(query, Block::make(query_results));
+    query = wrap_lets(query, query_slices);
+
+    Stmt run_item = make_checked_call(Call::make(Int(32), item.name, slice_args, call_type));
+    run_item = wrap_lets(run_item, slices);
+    Stmt run = For::make(batch_var_name, batch_min, batch_extent,
+                         ForType::Parallel, DeviceAPI::None, run_item);
+    run = Block::make(Block::make(batch_checks), run);
+
+    Stmt body = IfThenElse::make(any_bounds_query, query, run);
+    Expr output_buf = Variable::make(type_of<struct halide_buffer_t *>(), batch_output->name + ".buffer");
+    body = LetStmt::make(batch_extent_name,
+                         buffer_dim_field(Call::buffer_get_extent, output_buf, batch_output->dimensions),
+                         body);
+    body = LetStmt::make(batch_min_name,
+                         buffer_dim_field(Call::buffer_get_min, output_buf, batch_output->dimensions),
+                         body);
+    body = Block::make(Block::make(dimension_checks), body);
+
+    debug(2) << "Added batch dimension to " << function_name << ":\n" << body << "\n\n";
+
+    LoweredFunc batched(function_name, args, body, pipeline->linkage, pipeline->name_mangling);
+    result.append(batched);
+    if (!target.has_feature(Target::JIT)) {
+        add_legacy_wrapper(result, batched);
+    }
+
+    return result;
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,29 @@
+#ifndef HALIDE_BATCH_DIMENSION_H
+#define HALIDE_BATCH_DIMENSION_H
+
+/** \file
+ *
+ * Defines a pass over a Module that makes a pipeline operate on a
+ * batch of independent inputs and outputs.
+ */
+
+#include "Module.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Return a copy of the Module in which the LoweredFunc with the given
+ * name takes every buffer argument with an extra outermost
+ * dimension. The batch is the range of that dimension in the first
+ * output buffer. The original pipeline is kept as an internal
+ * function that runs once per slice of the batch, in parallel across
+ * slices, so intermediate storage is scoped to a single batch
+ * element. Scalar arguments are shared by every element. Bounds
+ * queries are answered by querying the pipeline for a single element
+ * of the batch. */
+Module add_batch_dimension(const Module &m, const std::string &function_name);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -994,6 +994,38 @@ private:
         interval = result;
     }
 
+    void visit(const VectorReduce *op) override {
+        op->value.accept(this);
+        int factor = op->value.type().lanes() / op->type.lanes();
+        switch (op->op) {
+        case VectorReduce::Add:
+            if (op->type.is_float() ||
+                (op->type.is_int() && op->type.bits() >= 32)) {
+                if (interval.has_lower_bound()) {
+                    interval.min *= factor;
+                }
+                if (interval.has_upper_bound()) {
+                    interval.max *= factor;
+                }
+            } else {
+                // The sum may wrap around
+                bounds_of_type(op->type);
+            }
+            break;
+        case VectorReduce::Mul:
+            // Technically there are some things we could say here,
+            // but it's not worth the complexity.
+            bounds_of_type(op->type);
+            break;
+        case VectorReduce::Min:
+        case VectorReduce::Max:
+        case VectorReduce::And:
+        case VectorReduce::Or:
+            // The bounds of the reduction are the bounds of the lanes.
+            break;
+        }
+    }
+
     void visit(const LetStmt *) override {
         internal_error << "Bounds of statement\n";
     }
@@ -308,6 +308,13 @@ public:
         return (const void *)(contents.get()) == (const void *)(other.contents.get());
     }
 
+    /** Check if this is the only Buffer object that points to its
+     * underlying Buffer. Copies of the Runtime::Buffer made via get()
+     * aren't counted. */
+    bool is_unique() const {
+        return contents.defined() && contents->ref_count.is_one();
+    }
+
     /** Check if this Buffer refers to an existing
      * Buffer. Default-constructed Buffer objects do not refer to any
      * existing Buffer. */
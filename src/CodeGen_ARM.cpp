@@ -464,7 +464,166 @@ void CodeGen_ARM::visit(const Div *op) {
 }
 
 void CodeGen_ARM::visit(const Add *op) {
-    CodeGen_Posix::visit(op);
+    Type t = op->type;
+    if (neon_intrinsics_disabled() ||
+        !use_dot_product() ||
+        !t.is_vector() ||
+        !(t.is_int() || t.is_uint()) ||
+        t.bits() != 32) {
+        CodeGen_Posix::visit(op);
+        return;
+    }
+
+    // Look for sums of products of 8-bit values. Four of these can be
+    // done at once with sdot or udot, which sum the products of
+    // groups of four adjacent bytes into each 32-bit lane. We express
+    // each group as a horizontal add of the interleaved products, and
+    // let codegen_vector_reduce find the dot product.
+    const int lanes = t.lanes();
+    vector<Expr> pending = {op}, rest;
+    vector<Expr> signed_a, signed_b, unsigned_a, unsigned_b;
+    while (!pending.empty()) {
+        Expr e = pending.back();
+        pending.pop_back();
+        if (const Add *add = e.as<Add>()) {
+            pending.push_back(add->b);
+            pending.push_back(add->a);
+            continue;
+        }
+        const Mul *mul = e.as<Mul>();
+        Expr a, b;
+        if (mul &&
+            (a = lossless_cast(Int(8, lanes), mul->a)).defined() &&
+            (b = lossless_cast(Int(8, lanes), mul->b)).defined()) {
+            signed_a.push_back(a);
+            signed_b.push_back(b);
+        } else if (mul &&
+                   (a = lossless_cast(UInt(8, lanes), mul->a)).defined() &&
+                   (b = lossless_cast(UInt(8, lanes), mul->b)).defined()) {
+            unsigned_a.push_back(a);
+            unsigned_b.push_back(b);
+        } else {
+            rest.push_back(e);
+        }
+    }
+
+    if (signed_a.size() < 4 && unsigned_a.size() < 4) {
+        CodeGen_Posix::visit(op);
+        return;
+    }
+
+    Expr result;
+    for (Expr e : rest) {
+        result = result.defined() ? Add::make(result, e) : e;
+    }
+    auto accumulate = [&](const vector<Expr> &as, const vector<Expr> &bs) {
+        size_t i = 0;
+        for (; i + 4 <= as.size(); i += 4) {
+            Expr a = Shuffle::make_interleave({as[i], as[i + 1], as[i + 2], as[i + 3]});
+            Expr b = Shuffle::make_interleave({bs[i], bs[i + 1], bs[i + 2], bs[i + 3]});
+            Type wide = t.with_lanes(lanes * 4);
+            Expr e = VectorReduce::make(VectorReduce::Add, cast(wide, a) * cast(wide, b), lanes);
+            result = result.defined() ? Add::make(result, e) : e;
+        }
+        // Leftover products are done the usual way.
+        for (; i < as.size(); i++) {
+            Expr e = cast(t, as[i]) * cast(t, bs[i]);
+            result = result.defined() ? Add::make(result, e) : e;
+        }
+    };
+    accumulate(signed_a, signed_b);
+    accumulate(unsigned_a, unsigned_b);
+    value = codegen(result);
+}
+
+void CodeGen_ARM::codegen_vector_reduce(const VectorReduce *op, const Expr &init) {
+    const int lanes = op->type.lanes();
+    const int input_lanes = op->value.type().lanes();
+    const int factor = input_lanes / lanes;
+
+    if (neon_intrinsics_disabled() ||
+        op->op != VectorReduce::Add ||
+        !(op->type.is_int() || op->type.is_uint())) {
+        CodeGen_Posix::codegen_vector_reduce(op, init);
+        return;
+    }
+
+    // Reduce by some factor using a horizontal instruction, then
+    // finish off the reduction (if there's anything left to do) with
+    // the generic code.
+    Value *partial = nullptr;
+    Type partial_type;
+    Expr acc = init;
+    const Mul *mul = op->value.as<Mul>();
+    const Cast *widen = op->value.as<Cast>();
+    if (use_dot_product() &&
+        factor % 4 == 0 && op->type.bits() == 32 && mul) {
+        // sdot and udot sum groups of four adjacent 8-bit products
+        // into each 32-bit lane, and add an accumulator.
+        Expr a, b;
+        Pattern p;
+        for (Type narrow : {Int(8, input_lanes), UInt(8, input_lanes)}) {
+            a = lossless_cast(narrow, mul->a);
+            b = lossless_cast(narrow, mul->b);
+            if (a.defined() && b.defined()) {
+                const char *intrin = narrow.is_int() ? "sdot.v4i32.v16i8" : "udot.v4i32.v16i8";
+                p = Pattern(intrin, intrin, 4, Expr());
+                break;
+            }
+        }
+        if (a.defined() && b.defined()) {
+            partial_type = op->type.with_lanes(input_lanes / 4);
+            Value *init_value;
+            if (factor == 4 && acc.defined()) {
+                init_value = codegen(acc);
+                acc = Expr();
+            } else {
+                init_value = codegen(make_zero(partial_type));
+            }
+            partial = call_pattern(p, llvm_type_of(partial_type), {init_value, codegen(a), codegen(b)});
+        }
+    }
+
+    // uaddlp and saddlp add adjacent pairs of lanes into lanes of
+    // twice the width. They do the first step of a horizontal add of
+    // a widened narrow type.
+    if (!partial && factor % 2 == 0 && widen &&
+        (widen->value.type().is_int() || widen->value.type().is_uint()) &&
+        widen->value.type().bits() <= 32 &&
+        op->type.bits() >= widen->value.type().bits() * 2) {
+        Type narrow = widen->value.type();
+        const int bits = narrow.bits();
+        partial_type = narrow.with_bits(bits * 2).with_lanes(input_lanes / 2);
+        const int intrin_lanes = 64 / bits;
+        std::ostringstream oss;
+        oss << ".v" << intrin_lanes << "i" << bits * 2
+            << ".v" << intrin_lanes * 2 << "i" << bits;
+        Pattern p;
+        if (narrow.is_int()) {
+            p = Pattern("vpaddls" + oss.str(), "saddlp" + oss.str(), intrin_lanes, Expr());
+        } else {
+            p = Pattern("vpaddlu" + oss.str(), "uaddlp" + oss.str(), intrin_lanes, Expr());
+        }
+        partial = call_pattern(p, partial_type, {widen->value});
+    }
+
+    if (!partial) {
+        CodeGen_Posix::codegen_vector_reduce(op, init);
+        return;
+    }
+
+    string name = unique_name('t');
+    sym_push(name, partial);
+    Expr e = Variable::make(partial_type, name);
+    e = cast(op->type.with_lanes(partial_type.lanes()), e);
+    if (partial_type.lanes() != lanes) {
+        e = VectorReduce::make(VectorReduce::Add, e, lanes);
+    }
+    if (acc.defined()) {
+        e = Add::make(acc, e);
+    }
+    value = codegen(e);
+    sym_pop(name);
 }
 
 void CodeGen_ARM::visit(const Sub *op) {
@@ -547,10 +706,17 @@ void CodeGen_ARM::visit(const Min *op) {
         {Int(8, 16), "v16i8"},
         {Int(16, 8), "v8i16"},
         {Int(32, 4), "v4i32"},
-        {Float(32, 4), "v4f32"}
+        {Float(32, 4), "v4f32"},
+        {Float(16, 4), "v4f16"},
+        {Float(16, 8), "v8f16"}
     };
 
     for (size_t i = 0; i < sizeof(patterns)/sizeof(patterns[0]); i++) {
+        if (patterns[i].t.is_float() && patterns[i].t.bits() == 16 &&
+            !target.has_feature(Target::ARMFp16)) {
+            continue;
+        }
+
         bool match = op->type == patterns[i].t;
 
         // The 128-bit versions are also used for other vector widths.
@@ -622,10 +788,17 @@ void CodeGen_ARM::visit(const Max *op) {
         {Int(8, 16), "v16i8"},
         {Int(16, 8), "v8i16"},
         {Int(32, 4), "v4i32"},
-        {Float(32, 4), "v4f32"}
+        {Float(32, 4), "v4f32"},
+        {Float(16, 4), "v4f16"},
+        {Float(16, 8), "v8f16"}
     };
 
     for (size_t i = 0; i < sizeof(patterns)/sizeof(patterns[0]); i++) {
+        if (patterns[i].t.is_float() && patterns[i].t.bits() == 16 &&
+            !target.has_feature(Target::ARMFp16)) {
+            continue;
+        }
+
         bool match = op->type == patterns[i].t;
 
         // The 128-bit versions are also used for other vector widths.
@@ -1012,21 +1185,44 @@ string CodeGen_ARM::mcpu() const {
 }
 
 string CodeGen_ARM::mattrs() const {
+    string features;
+    string separator;
     if (target.bits == 32) {
         if (target.has_feature(Target::ARMv7s)) {
-            return "+neon";
-        } if (!target.has_feature(Target::NoNEON)) {
-            return "+neon";
+            features = "+neon";
+        } else if (!target.has_feature(Target::NoNEON)) {
+            features = "+neon";
         } else {
-            return "-neon";
+            features = "-neon";
         }
+        separator = ",";
     } else {
         if (target.os == Target::IOS || target.os == Target::OSX) {
-            return "+reserve-x18";
-        } else {
-            return "";
+            features = "+reserve-x18";
+            separator = ",";
         }
     }
+    // The ARMv8.2 extensions.
+#if LLVM_VERSION >= 60
+    if (target.has_feature(Target::ARMDotProd)) {
+        features += separator + "+dotprod";
+        separator = ",";
+    }
+#endif
+    if (target.has_feature(Target::ARMFp16)) {
+        features += separator + "+fullfp16";
+        separator = ",";
+    }
+    return features;
+}
+
+bool CodeGen_ARM::use_dot_product() const {
+    // These need LLVM 6, and are only selected on AArch64.
+#if LLVM_VERSION >= 60
+    return target.bits == 64 && target.has_feature(Target::ARMDotProd);
+#else
+    return false;
+#endif
 }
 
 bool CodeGen_ARM::use_soft_float_abi() const {
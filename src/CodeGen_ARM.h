@@ -20,6 +20,10 @@ protected:
 
     Expr sorted_avg(Expr a, Expr b) override;
 
+    /** Use the dot product instructions and the pairwise widening
+     * adds for horizontal adds where possible. */
+    void codegen_vector_reduce(const VectorReduce *op, const Expr &init) override;
+
     using CodeGen_Posix::visit;
 
     /** Nodes for which we want to emit specific neon intrinsics */
@@ -72,6 +76,9 @@ protected:
     bool neon_intrinsics_disabled() {
         return target.has_feature(Target::NoNEON);
     }
+
+    // Whether to use the ARMv8.2 sdot and udot instructions.
+    bool use_dot_product() const;
 };
 
 }  // namespace Internal
@@ -214,7 +214,8 @@ public:
 };
 
 CodeGen_C::CodeGen_C(ostream &s, Target t, OutputKind output_kind, const std::string &guard) :
-    IRPrinter(s), id("$$ BAD ID $$"), target(t), output_kind(output_kind), extern_c_open(false) {
+    IRPrinter(s), id("$$ BAD ID $$"), target(t), output_kind(output_kind),
+    extern_c_open(false), in_parallel_region(false) {
 
     if (is_header()) {
         // If it's a header, emit an include guard.
@@ -838,6 +839,34 @@ private:
     CppVector(Empty) {}
 };
 
+)INLINE_CODE";
+
+        const char *native_vector_ops_decl = R"INLINE_CODE(
+#if __has_attribute(ext_vector_type) || __has_attribute(vector_size)
+// Comparisons, selects, min/max and most conversions can use native
+// vector operations, which the compiler maps to SSE/AVX/NEON
+// instructions, if we can convert between vector types. Otherwise
+// they fall back to a loop over the lanes. Define
+// HALIDE_CPP_NO_NATIVE_VECTOR_OPS to always use the loops.
+#if __has_builtin(__builtin_convertvector) && !HALIDE_CPP_NO_NATIVE_VECTOR_OPS
+    #define halide_cpp_use_native_vector_ops 1
+#else
+    #define halide_cpp_use_native_vector_ops 0
+#endif
+
+// Vector comparisons produce lanes of signed integers of the same
+// size as the operands, with all bits set where the comparison holds.
+template<size_t Bytes> struct NativeVectorMaskElement;
+template<> struct NativeVectorMaskElement<1> { typedef int8_t type; };
+template<> struct NativeVectorMaskElement<2> { typedef int16_t type; };
+template<> struct NativeVectorMaskElement<4> { typedef int32_t type; };
+template<> struct NativeVectorMaskElement<8> { typedef int64_t type; };
+
+template<typename T> struct NativeVectorIsFloat { static const bool value = false; };
+template<> struct NativeVectorIsFloat<float> { static const bool value = true; };
+template<> struct NativeVectorIsFloat<double> { static const bool value = true; };
+#endif  // __has_attribute(ext_vector_type) || __has_attribute(vector_size)
+
 )INLINE_CODE";
 
         const char *native_vector_decl = R"INLINE_CODE(
@@ -850,10 +879,13 @@ public:
     typedef NativeVector<ElementType, Lanes> Vec;
     typedef NativeVector<uint8_t, Lanes> Mask;
 
+    typedef typename NativeVectorMaskElement<sizeof(ElementType)>::type MaskElementType;
 #if __has_attribute(ext_vector_type)
     typedef ElementType_ NativeVectorType __attribute__((ext_vector_type(Lanes), aligned(sizeof(ElementType))));
+    typedef MaskElementType NativeMaskType __attribute__((ext_vector_type(Lanes), aligned(sizeof(ElementType))));
 #elif __has_attribute(vector_size) || __GNUC__
     typedef ElementType_ NativeVectorType __attribute__((vector_size(Lanes * sizeof(ElementType)), aligned(sizeof(ElementType))));
+    typedef MaskElementType NativeMaskType __attribute__((vector_size(Lanes * sizeof(ElementType)), aligned(sizeof(ElementType))));
 #endif
 
     NativeVector &operator=(const Vec &src) {
@@ -915,8 +947,16 @@ public:
         }
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     static Vec shuffle(const Vec &a, const int32_t indices[Lanes]) {
+#if __GNUC__ && !__clang__
+        // Lanes is a power of two here, so the don't-care indices of
+        // -1 select an arbitrary lane.
+        NativeMaskType native_indices;
+        for (size_t i = 0; i < Lanes; i++) {
+            native_indices[i] = indices[i];
+        }
+        return Vec(from_native_vector, __builtin_shuffle(a.native_vector, native_indices));
+#else
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             if (indices[i] < 0) {
@@ -925,6 +965,7 @@ public:
             r.native_vector[i] = a[indices[i]];
         }
         return r;
+#endif
     }
 
     // TODO: this should be improved by taking advantage of native operator support.
@@ -1036,67 +1077,88 @@ public:
         return Vec(from_native_vector, a | b.native_vector);
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator<(const Vec &a, const Vec &b) {
+#if halide_cpp_use_native_vector_ops
+        return to_mask(a.native_vector < b.native_vector);
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] < b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator<=(const Vec &a, const Vec &b) {
+#if halide_cpp_use_native_vector_ops
+        return to_mask(a.native_vector <= b.native_vector);
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] <= b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator>(const Vec &a, const Vec &b) {
+#if halide_cpp_use_native_vector_ops
+        return to_mask(a.native_vector > b.native_vector);
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] > b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator>=(const Vec &a, const Vec &b) {
+#if halide_cpp_use_native_vector_ops
+        return to_mask(a.native_vector >= b.native_vector);
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] >= b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator==(const Vec &a, const Vec &b) {
+#if halide_cpp_use_native_vector_ops
+        return to_mask(a.native_vector == b.native_vector);
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] == b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     friend Mask operator!=(const Vec &a, const Vec &b) {
+#if halide_cpp_use_native_vector_ops
+        return to_mask(a.native_vector != b.native_vector);
+#else
         Mask r;
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = a[i] != b[i] ? 0xff : 0x00;
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     static Vec select(const Mask &cond, const Vec &true_value, const Vec &false_value) {
+#if halide_cpp_use_native_vector_ops
+        return blend(__builtin_convertvector(cond.native_vector, NativeMaskType) != 0, true_value, false_value);
+#else
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = cond[i] ? true_value[i] : false_value[i];
         }
         return r;
+#endif
     }
 
     template <typename OtherVec>
@@ -1111,6 +1173,14 @@ public:
         // (https://github.com/halide/Halide/issues/2080)
         return Vec(from_native_vector, __builtin_convertvector(src.native_vector, NativeVectorType));
 #else
+#if halide_cpp_use_native_vector_ops
+        // Conversions other than float to int don't have the rounding
+        // issue above.
+        if (!NativeVectorIsFloat<typename OtherVec::ElementType>::value ||
+            NativeVectorIsFloat<ElementType>::value) {
+            return Vec(from_native_vector, __builtin_convertvector(src.native_vector, NativeVectorType));
+        }
+#endif
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = static_cast<typename Vec::ElementType>(src.native_vector[i]);
@@ -1119,22 +1189,28 @@ public:
 #endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     static Vec max(const Vec &a, const Vec &b) {
+#if halide_cpp_use_native_vector_ops
+        return blend(a.native_vector > b.native_vector, a, b);
+#else
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = ::halide_cpp_max(a[i], b[i]);
         }
         return r;
+#endif
     }
 
-    // TODO: this should be improved by taking advantage of native operator support.
     static Vec min(const Vec &a, const Vec &b) {
+#if halide_cpp_use_native_vector_ops
+        return blend(a.native_vector < b.native_vector, a, b);
+#else
         Vec r(empty);
         for (size_t i = 0; i < Lanes; i++) {
             r.native_vector[i] = ::halide_cpp_min(a[i], b[i]);
         }
         return r;
+#endif
     }
 
 private:
@@ -1151,6 +1227,19 @@ private:
     inline NativeVector(FromNativeVector, const NativeVectorType &src) {
         native_vector = src;
     }
+
+#if halide_cpp_use_native_vector_ops
+    // Truncating the all-ones lanes of a comparison gives 0xff.
+    static Mask to_mask(const NativeMaskType &m) {
+        return Mask(Mask::from_native_vector, __builtin_convertvector(m, typename Mask::NativeVectorType));
+    }
+
+    static Vec blend(const NativeMaskType &m, const Vec &true_value, const Vec &false_value) {
+        NativeMaskType t = (NativeMaskType)true_value.native_vector;
+        NativeMaskType f = (NativeMaskType)false_value.native_vector;
+        return Vec(from_native_vector, (NativeVectorType)((m & t) | (~m & f)));
+    }
+#endif
 };
 #endif  // __has_attribute(ext_vector_type) || __has_attribute(vector_size)
 
@@ -1182,7 +1271,7 @@ private:
         // flushing the stream before or after heals it. Since C++ codegen is rarely
         // on a compilation critical path, we'll just band-aid it in this way.
         stream << std::flush;
-        stream << cpp_vector_decl << native_vector_decl << vector_selection_decl;
+        stream << cpp_vector_decl << native_vector_ops_decl << native_vector_decl << vector_selection_decl;
         stream << std::flush;
 
         for (const auto &t : vector_types) {
@@ -2424,28 +2513,65 @@ void CodeGen_C::visit(const ProducerConsumer *op) {
     print_stmt(op->body);
 }
 
-void CodeGen_C::visit(const Fork *op) {
-    // TODO: This doesn't actually work with nested tasks
+void CodeGen_C::print_parallel_body(Stmt s, const string &error_var) {
+    bool old_in_parallel_region = in_parallel_region;
+    in_parallel_region = true;
+    string result = unique_name('_');
     do_indent();
-    stream << "#pragma omp parallel\n";
+    stream << "int " << result << " = [&]() -> int\n";
     open_scope();
+    print_stmt(s);
     do_indent();
-    stream << "#pragma omp single\n";
+    stream << "return 0;\n";
+    indent--;
+    do_indent();
+    stream << "}();\n";
+    cache.clear();
+    do_indent();
+    stream << "if (" << result << " != 0)\n";
     open_scope();
     do_indent();
-    stream << "#pragma omp task\n";
+    stream << "#pragma omp atomic write\n";
+    do_indent();
+    stream << error_var << " = " << result << ";\n";
+    close_scope("");
+    in_parallel_region = old_in_parallel_region;
+}
+
+void CodeGen_C::visit(const Fork *op) {
+    // Run the two halves as OpenMP tasks. At the top level we need a
+    // team of threads to run them on, but a nested fork can just add
+    // more tasks to the existing team.
+    string error_var = unique_name('_');
+    do_indent();
+    stream << "int " << error_var << " = 0;\n";
+    bool nested = in_parallel_region;
+    if (!nested) {
+        do_indent();
+        stream << "#pragma omp parallel\n";
+        open_scope();
+        do_indent();
+        stream << "#pragma omp single\n";
+        open_scope();
+    }
+    do_indent();
+    stream << "#pragma omp task default(shared)\n";
     open_scope();
-    print_stmt(op->first);
+    print_parallel_body(op->first, error_var);
     close_scope("");
     do_indent();
-    stream << "#pragma omp task\n";
+    stream << "#pragma omp task default(shared)\n";
     open_scope();
-    print_stmt(op->rest);
+    print_parallel_body(op->rest, error_var);
     close_scope("");
     do_indent();
     stream << "#pragma omp taskwait\n";
-    close_scope("");
-    close_scope("");
+    if (!nested) {
+        close_scope("");
+        close_scope("");
+    }
+    do_indent();
+    stream << "if (" << error_var << " != 0) return " << error_var << ";\n";
 }
 
 void CodeGen_C::visit(const Acquire *op) {
@@ -2466,9 +2592,20 @@ void CodeGen_C::visit(const For *op) {
     string id_min = print_expr(op->min);
     string id_extent = print_expr(op->extent);
 
+    string error_var;
     if (op->for_type == ForType::Parallel) {
+        error_var = unique_name('_');
+        do_indent();
+        stream << "int " << error_var << " = 0;\n";
         do_indent();
-        stream << "#pragma omp parallel for\n";
+        if (in_parallel_region) {
+            // Make tasks for the existing team of threads, rather
+            // than a nested parallel region, which would usually
+            // run serially.
+            stream << "#pragma omp taskloop default(shared)\n";
+        } else {
+            stream << "#pragma omp parallel for\n";
+        }
     } else {
         internal_assert(op->for_type == ForType::Serial)
             << "Can only emit serial or parallel for loops to C\n";
@@ -2487,9 +2624,18 @@ void CodeGen_C::visit(const For *op) {
            << "++)\n";
 
     open_scope();
-    op->body.accept(this);
+    if (op->for_type == ForType::Parallel) {
+        print_parallel_body(op->body, error_var);
+    } else {
+        op->body.accept(this);
+    }
     close_scope("for " + print_name(op->name));
 
+    if (op->for_type == ForType::Parallel) {
+        do_indent();
+        stream << "if (" << error_var << " != 0) return " << error_var << ";\n";
+    }
+
 }
 
 void CodeGen_C::visit(const Ramp *op) {
@@ -2531,7 +2677,7 @@ void CodeGen_C::visit(const Allocate *op) {
         alloc.type = op->type;
         allocations.push(op->name, alloc);
         heap_allocations.push(op->name);
-        stream << op_type << "*" << op_name << " = (" << print_expr(op->new_expr) << ");\n";
+        stream << op_type << "*" << op_name << " = (" << op_type << " *)(" << print_expr(op->new_expr) << ");\n";
     } else {
         constant_size = op->constant_allocation_size();
         if (constant_size > 0) {
@@ -2711,6 +2857,42 @@ void CodeGen_C::visit(const Shuffle *op) {
     print_assignment(op->type, rhs.str());
 }
 
+void CodeGen_C::visit(const VectorReduce *op) {
+    // Combine strided slices of the input vector. Slice i holds the
+    // i'th lane of every group of lanes being reduced.
+    Expr v = Variable::make(op->value.type(), print_expr(op->value));
+    const int factor = op->value.type().lanes() / op->type.lanes();
+    Expr result;
+    for (int i = 0; i < factor; i++) {
+        Expr slice = Shuffle::make_slice(v, i, factor, op->type.lanes());
+        if (!result.defined()) {
+            result = slice;
+            continue;
+        }
+        switch (op->op) {
+        case VectorReduce::Add:
+            result = Add::make(result, slice);
+            break;
+        case VectorReduce::Mul:
+            result = Mul::make(result, slice);
+            break;
+        case VectorReduce::Min:
+            result = Min::make(result, slice);
+            break;
+        case VectorReduce::Max:
+            result = Max::make(result, slice);
+            break;
+        case VectorReduce::And:
+            result = And::make(result, slice);
+            break;
+        case VectorReduce::Or:
+            result = Or::make(result, slice);
+            break;
+        }
+    }
+    print_expr(result);
+}
+
 void CodeGen_C::test() {
     LoweredArgument buffer_arg("buf", Argument::OutputBuffer, Int(32), 3);
     LoweredArgument float_arg("alpha", Argument::InputScalar, Float(32), 0);
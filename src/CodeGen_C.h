@@ -81,6 +81,12 @@ protected:
     void create_assertion(const std::string &id_cond, Expr message);
     void create_assertion(Expr cond, Expr message);
 
+    /** Emit a statement as the body of a parallel loop or task. Code
+     * can't return from inside an OpenMP structured block, so the
+     * statement runs in a lambda, and any error it returns is stored
+     * to the named int variable instead. */
+    void print_parallel_body(Stmt s, const std::string &error_var);
+
     enum AppendSpaceIfNeeded {
         DoNotAppendSpace,
         AppendSpace,
@@ -149,6 +155,11 @@ protected:
     /** True if at least one gpu-based for loop is used. */
     bool uses_gpu_for_loops;
 
+    /** True if we're inside a parallel loop or a task. Nested
+     * parallelism is emitted as OpenMP tasks on the existing team of
+     * threads rather than as new parallel regions. */
+    bool in_parallel_region;
+
     /** Track which handle types have been forward-declared already. */
     std::set<const halide_handle_cplusplus_type *> forward_declared;
 
@@ -200,6 +211,7 @@ protected:
     void visit(const IfThenElse *) override;
     void visit(const Evaluate *) override;
     void visit(const Shuffle *) override;
+    void visit(const VectorReduce *) override;
     void visit(const Prefetch *) override;
     void visit(const Fork *) override;
     void visit(const Acquire *) override;
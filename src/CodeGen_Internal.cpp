@@ -152,6 +152,7 @@ bool function_takes_user_context(const std::string &name) {
         "halide_device_malloc",
         "halide_device_and_host_malloc",
         "halide_device_sync",
+        "halide_do_frames",
         "halide_do_par_for",
         "halide_do_loop_task",
         "halide_do_task",
@@ -202,6 +203,8 @@ bool function_takes_user_context(const std::string &name) {
         "halide_metal_initialize_kernels",
         "halide_d3d12compute_initialize_kernels",
         "halide_get_gpu_device",
+        "halide_get_memory_budget",
+        "halide_get_memory_budget_threads",
         "halide_upgrade_buffer_t",
         "halide_downgrade_buffer_t",
         "halide_downgrade_buffer_t_device_fields",
@@ -1267,6 +1267,19 @@ void CodeGen_LLVM::visit(const Variable *op) {
 }
 
 void CodeGen_LLVM::visit(const Add *op) {
+    // Fold an accumulator into a horizontal add so that targets can
+    // use instructions that reduce and accumulate in one go.
+    const VectorReduce *red = op->b.as<VectorReduce>();
+    Expr init = op->a;
+    if (!red) {
+        red = op->a.as<VectorReduce>();
+        init = op->b;
+    }
+    if (red && red->op == VectorReduce::Add) {
+        codegen_vector_reduce(red, init);
+        return;
+    }
+
     Value *a = codegen(op->a);
     Value *b = codegen(op->b);
     if (op->type.is_float()) {
@@ -2787,7 +2800,10 @@ void CodeGen_LLVM::visit(const Call *op) {
         safe_flags.clear();
         builder->setFastMathFlags(safe_flags);
         builder->setDefaultFPMathTag(strict_fp_math_md);
+        bool old_strict_float = strict_float;
+        strict_float = true;
         value = codegen(op->args[0]);
+        strict_float = old_strict_float;
     } else if (op->is_intrinsic()) {
         internal_error << "Unknown intrinsic: " << op->name << "\n";
     } else if (op->call_type == Call::PureExtern && op->name == "pow_f32") {
@@ -2804,6 +2820,40 @@ void CodeGen_LLVM::visit(const Call *op) {
         internal_assert(op->args.size() == 1);
         Expr e = Internal::halide_exp(op->args[0]);
         e.accept(this);
+    } else if (op->call_type == Call::PureExtern && op->type.is_vector() && !strict_float &&
+               (op->name == "sin_f32" || op->name == "cos_f32" || op->name == "tan_f32" ||
+                op->name == "atan_f32" || op->name == "atan2_f32" || op->name == "tanh_f32")) {
+        // The libm versions of these would be called once per
+        // lane. Use polynomial approximations that vectorize
+        // instead, unless we've been asked for strict float.
+        Expr e;
+        if (op->name == "sin_f32" || op->name == "cos_f32" || op->name == "tan_f32") {
+            // The range reduction loses accuracy for large
+            // arguments. If any lane is that large, branch to the
+            // per-lane libm calls instead.
+            string x_name = unique_name('x');
+            Expr x = Variable::make(op->type, x_name);
+            Expr approx;
+            if (op->name == "sin_f32") {
+                approx = Internal::halide_sin(x);
+            } else if (op->name == "cos_f32") {
+                approx = Internal::halide_cos(x);
+            } else {
+                approx = Internal::halide_tan(x);
+            }
+            Expr exact = Halide::strict_float(Call::make(op->type, op->name, {x}, Call::PureExtern));
+            Expr any_large = VectorReduce::make(VectorReduce::Or, abs(x) > 8192.0f, 1);
+            e = Call::make(op->type, Call::if_then_else, {any_large, exact, approx}, Call::Intrinsic);
+            e = Let::make(x_name, op->args[0], e);
+        } else if (op->name == "atan_f32") {
+            e = Internal::halide_atan(op->args[0]);
+        } else if (op->name == "atan2_f32") {
+            internal_assert(op->args.size() == 2);
+            e = Internal::halide_atan2(op->args[0], op->args[1]);
+        } else {
+            e = Internal::halide_tanh(op->args[0]);
+        }
+        e.accept(this);
     } else if (op->call_type == Call::PureExtern &&
                (op->name == "is_nan_f32" || op->name == "is_nan_f64")) {
         internal_assert(op->args.size() == 1);
@@ -3751,6 +3801,83 @@ void CodeGen_LLVM::visit(const Shuffle *op) {
     }
 }
 
+void CodeGen_LLVM::visit(const VectorReduce *op) {
+    codegen_vector_reduce(op, Expr());
+}
+
+void CodeGen_LLVM::codegen_vector_reduce(const VectorReduce *op, const Expr &init) {
+    auto binop = [&](Expr a, Expr b) -> Expr {
+        switch (op->op) {
+        case VectorReduce::Add:
+            return Add::make(a, b);
+        case VectorReduce::Mul:
+            return Mul::make(a, b);
+        case VectorReduce::Min:
+            return Min::make(a, b);
+        case VectorReduce::Max:
+            return Max::make(a, b);
+        case VectorReduce::And:
+            return And::make(a, b);
+        case VectorReduce::Or:
+            return Or::make(a, b);
+        }
+        internal_error << "Unreachable";
+        return Expr();
+    };
+
+    // Each partial result is bound to a name before it is sliced, so
+    // that it is only generated once.
+    vector<string> names;
+    auto bind = [&](Expr e) -> Expr {
+        string name = unique_name('t');
+        sym_push(name, codegen(e));
+        names.push_back(name);
+        return Variable::make(e.type(), name);
+    };
+
+    const int output_lanes = op->type.lanes();
+    Expr v = bind(op->value);
+    int lanes = v.type().lanes();
+    int factor = lanes / output_lanes;
+
+    // Halve the number of lanes while we can. For a full reduction
+    // to a scalar we fold the top half onto the bottom half, which is
+    // cheap on every architecture. Otherwise we combine adjacent
+    // pairs of lanes, which keeps the groups contiguous.
+    while (factor % 2 == 0) {
+        lanes /= 2;
+        factor /= 2;
+        Expr a, b;
+        if (output_lanes == 1) {
+            a = Shuffle::make_slice(v, 0, 1, lanes);
+            b = Shuffle::make_slice(v, lanes, 1, lanes);
+        } else {
+            a = Shuffle::make_slice(v, 0, 2, lanes);
+            b = Shuffle::make_slice(v, 1, 2, lanes);
+        }
+        v = bind(binop(a, b));
+    }
+
+    // Handle any remaining odd factor one strided slice at a time.
+    if (factor > 1) {
+        Expr result;
+        for (int i = 0; i < factor; i++) {
+            Expr slice = Shuffle::make_slice(v, i, factor, output_lanes);
+            result = result.defined() ? binop(result, slice) : slice;
+        }
+        v = result;
+    }
+
+    if (init.defined()) {
+        v = binop(init, v);
+    }
+    value = codegen(v);
+
+    for (const string &name : names) {
+        sym_pop(name);
+    }
+}
+
 Value *CodeGen_LLVM::create_alloca_at_entry(llvm::Type *t, int n, bool zero_initialize, const string &name) {
     IRBuilderBase::InsertPoint here = builder->saveIP();
     BasicBlock *entry = &builder->GetInsertBlock()->getParent()->getEntryBlock();
@@ -371,6 +371,7 @@ protected:
     void visit(const IfThenElse *) override;
     void visit(const Evaluate *) override;
     void visit(const Shuffle *) override;
+    void visit(const VectorReduce *) override;
     void visit(const Prefetch *) override;
     // @}
 
@@ -433,6 +434,13 @@ protected:
                              const std::string &name, std::vector<llvm::Value *>);
     // @}
 
+    /** Generate code for a horizontal vector reduction, combined
+     * with the accumulator 'init' if it is defined. The default
+     * implementation builds a tree of shuffles and vector
+     * operations. Architectures override this to use their
+     * horizontal reduction instructions where they can. */
+    virtual void codegen_vector_reduce(const VectorReduce *op, const Expr &init);
+
     /** Take a slice of lanes out of an llvm vector. Pads with undefs
      * if you ask for more lanes than the vector has. */
     virtual llvm::Value *slice_vector(llvm::Value *vec, int start, int extent);
@@ -60,18 +60,298 @@ bool should_use_pmaddwd(Expr a, Expr b, vector<Expr> &result) {
     return true;
 }
 
+// Flatten a tree of Adds into the list of its summands.
+void collect_summands(const Expr &e, vector<Expr> &terms) {
+    if (const Add *add = e.as<Add>()) {
+        collect_summands(add->a, terms);
+        collect_summands(add->b, terms);
+    } else {
+        terms.push_back(e);
+    }
+}
+
+// Match a * b where a and b can be losslessly narrowed to ta and tb
+// respectively (in either order).
+bool match_narrow_product(const Expr &e, Type ta, Type tb, Expr &a, Expr &b) {
+    const Mul *mul = e.as<Mul>();
+    if (!mul) {
+        return false;
+    }
+    a = lossless_cast(ta, mul->a);
+    b = lossless_cast(tb, mul->b);
+    if (a.defined() && b.defined()) {
+        return true;
+    }
+    a = lossless_cast(ta, mul->b);
+    b = lossless_cast(tb, mul->a);
+    return a.defined() && b.defined();
+}
+
+// A bfloat16 stored in a uint16 is widened to float by shifting it
+// into the top half of a 32-bit word. If e is such a widening, return
+// the narrow uint16 value.
+Expr match_bf16_to_f32(const Expr &e) {
+    const Call *c = e.as<Call>();
+    if (!c || !c->is_intrinsic(Call::reinterpret) ||
+        c->type.element_of() != Float(32)) {
+        return Expr();
+    }
+    Expr bits = c->args[0], narrow;
+    if (const Mul *mul = bits.as<Mul>()) {
+        if (is_const(mul->b, 65536)) {
+            narrow = mul->a;
+        }
+    } else if (const Call *shift = bits.as<Call>()) {
+        if (shift->is_intrinsic(Call::shift_left) && is_const(shift->args[1], 16)) {
+            narrow = shift->args[0];
+        }
+    }
+    if (!narrow.defined()) {
+        return Expr();
+    }
+    return lossless_cast(UInt(16, e.type().lanes()), narrow);
+}
+
+// Match a product of two bfloat16 values widened to float.
+bool match_bf16_product(const Expr &e, Expr &a, Expr &b) {
+    const Mul *mul = e.as<Mul>();
+    if (!mul) {
+        return false;
+    }
+    a = match_bf16_to_f32(mul->a);
+    b = match_bf16_to_f32(mul->b);
+    return a.defined() && b.defined();
 }
 
+// A pair of narrow operands of a product term, along with the original
+// term in case it doesn't end up in a group.
+struct DotProductTerm {
+    Expr a, b, term;
+};
+
+}
+
+bool CodeGen_X86::try_to_use_dot_product(const Add *op) {
+    // Sums of products of narrow values can be done with the
+    // AVX512-VNNI and AVX512-BF16 dot product instructions, which
+    // multiply adjacent groups of narrow values in each 32-bit lane
+    // and accumulate into that lane. We find all the product terms
+    // of the sum, gather them into groups, and interleave each
+    // group so that a lane of the result lines up with a 32-bit
+    // lane of the arguments.
+    Type t = op->type;
+    if (!t.is_vector() || t.lanes() < 4 || t.bits() != 32) {
+        return false;
+    }
+
+#if LLVM_VERSION >= 70
+    const bool vnni = (target.has_feature(Target::AVX512_Cascadelake) ||
+                       target.has_feature(Target::AVX512_Cooperlake));
+#else
+    const bool vnni = false;
+#endif
+#if LLVM_VERSION >= 90
+    // vdpbf16ps doesn't round between the multiply and the add, and
+    // flushes denormals, so it's only legal without strict_float.
+    const bool bf16 = (target.has_feature(Target::AVX512_Cooperlake) &&
+                       !target.has_feature(Target::StrictFloat));
+#else
+    const bool bf16 = false;
+#endif
+
+    vector<Expr> terms;
+    collect_summands(op, terms);
+
+    vector<DotProductTerm> bytes, words, bfloats;
+    vector<Expr> rest;
+    const int lanes = t.lanes();
+    for (const Expr &e : terms) {
+        DotProductTerm p;
+        p.term = e;
+        if (t.is_int() && vnni &&
+            match_narrow_product(e, UInt(8, lanes), Int(8, lanes), p.a, p.b)) {
+            bytes.push_back(p);
+        } else if (t.is_int() && vnni &&
+                   match_narrow_product(e, Int(16, lanes), Int(16, lanes), p.a, p.b)) {
+            words.push_back(p);
+        } else if (t.is_float() && bf16 &&
+                   match_bf16_product(e, p.a, p.b)) {
+            bfloats.push_back(p);
+        } else {
+            rest.push_back(e);
+        }
+    }
+
+    // Byte products left over after grouping by four can still be
+    // grouped in pairs as 16-bit products.
+    while (bytes.size() % 4) {
+        DotProductTerm p = bytes.back();
+        bytes.pop_back();
+        p.a = cast(Int(16, lanes), p.a);
+        p.b = cast(Int(16, lanes), p.b);
+        words.push_back(p);
+    }
+    if (words.size() % 2) {
+        rest.push_back(words.back().term);
+        words.pop_back();
+    }
+    if (bfloats.size() % 2) {
+        rest.push_back(bfloats.back().term);
+        bfloats.pop_back();
+    }
+
+    // A lone pair of 16-bit products with nothing to accumulate into
+    // is better handled by pmaddwd, which doesn't need AVX512-VNNI.
+    if (bytes.empty() && bfloats.empty() && (words.empty() || (words.size() == 2 && rest.empty()))) {
+        return false;
+    }
+
+    Expr init = rest.empty() ? make_zero(t) : rest[0];
+    for (size_t i = 1; i < rest.size(); i++) {
+        init += rest[i];
+    }
+
+    // The 128 and 256-bit variants require AVX512-VL, which all
+    // targets with these instructions have.
+    int intrin_lanes = lanes >= 16 ? 16 : lanes >= 8 ? 8 : 4;
+    string suffix = "." + std::to_string(intrin_lanes * 32);
+    llvm::Type *result_type = llvm_type_of(t);
+    llvm::Type *packed_type = llvm_type_of(Int(32, lanes));
+    value = codegen(init);
+
+    auto accumulate = [&](const vector<DotProductTerm> &group, const string &intrin) {
+        vector<Expr> as, bs;
+        for (const DotProductTerm &p : group) {
+            as.push_back(p.a);
+            bs.push_back(p.b);
+        }
+        Value *a = codegen(Shuffle::make_interleave(as));
+        Value *b = codegen(Shuffle::make_interleave(bs));
+        a = builder->CreateBitCast(a, packed_type);
+        b = builder->CreateBitCast(b, packed_type);
+        value = call_intrin(result_type, intrin_lanes, intrin + suffix, {value, a, b});
+    };
+
+    for (size_t i = 0; i < bytes.size(); i += 4) {
+        accumulate({bytes[i], bytes[i + 1], bytes[i + 2], bytes[i + 3]},
+                   "llvm.x86.avx512.vpdpbusd");
+    }
+    for (size_t i = 0; i < words.size(); i += 2) {
+        accumulate({words[i], words[i + 1]}, "llvm.x86.avx512.vpdpwssd");
+    }
+    for (size_t i = 0; i < bfloats.size(); i += 2) {
+        accumulate({bfloats[i], bfloats[i + 1]}, "llvm.x86.avx512bf16.dpbf16ps");
+    }
+    return true;
+}
 
 void CodeGen_X86::visit(const Add *op) {
     vector<Expr> matches;
-    if (should_use_pmaddwd(op->a, op->b, matches)) {
+    if (try_to_use_dot_product(op)) {
+        return;
+    } else if (should_use_pmaddwd(op->a, op->b, matches)) {
         codegen(Call::make(op->type, "pmaddwd", matches, Call::Extern));
     } else {
         CodeGen_Posix::visit(op);
     }
 }
 
+void CodeGen_X86::codegen_vector_reduce(const VectorReduce *op, const Expr &init) {
+    const int lanes = op->type.lanes();
+    const int input_lanes = op->value.type().lanes();
+    const int factor = input_lanes / lanes;
+
+    const bool avx512bw = (target.has_feature(Target::AVX512_Skylake) ||
+                           target.has_feature(Target::AVX512_Cannonlake) ||
+                           target.has_feature(Target::AVX512_Cascadelake) ||
+                           target.has_feature(Target::AVX512_Cooperlake));
+    const bool avx2 = avx512bw || target.has_feature(Target::AVX2);
+#if LLVM_VERSION >= 70
+    const bool vnni = (target.has_feature(Target::AVX512_Cascadelake) ||
+                       target.has_feature(Target::AVX512_Cooperlake));
+#else
+    const bool vnni = false;
+#endif
+
+    if (op->op != VectorReduce::Add || factor == 1) {
+        CodeGen_Posix::codegen_vector_reduce(op, init);
+        return;
+    }
+
+    // Reduce by some factor using a horizontal instruction, then
+    // finish off the reduction (if there's anything left to do) with
+    // the generic code.
+    Value *partial = nullptr;
+    Type partial_type;
+    Expr acc = init;
+    Expr a, b;
+    const Cast *widen = op->value.as<Cast>();
+    if (vnni && factor % 4 == 0 && op->type.is_int() && op->type.bits() == 32 &&
+        match_narrow_product(op->value, UInt(8, input_lanes), Int(8, input_lanes), a, b)) {
+        // vpdpbusd sums groups of four adjacent u8 x i8 products into
+        // each 32-bit lane, and adds an accumulator.
+        partial_type = Int(32, input_lanes / 4);
+        Value *init_value;
+        if (factor == 4 && acc.defined()) {
+            init_value = codegen(acc);
+            acc = Expr();
+        } else {
+            init_value = codegen(make_zero(partial_type));
+        }
+        llvm::Type *packed_type = llvm_type_of(partial_type);
+        Value *a_value = builder->CreateBitCast(codegen(a), packed_type);
+        Value *b_value = builder->CreateBitCast(codegen(b), packed_type);
+        int intrin_lanes = partial_type.lanes() >= 16 ? 16 : partial_type.lanes() >= 8 ? 8 : 4;
+        partial = call_intrin(packed_type, intrin_lanes,
+                              "llvm.x86.avx512.vpdpbusd." + std::to_string(intrin_lanes * 32),
+                              {init_value, a_value, b_value});
+    } else if (factor % 2 == 0 && op->type.is_int() && op->type.bits() == 32 &&
+               match_narrow_product(op->value, Int(16, input_lanes), Int(16, input_lanes), a, b)) {
+        // pmaddwd sums adjacent pairs of 16-bit products into 32-bit
+        // lanes.
+        partial_type = Int(32, input_lanes / 2);
+        if (avx512bw && partial_type.lanes() >= 16) {
+            partial = call_intrin(partial_type, 16, "llvm.x86.avx512.pmaddw.d.512", {a, b});
+        } else if (avx2 && partial_type.lanes() >= 8) {
+            partial = call_intrin(partial_type, 8, "llvm.x86.avx2.pmadd.wd", {a, b});
+        } else {
+            partial = call_intrin(partial_type, 4, "llvm.x86.sse2.pmadd.wd", {a, b});
+        }
+    } else if (factor % 8 == 0 && op->type.is_uint() && op->type.bits() >= 16 &&
+               widen && widen->value.type().element_of() == UInt(8)) {
+        // psadbw computes the sum of absolute differences of groups
+        // of eight bytes. Against zero that's a horizontal sum, which
+        // can't overflow 16 bits.
+        partial_type = UInt(64, input_lanes / 8);
+        Expr zero = make_zero(widen->value.type());
+        if (avx512bw && partial_type.lanes() >= 8) {
+            partial = call_intrin(partial_type, 8, "llvm.x86.avx512.psad.bw.512", {widen->value, zero});
+        } else if (avx2 && partial_type.lanes() >= 4) {
+            partial = call_intrin(partial_type, 4, "llvm.x86.avx2.psad.bw", {widen->value, zero});
+        } else {
+            partial = call_intrin(partial_type, 2, "llvm.x86.sse2.psad.bw", {widen->value, zero});
+        }
+    }
+
+    if (!partial) {
+        CodeGen_Posix::codegen_vector_reduce(op, init);
+        return;
+    }
+
+    string name = unique_name('t');
+    sym_push(name, partial);
+    Expr e = Variable::make(partial_type, name);
+    e = cast(op->type.with_lanes(partial_type.lanes()), e);
+    if (partial_type.lanes() != lanes) {
+        e = VectorReduce::make(VectorReduce::Add, e, lanes);
+    }
+    if (acc.defined()) {
+        e = Add::make(acc, e);
+    }
+    value = codegen(e);
+    sym_pop(name);
+}
+
 
 void CodeGen_X86::visit(const Sub *op) {
     vector<Expr> matches;
@@ -397,6 +677,10 @@ Expr CodeGen_X86::mulhi_shr(Expr a, Expr b, int shr) {
 }
 
 string CodeGen_X86::mcpu() const {
+#if LLVM_VERSION >= 80
+    if (target.has_feature(Target::AVX512_Cooperlake)) return "cascadelake";
+    if (target.has_feature(Target::AVX512_Cascadelake)) return "cascadelake";
+#endif
     if (target.has_feature(Target::AVX512_Cannonlake)) return "cannonlake";
     if (target.has_feature(Target::AVX512_Skylake)) return "skylake-avx512";
     if (target.has_feature(Target::AVX512_KNL)) return "knl";
@@ -426,19 +710,34 @@ string CodeGen_X86::mattrs() const {
     if (target.has_feature(Target::AVX512) ||
         target.has_feature(Target::AVX512_KNL) ||
         target.has_feature(Target::AVX512_Skylake) ||
-        target.has_feature(Target::AVX512_Cannonlake)) {
+        target.has_feature(Target::AVX512_Cannonlake) ||
+        target.has_feature(Target::AVX512_Cascadelake) ||
+        target.has_feature(Target::AVX512_Cooperlake)) {
         features += separator + "+avx512f,+avx512cd";
         separator = ",";
         if (target.has_feature(Target::AVX512_KNL)) {
             features += ",+avx512pf,+avx512er";
         }
         if (target.has_feature(Target::AVX512_Skylake) ||
-            target.has_feature(Target::AVX512_Cannonlake)) {
+            target.has_feature(Target::AVX512_Cannonlake) ||
+            target.has_feature(Target::AVX512_Cascadelake) ||
+            target.has_feature(Target::AVX512_Cooperlake)) {
             features += ",+avx512vl,+avx512bw,+avx512dq";
         }
         if (target.has_feature(Target::AVX512_Cannonlake)) {
             features += ",+avx512ifma,+avx512vbmi";
         }
+#if LLVM_VERSION >= 70
+        if (target.has_feature(Target::AVX512_Cascadelake) ||
+            target.has_feature(Target::AVX512_Cooperlake)) {
+            features += ",+avx512vnni";
+        }
+#endif
+#if LLVM_VERSION >= 90
+        if (target.has_feature(Target::AVX512_Cooperlake)) {
+            features += ",+avx512bf16";
+        }
+#endif
     }
     return features;
 }
@@ -451,7 +750,9 @@ int CodeGen_X86::native_vector_bits() const {
     if (target.has_feature(Target::AVX512) ||
         target.has_feature(Target::AVX512_Skylake) ||
         target.has_feature(Target::AVX512_KNL) ||
-        target.has_feature(Target::AVX512_Cannonlake)) {
+        target.has_feature(Target::AVX512_Cannonlake) ||
+        target.has_feature(Target::AVX512_Cascadelake) ||
+        target.has_feature(Target::AVX512_Cooperlake)) {
         return 512;
     } else if (target.has_feature(Target::AVX) ||
                target.has_feature(Target::AVX2)) {
@@ -30,6 +30,15 @@ protected:
 
     Expr mulhi_shr(Expr a, Expr b, int shr) override;
 
+    /** Try to generate a sum of products of narrow types using the
+     * AVX512-VNNI or AVX512-BF16 dot product instructions. Returns
+     * false if the Add is not of a suitable form. */
+    bool try_to_use_dot_product(const Add *op);
+
+    /** Use pmaddwd, psadbw, and the AVX512-VNNI dot products for
+     * horizontal adds where possible. */
+    void codegen_vector_reduce(const VectorReduce *op, const Expr &init) override;
+
     using CodeGen_Posix::visit;
 
     /** Nodes for which we want to emit specific sse/avx intrinsics */
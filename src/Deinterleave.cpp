@@ -326,6 +326,24 @@ private:
             return Shuffle::make({op}, indices);
         }
     }
+
+    Expr visit(const VectorReduce *op) override {
+        if (op->type.is_scalar()) {
+            return op;
+        }
+        // Each output lane is a reduction over a group of adjacent
+        // input lanes, so gather the groups for the lanes we want.
+        const int factor = op->value.type().lanes() / op->type.lanes();
+        std::vector<int> input_lanes;
+        for (int i = 0; i < new_lanes; i++) {
+            int lane = starting_lane + i * lane_stride;
+            for (int j = 0; j < factor; j++) {
+                input_lanes.push_back(lane * factor + j);
+            }
+        }
+        Expr in = Shuffle::make({op->value}, input_lanes);
+        return VectorReduce::make(op->op, in, new_lanes);
+    }
 };
 
 Expr extract_odd_lanes(Expr e, const Scope<> &lets) {
@@ -0,0 +1,230 @@
+#include "EmulateFloat16Math.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+bool is_float16(const Type &t) {
+    return t.is_float() && t.bits() == 16;
+}
+
+// Float(16) versions of math library functions are named with an
+// _f16 suffix, like their Float(32) counterparts.
+bool is_float16_math_call(const Call *op) {
+    return op->call_type == Call::PureExtern && ends_with(op->name, "_f16");
+}
+
+class EmulateFloat16Math : public IRMutator2 {
+    using IRMutator2::visit;
+
+    // Whether or not to move Float(16) arithmetic into Float(32). If
+    // false, we only lower math library calls.
+    bool widen_arithmetic;
+
+    // Whether to keep intermediate results in Float(32). If false,
+    // each result is rounded to Float(16), so that we get the same
+    // answer as native half-precision arithmetic.
+    bool relaxed;
+
+    // Round a Float(32) value to the nearest Float(16), unless we're
+    // allowed to keep the extra precision.
+    Expr round_to_float16(const Expr &e, const Type &t) {
+        return relaxed ? e : Cast::make(e.type(), Cast::make(t, e));
+    }
+
+    // Lets whose values have been widened to Float(32).
+    Scope<> widened_lets;
+
+    Expr widen_math_call(const Call *op) {
+        std::vector<Expr> args;
+        for (const Expr &a : op->args) {
+            if (is_float16(a.type())) {
+                args.push_back(widen(a));
+            } else {
+                args.push_back(mutate(a));
+            }
+        }
+        Type t = is_float16(op->type) ? op->type.with_bits(32) : op->type;
+        std::string name = op->name.substr(0, op->name.size() - 4) + "_f32";
+        return Call::make(t, name, args, Call::PureExtern);
+    }
+
+    // Given a Float(16) arithmetic Expr, return the same operation
+    // done in Float(32) on widened operands, without rounding the
+    // result, or an undefined Expr if we can't do it in Float(32).
+    Expr widen_operation(const Expr &e) {
+        if (const Add *op = e.as<Add>()) {
+            return Add::make(widen(op->a), widen(op->b));
+        } else if (const Sub *op = e.as<Sub>()) {
+            return Sub::make(widen(op->a), widen(op->b));
+        } else if (const Mul *op = e.as<Mul>()) {
+            return Mul::make(widen(op->a), widen(op->b));
+        } else if (const Div *op = e.as<Div>()) {
+            return Div::make(widen(op->a), widen(op->b));
+        } else if (const Min *op = e.as<Min>()) {
+            return Min::make(widen(op->a), widen(op->b));
+        } else if (const Max *op = e.as<Max>()) {
+            return Max::make(widen(op->a), widen(op->b));
+        } else if (const Select *op = e.as<Select>()) {
+            return Select::make(mutate(op->condition), widen(op->true_value), widen(op->false_value));
+        } else if (!relaxed) {
+            // Float(32) has enough precision that rounding a single
+            // add, subtract, multiply, or divide to Float(16) gives
+            // the correctly rounded result. That isn't true of the
+            // steps of a mod or a reduction, so leave those in
+            // Float(16).
+        } else if (const Mod *op = e.as<Mod>()) {
+            return Mod::make(widen(op->a), widen(op->b));
+        } else if (const VectorReduce *op = e.as<VectorReduce>()) {
+            return VectorReduce::make(op->op, widen(op->value), op->type.lanes());
+        }
+        return Expr();
+    }
+
+    // Given a Float(16) Expr, return an equivalent Float(32) Expr
+    // with any arithmetic done in Float(32).
+    Expr widen(const Expr &e) {
+        internal_assert(is_float16(e.type()));
+        Type wide = e.type().with_bits(32);
+        if (const FloatImm *imm = e.as<FloatImm>()) {
+            return FloatImm::make(wide, imm->value);
+        } else if (const Broadcast *op = e.as<Broadcast>()) {
+            return Broadcast::make(widen(op->value), op->lanes);
+        } else if (const Call *op = e.as<Call>()) {
+            if (is_float16_math_call(op)) {
+                return round_to_float16(widen_math_call(op), e.type());
+            }
+        } else if (!widen_arithmetic) {
+            // Fall through to the cast below.
+        } else if (const Variable *op = e.as<Variable>()) {
+            if (widened_lets.contains(op->name)) {
+                return Variable::make(wide, op->name);
+            }
+        } else if (e.as<Min>() || e.as<Max>() || e.as<Select>()) {
+            // These pick one of their operands, so there is nothing
+            // to round.
+            return widen_operation(e);
+        } else {
+            Expr result = widen_operation(e);
+            if (result.defined()) {
+                return round_to_float16(result, e.type());
+            }
+        }
+        // Loads, casts, and anything else we don't know how to widen
+        // are converted to Float(32) after the fact.
+        return Cast::make(wide, mutate(e));
+    }
+
+    template<typename T>
+    Expr visit_arithmetic(const T *op) {
+        Expr result;
+        if (widen_arithmetic && is_float16(op->type)) {
+            result = widen_operation(op);
+        }
+        if (result.defined()) {
+            return Cast::make(op->type, result);
+        } else {
+            return IRMutator2::visit(op);
+        }
+    }
+
+    template<typename T>
+    Expr visit_comparison(const T *op) {
+        if (widen_arithmetic && is_float16(op->a.type())) {
+            return T::make(widen(op->a), widen(op->b));
+        } else {
+            return IRMutator2::visit(op);
+        }
+    }
+
+    Expr visit(const Add *op) override { return visit_arithmetic(op); }
+    Expr visit(const Sub *op) override { return visit_arithmetic(op); }
+    Expr visit(const Mul *op) override { return visit_arithmetic(op); }
+    Expr visit(const Div *op) override { return visit_arithmetic(op); }
+    Expr visit(const Mod *op) override { return visit_arithmetic(op); }
+    Expr visit(const Min *op) override { return visit_arithmetic(op); }
+    Expr visit(const Max *op) override { return visit_arithmetic(op); }
+    Expr visit(const VectorReduce *op) override { return visit_arithmetic(op); }
+
+    Expr visit(const EQ *op) override { return visit_comparison(op); }
+    Expr visit(const NE *op) override { return visit_comparison(op); }
+    Expr visit(const LT *op) override { return visit_comparison(op); }
+    Expr visit(const LE *op) override { return visit_comparison(op); }
+    Expr visit(const GT *op) override { return visit_comparison(op); }
+    Expr visit(const GE *op) override { return visit_comparison(op); }
+
+    Expr visit(const Cast *op) override {
+        if (widen_arithmetic && is_float16(op->value.type()) && !is_float16(op->type)) {
+            // Every Float(16) value is exactly representable as a
+            // Float(32), so we can cast from the wider value instead.
+            return Cast::make(op->type, widen(op->value));
+        } else {
+            return IRMutator2::visit(op);
+        }
+    }
+
+    Expr visit(const Variable *op) override {
+        if (widened_lets.contains(op->name)) {
+            return Cast::make(op->type, Variable::make(op->type.with_bits(32), op->name));
+        } else {
+            return op;
+        }
+    }
+
+    Expr visit(const Call *op) override {
+        if (is_float16_math_call(op)) {
+            Expr e = widen_math_call(op);
+            return is_float16(op->type) ? Cast::make(op->type, e) : e;
+        } else {
+            return IRMutator2::visit(op);
+        }
+    }
+
+    template<typename LetOrLetStmt>
+    auto visit_let(const LetOrLetStmt *op) -> decltype(op->body) {
+        if (!widen_arithmetic || !is_float16(op->value.type())) {
+            return IRMutator2::visit(op);
+        }
+        // Keep the value in Float(32), so that it isn't rounded
+        // on the way into the body.
+        Expr value = widen(op->value);
+        widened_lets.push(op->name);
+        auto body = mutate(op->body);
+        widened_lets.pop(op->name);
+        return LetOrLetStmt::make(op->name, value, body);
+    }
+
+    Expr visit(const Let *op) override { return visit_let(op); }
+    Stmt visit(const LetStmt *op) override { return visit_let(op); }
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host &&
+            op->device_api != DeviceAPI::Hexagon) {
+            // GPU backends handle half precision themselves.
+            return op;
+        } else {
+            return IRMutator2::visit(op);
+        }
+    }
+
+public:
+    EmulateFloat16Math(bool widen_arithmetic, bool relaxed)
+        : widen_arithmetic(widen_arithmetic), relaxed(relaxed) {}
+};
+
+}  // namespace
+
+Stmt emulate_float16_math(Stmt s, const Target &t, bool any_strict_float) {
+    bool native = t.arch == Target::ARM && t.has_feature(Target::ARMFp16);
+    return EmulateFloat16Math(!native && !any_strict_float,
+                              t.has_feature(Target::RelaxedFloat16)).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
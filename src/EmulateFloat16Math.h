@@ -0,0 +1,33 @@
+#ifndef HALIDE_EMULATE_FLOAT16_MATH_H
+#define HALIDE_EMULATE_FLOAT16_MATH_H
+
+/** \file
+ * Defines the lowering pass that decides how Float(16) arithmetic is
+ * done on the target.
+ */
+
+#include "Expr.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Most CPUs can convert to and from half precision, but can't do
+ * arithmetic on it. On such targets, rewrite Float(16) arithmetic to
+ * happen in Float(32), rounding the result of each operation to
+ * Float(16) so that the answer is the same as with native
+ * half-precision arithmetic. With the RelaxedFloat16 target feature,
+ * values are instead only narrowed back to Float(16) where they leave
+ * an expression (e.g. when they are stored), which is faster and
+ * more accurate, but gives different answers on targets with native
+ * support. Where the target supports half-precision arithmetic
+ * natively (ARM with ARMFp16), or where strict_float is in use, the
+ * arithmetic is left in Float(16). Calls to math library functions
+ * on Float(16) are always done in Float(32), because there is no
+ * half-precision math library. GPU loops are left alone. */
+Stmt emulate_float16_math(Stmt s, const Target &t, bool any_strict_float);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -1733,6 +1733,14 @@ Stage &Stage::prefetch(const Internal::Parameter &param, VarOrRVar var, Expr off
     return *this;
 }
 
+Stage &Stage::auto_prefetch(VarOrRVar var, PrefetchBoundStrategy strategy) {
+    // An empty name and an undefined offset means to prefetch every
+    // input at an automatically chosen distance.
+    PrefetchDirective prefetch = {"", var.name(), Expr(), strategy, Parameter()};
+    definition.schedule().prefetches().push_back(prefetch);
+    return *this;
+}
+
 Stage &Stage::compute_with(LoopLevel loop_level, const map<string, LoopAlignStrategy> &align) {
     loop_level.lock();
     user_assert(!loop_level.is_inlined() && !loop_level.is_root())
@@ -2002,6 +2010,12 @@ Func &Func::async() {
     return *this;
 }
 
+Func &Func::auto_fuse() {
+    invalidate_cache();
+    func.schedule().auto_fuse() = true;
+    return *this;
+}
+
 Stage Func::specialize(Expr c) {
     invalidate_cache();
     return Stage(func, func.definition(), 0, args()).specialize(c);
@@ -2317,6 +2331,12 @@ Func &Func::prefetch(const Internal::Parameter &param, VarOrRVar var, Expr offse
     return *this;
 }
 
+Func &Func::auto_prefetch(VarOrRVar var, PrefetchBoundStrategy strategy) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0, args()).auto_prefetch(var, strategy);
+    return *this;
+}
+
 Func &Func::reorder_storage(Var x, Var y) {
     invalidate_cache();
 
@@ -3085,6 +3105,11 @@ void Func::realize(Pipeline::RealizationArg outputs, const Target &target,
     pipeline().realize(std::move(outputs), target, param_map);
 }
 
+void Func::realize(JITUserContext *context, Pipeline::RealizationArg outputs,
+                   const Target &target, const ParamMap &param_map) {
+    pipeline().realize(context, std::move(outputs), target, param_map);
+}
+
 void Func::infer_input_bounds(Pipeline::RealizationArg outputs,
                               const ParamMap &param_map) {
     pipeline().infer_input_bounds(std::move(outputs), param_map);
@@ -3094,6 +3119,14 @@ void *Func::compile_jit(const Target &target) {
     return pipeline().compile_jit(target);
 }
 
+void *Func::compile_jit(const vector<Target> &targets) {
+    return pipeline().compile_jit(targets);
+}
+
+Callable Func::compile_to_callable(const vector<Argument> &args, const Target &target) {
+    return pipeline().compile_to_callable(args, target);
+}
+
 Var _("_");
 Var _0("_0"), _1("_1"), _2("_2"), _3("_3"), _4("_4"),
            _5("_5"), _6("_6"), _7("_7"), _8("_8"), _9("_9");
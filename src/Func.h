@@ -428,6 +428,8 @@ public:
                     PrefetchBoundStrategy strategy = PrefetchBoundStrategy::GuardWithIf) {
         return prefetch(image.parameter(), var, offset, strategy);
     }
+    Stage &auto_prefetch(VarOrRVar var,
+                         PrefetchBoundStrategy strategy = PrefetchBoundStrategy::GuardWithIf);
     // @}
 
     /** Attempt to get the source file and line where this stage was
@@ -777,7 +779,13 @@ public:
      * function, strange things may happen, as the pipeline isn't
      * necessarily safe to run in-place. If you pass multiple buffers,
      * they must have matching sizes. This form of realize does *not*
-     * automatically copy data back from the GPU. */
+     * automatically copy data back from the GPU. The form taking a
+     * JITUserContext uses its user context and handlers for this call
+     * only; see Pipeline::realize. */
+    void realize(Internal::JITUserContext *context,
+                 Pipeline::RealizationArg outputs,
+                 const Target &target = Target(),
+                 const ParamMap &param_map = ParamMap::empty_map());
     void realize(Pipeline::RealizationArg outputs, const Target &target = Target(),
                  const ParamMap &param_map = ParamMap::empty_map());
 
@@ -946,6 +954,15 @@ public:
      */
     void *compile_jit(const Target &target = get_jit_target_from_environment());
 
+    /** Jit compile the function for the best of several
+     * Targets. See Pipeline::compile_jit. */
+    void *compile_jit(const std::vector<Target> &targets);
+
+    /** Jit compile the function, and return a Callable that runs it
+     * with very low overhead. See Pipeline::compile_to_callable. */
+    Callable compile_to_callable(const std::vector<Argument> &args,
+                                 const Target &target = get_jit_target_from_environment());
+
     /** Set the error handler function that be called in the case of
      * runtime errors during halide pipelines. If you are compiling
      * statically, you can also just define your own function with
@@ -1913,6 +1930,17 @@ public:
     }
     // @}
 
+    /** Prefetch all the Funcs and images read by the loop over 'var'
+     * whose footprint moves with 'var'. The prefetch distance is
+     * chosen automatically, by comparing an estimate of the cost of
+     * one iteration of the loop to the latency of main memory. Funcs
+     * that are inlined or computed inside the loop are not
+     * prefetched. Explicit calls to \ref Func::prefetch for the same
+     * loop take precedence, whether they come before or after this
+     * call. */
+    Func &auto_prefetch(VarOrRVar var,
+                        PrefetchBoundStrategy strategy = PrefetchBoundStrategy::GuardWithIf);
+
     /** Specify how the storage for the function is laid out. These
      * calls let you specify the nesting order of the dimensions. For
      * example, foo.reorder_storage(y, x) tells Halide to use
@@ -2134,6 +2162,17 @@ public:
      */
     Func &async();
 
+    /** Allow the compiler to fuse the outermost loop of this Func
+     * with the outermost loops of other Funcs marked auto_fuse that
+     * are computed at the same loop level, have no dependencies on
+     * this one, and read the same region of some common input per
+     * iteration of that loop. This is equivalent to scheduling them
+     * with compute_with at the outermost loop, except that the
+     * compiler picks the groups. Funcs with update definitions,
+     * specializations, or an explicit compute_with are never
+     * fused. */
+    Func &auto_fuse();
+
     /** Allocate storage for this function within f's loop over
      * var. Scheduling storage is optional, and can be used to
      * separate the loop level at which storage occurs from the loop
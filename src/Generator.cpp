@@ -1,7 +1,14 @@
 #include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <random>
 #include <set>
 
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+#include "BatchDimension.h"
 #include "Generator.h"
 #include "Outputs.h"
 #include "Simplify.h"
@@ -123,6 +130,176 @@ Outputs compute_outputs(const Target &target,
     return output_files;
 }
 
+// The names of all the files an Outputs struct asks for.
+std::vector<std::string> output_paths(const Outputs &output_files) {
+    std::vector<std::string> paths;
+    for (const std::string *p : {&output_files.object_name,
+                                 &output_files.assembly_name,
+                                 &output_files.bitcode_name,
+                                 &output_files.llvm_assembly_name,
+                                 &output_files.c_header_name,
+                                 &output_files.c_source_name,
+                                 &output_files.stmt_name,
+                                 &output_files.stmt_html_name,
+                                 &output_files.static_library_name,
+                                 &output_files.python_extension_name,
+                                 &output_files.schedule_name}) {
+        if (!p->empty()) {
+            paths.push_back(*p);
+        }
+    }
+    return paths;
+}
+
+// 64-bit FNV-1a.
+const uint64_t fnv_offset_basis = 14695981039346656037ULL;
+
+uint64_t hash_bytes(uint64_t h, const char *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        h ^= (uint8_t)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool hash_file(const std::string &path, uint64_t *h) {
+    std::ifstream f(path, std::ios::in | std::ios::binary);
+    if (!f) {
+        return false;
+    }
+    std::vector<char> buf(1 << 16);
+    while (f) {
+        f.read(buf.data(), buf.size());
+        *h = hash_bytes(*h, buf.data(), (size_t)f.gcount());
+    }
+    return true;
+}
+
+// Hash the code that is doing the compilation: the generator
+// executable, and the Halide library if it is a separate shared
+// library. Returns false if they can't be found.
+bool hash_compiler_binaries(const char *argv0, uint64_t *h) {
+#ifdef __linux__
+    const std::string executable = "/proc/self/exe";
+#else
+    const std::string executable = argv0;
+#endif
+    if (!hash_file(executable, h)) {
+        return false;
+    }
+#ifndef _WIN32
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void *>(&generate_filter_main), &info) && info.dli_fname) {
+        if (!hash_file(info.dli_fname, h)) {
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+bool copy_file(const std::string &from, const std::string &to) {
+    std::ifstream in(from, std::ios::in | std::ios::binary);
+    std::ofstream out(to, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!in || !out) {
+        return false;
+    }
+    std::vector<char> buf(1 << 16);
+    while (in) {
+        in.read(buf.data(), buf.size());
+        out.write(buf.data(), in.gcount());
+    }
+    return !out.fail();
+}
+
+std::string read_file(const std::string &path) {
+    std::ifstream f(path, std::ios::in | std::ios::binary);
+    std::ostringstream contents;
+    contents << f.rdbuf();
+    return contents.str();
+}
+
+// A directory of previously produced outputs, indexed by a hash of
+// everything that can affect their contents. Each entry holds the
+// outputs, in the order they were asked for, along with the full key
+// so that hash collisions are detected.
+class GeneratorOutputCache {
+    std::string cache_dir;
+    std::string entry;
+    std::string key;
+
+    // Make the cache directory, and any missing parents.
+    bool make_cache_dir() const {
+        for (size_t i = cache_dir.find_first_of("/\\", 1); ; i = cache_dir.find_first_of("/\\", i + 1)) {
+            std::string dir = cache_dir.substr(0, i);
+            if (!file_exists(dir)) {
+                dir_make(dir);
+            }
+            if (i == std::string::npos) {
+                return file_exists(dir);
+            }
+        }
+    }
+
+public:
+    GeneratorOutputCache(const std::string &cache_dir, const std::string &key, uint64_t hash)
+        : cache_dir(cache_dir), key(key) {
+        std::ostringstream name;
+        name << cache_dir << "/" << std::hex << std::setfill('0') << std::setw(16) << hash;
+        entry = name.str();
+    }
+
+    // Copy the cached outputs into place, if there are any.
+    bool restore(const std::vector<std::string> &paths) const {
+        if (!file_exists(entry + "/key") || read_file(entry + "/key") != key) {
+            return false;
+        }
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (!copy_file(entry + "/" + std::to_string(i), paths[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Add the outputs to the cache. Entries are written to a
+    // temporary directory and then renamed, so concurrent builds never
+    // see a partial entry.
+    void store(const std::vector<std::string> &paths, std::ostream &cerr) const {
+        std::ostringstream tmp_name;
+        tmp_name << entry << ".tmp." << std::hex << std::random_device()();
+        const std::string tmp = tmp_name.str();
+        if (!make_cache_dir() || !dir_make(tmp)) {
+            cerr << "Warning: Unable to write to the generator cache directory " << cache_dir << "\n";
+            return;
+        }
+        std::vector<std::string> files;
+        bool ok = true;
+        for (size_t i = 0; ok && i < paths.size(); i++) {
+            files.push_back(tmp + "/" + std::to_string(i));
+            ok = copy_file(paths[i], files.back());
+        }
+        if (ok) {
+            std::ofstream(tmp + "/key", std::ios::out | std::ios::binary) << key;
+            files.push_back(tmp + "/key");
+            ok = std::rename(tmp.c_str(), entry.c_str()) == 0;
+        }
+        if (!ok) {
+            // Either something went wrong, or another build stored
+            // the same entry first.
+            if (!file_exists(entry)) {
+                cerr << "Warning: Unable to add an entry to the generator cache directory " << cache_dir << "\n";
+            }
+            for (const std::string &f : files) {
+                if (file_exists(f)) {
+                    file_unlink(f);
+                }
+            }
+            dir_rmdir(tmp);
+        }
+    }
+};
+
 Argument to_argument(const Internal::Parameter &param, const Expr &default_value) {
     Expr def, min, max;
     if (!param.is_buffer()) {
@@ -273,7 +450,8 @@ private:
             // These are always propagated specially.
             if (p->name == "target" ||
                 p->name == "auto_schedule" ||
-                p->name == "machine_params") continue;
+                p->name == "machine_params" ||
+                p->name == "batch") continue;
             if (p->is_synthetic_param()) continue;
             out.push_back(p);
         }
@@ -790,12 +968,15 @@ std::string halide_type_to_c_type(const Type &t) {
 }
 
 int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
-    const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] "
+    const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] [-c CACHE_DIR] "
                           "target=target-string[,target-string...] [generator_arg=value [...]]\n\n"
                           "  -e  A comma separated list of files to emit. Accepted values are "
                           "[assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub, schedule]. If omitted, default value is [static_library, h].\n"
                           "  -x  A comma separated list of file extension pairs to substitute during file naming, "
-                          "in the form [.old=.new[,.old2=.new2]]\n";
+                          "in the form [.old=.new[,.old2=.new2]]\n"
+                          "  -c  A directory in which to cache outputs, keyed by a hash of the generator executable, "
+                          "the Halide library, and all of the arguments. If omitted, the HL_GENERATOR_CACHE_DIR "
+                          "environment variable is used. If that is also unset, nothing is cached.\n";
 
     std::map<std::string, std::string> flags_info = { { "-f", "" },
                                                       { "-g", "" },
@@ -803,7 +984,8 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                                                       { "-e", "" },
                                                       { "-n", "" },
                                                       { "-x", "" },
-                                                      { "-r", "" }};
+                                                      { "-r", "" },
+                                                      { "-c", "" }};
     GeneratorParamsMap generator_args;
 
     for (int i = 1; i < argc; ++i) {
@@ -939,18 +1121,81 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
         targets.push_back(Target(s));
     }
 
+    if (!runtime_name.empty() && targets.size() != 1) {
+        cerr << "Only one target allowed here";
+        return 1;
+    }
+
+    // Find all the files we're going to produce.
+    std::string runtime_base_path, base_path;
+    std::vector<std::string> paths;
     if (!runtime_name.empty()) {
-        if (targets.size() != 1) {
-            cerr << "Only one target allowed here";
-            return 1;
+        runtime_base_path = compute_base_path(output_dir, runtime_name, "");
+        for (const auto &p : output_paths(compute_outputs(targets[0], runtime_base_path, emit_options))) {
+            paths.push_back(p);
+        }
+    }
+    if (!generator_name.empty()) {
+        base_path = compute_base_path(output_dir, function_name, file_base_name);
+        if (emit_options.emit_cpp_stub) {
+            paths.push_back(base_path + get_extension(".stub.h", emit_options));
         }
-        std::string base_path = compute_base_path(output_dir, runtime_name, "");
-        Outputs output_files = compute_outputs(targets[0], base_path, emit_options);
+        if (!stub_only) {
+            for (const auto &p : output_paths(compute_outputs(targets[0], base_path, emit_options))) {
+                paths.push_back(p);
+            }
+        }
+    }
+
+    // If we have produced these files before, with the same
+    // generator, Halide, and arguments, just copy them into place.
+    std::string cache_dir = flags_info["-c"];
+    if (cache_dir.empty()) {
+        cache_dir = get_env_variable("HL_GENERATOR_CACHE_DIR");
+    }
+    std::unique_ptr<GeneratorOutputCache> cache;
+    if (!cache_dir.empty()) {
+        uint64_t hash = fnv_offset_basis;
+        if (hash_compiler_binaries(argv[0], &hash)) {
+            // The output directory doesn't affect the contents of the
+            // files, but the names of the files do.
+            std::ostringstream key;
+            key << "generator=" << generator_name << "\n"
+                << "function=" << function_name << "\n"
+                << "file_base_name=" << file_base_name << "\n"
+                << "runtime=" << runtime_name << "\n"
+                << "emit=" << flags_info["-e"] << "\n"
+                << "substitutions=" << flags_info["-x"] << "\n";
+            // Targets like "host" depend on the machine, so use the
+            // resolved Targets.
+            for (const Target &t : targets) {
+                key << "target=" << t.to_string() << "\n";
+            }
+            for (const auto &arg : generator_args) {
+                if (arg.first != "target") {
+                    key << "param." << arg.first << "=" << arg.second.string_value << "\n";
+                }
+            }
+            for (const auto &p : paths) {
+                key << "output=" << p.substr(output_dir.size()) << "\n";
+            }
+            hash = hash_bytes(hash, key.str().data(), key.str().size());
+            cache.reset(new GeneratorOutputCache(cache_dir, key.str(), hash));
+            if (cache->restore(paths)) {
+                debug(1) << "Copied outputs of " << generator_name << " from cache " << cache_dir << "\n";
+                return 0;
+            }
+        } else {
+            cerr << "Warning: Unable to read the generator executable, so outputs will not be cached.\n";
+        }
+    }
+
+    if (!runtime_name.empty()) {
+        Outputs output_files = compute_outputs(targets[0], runtime_base_path, emit_options);
         compile_standalone_runtime(output_files, targets[0]);
     }
 
     if (!generator_name.empty()) {
-        std::string base_path = compute_base_path(output_dir, function_name, file_base_name);
         debug(1) << "Generator " << generator_name << " has base_path " << base_path << "\n";
         if (emit_options.emit_cpp_stub) {
             // When generating cpp_stub, we ignore all generator args passed in, and supply a fake Target.
@@ -982,6 +1227,10 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
         }
     }
 
+    if (cache) {
+        cache->store(paths, cerr);
+    }
+
     return 0;
 }
 
@@ -1396,6 +1645,11 @@ Module GeneratorBase::build_module(const std::string &function_name,
     }
 
     Module result = pipeline.compile_to_module(filter_arguments, function_name, target, linkage_type);
+    if (batch) {
+        // The pipeline is the first function in the Module, which has
+        // a generated name if function_name is empty.
+        result = add_batch_dimension(result, result.functions().front().name);
+    }
     std::shared_ptr<ExternsMap> externs_map = get_externs_map();
     for (const auto &map_entry : *externs_map) {
         result.append(map_entry.second);
@@ -194,6 +194,11 @@
  *    being targeted which may be used to enhance the automatically-generated
  *    schedule.
  *
+ *  Generators also have a 'batch' GeneratorParam (default false). If true, every
+ *  buffer Input and Output of the compiled pipeline gets an extra outermost
+ *  dimension, and the pipeline runs on each slice of it in parallel, so a
+ *  Generator written for a single image can process many of them in one call.
+ *
  * Generators are added to a global registry to simplify AOT build mechanics; this
  * is done by simply using the HALIDE_REGISTER_GENERATOR macro at global scope:
  *
@@ -2774,6 +2779,12 @@ protected:
     template<typename T>
     using Output = GeneratorOutput<T>;
 
+    /** If true, build_module() gives every buffer Input and Output an
+     * extra outermost dimension and runs the pipeline on each slice
+     * of it in parallel. See Internal::add_batch_dimension. Ignored
+     * when the Generator is used via JIT or a Stub. */
+    GeneratorParam<bool> batch{"batch", false};
+
     // A Generator's creation and usage must go in a certain phase to ensure correctness;
     // the state machine here is advanced and checked at various points to ensure
     // this is the case.
@@ -644,6 +644,28 @@ Expr Shuffle::make(const std::vector<Expr> &vectors,
     return node;
 }
 
+Expr VectorReduce::make(VectorReduce::Operator op,
+                        Expr vec,
+                        int lanes) {
+    internal_assert(vec.defined()) << "VectorReduce of undefined Expr\n";
+    internal_assert(lanes > 0) << "VectorReduce to a non-positive number of lanes\n";
+    internal_assert(vec.type().lanes() % lanes == 0)
+        << "Cannot reduce " << vec.type().lanes() << " lanes to " << lanes << " lanes\n";
+    if (vec.type().is_bool()) {
+        internal_assert(op == VectorReduce::And || op == VectorReduce::Or)
+            << "The only legal operators for VectorReduce on a Bool are And and Or\n";
+    } else {
+        internal_assert(op != VectorReduce::And && op != VectorReduce::Or)
+            << "Can only use VectorReduce And and Or on Bool types\n";
+    }
+
+    VectorReduce *node = new VectorReduce;
+    node->type = vec.type().with_lanes(lanes);
+    node->op = op;
+    node->value = std::move(vec);
+    return node;
+}
+
 Expr Shuffle::make_interleave(const std::vector<Expr> &vectors) {
     internal_assert(!vectors.empty()) << "Interleave of zero vectors.\n";
 
@@ -803,6 +825,7 @@ template<> void ExprNode<Broadcast>::accept(IRVisitor *v) const { v->visit((cons
 template<> void ExprNode<Call>::accept(IRVisitor *v) const { v->visit((const Call *)this); }
 template<> void ExprNode<Shuffle>::accept(IRVisitor *v) const { v->visit((const Shuffle *)this); }
 template<> void ExprNode<Let>::accept(IRVisitor *v) const { v->visit((const Let *)this); }
+template<> void ExprNode<VectorReduce>::accept(IRVisitor *v) const { v->visit((const VectorReduce *)this); }
 template<> void StmtNode<LetStmt>::accept(IRVisitor *v) const { v->visit((const LetStmt *)this); }
 template<> void StmtNode<AssertStmt>::accept(IRVisitor *v) const { v->visit((const AssertStmt *)this); }
 template<> void StmtNode<ProducerConsumer>::accept(IRVisitor *v) const { v->visit((const ProducerConsumer *)this); }
@@ -848,6 +871,7 @@ template<> Expr ExprNode<Broadcast>::mutate_expr(IRMutator2 *v) const { return v
 template<> Expr ExprNode<Call>::mutate_expr(IRMutator2 *v) const { return v->visit((const Call *)this); }
 template<> Expr ExprNode<Shuffle>::mutate_expr(IRMutator2 *v) const { return v->visit((const Shuffle *)this); }
 template<> Expr ExprNode<Let>::mutate_expr(IRMutator2 *v) const { return v->visit((const Let *)this); }
+template<> Expr ExprNode<VectorReduce>::mutate_expr(IRMutator2 *v) const { return v->visit((const VectorReduce *)this); }
 
 template<> Stmt StmtNode<LetStmt>::mutate_stmt(IRMutator2 *v) const { return v->visit((const LetStmt *)this); }
 template<> Stmt StmtNode<AssertStmt>::mutate_stmt(IRMutator2 *v) const { return v->visit((const AssertStmt *)this); }
@@ -755,6 +755,33 @@ struct Shuffle : public ExprNode<Shuffle> {
     static const IRNodeType _node_type = IRNodeType::Shuffle;
 };
 
+/** Horizontally reduce a vector to a scalar or narrower vector using
+ * the given commutative and associative binary operator. The
+ * reduction factor is the ratio of the number of lanes in the input
+ * and output types. Groups of adjacent lanes are combined. The number
+ * of lanes in the output type must divide the number of lanes in the
+ * input type. */
+struct VectorReduce : public ExprNode<VectorReduce> {
+    // 99.9% of the time people will use this for horizontal addition,
+    // but these are all of our commutative and associative primitive
+    // operators.
+    typedef enum {
+        Add,
+        Mul,
+        Min,
+        Max,
+        And,
+        Or,
+    } Operator;
+
+    Expr value;
+    Operator op;
+
+    static Expr make(Operator op, Expr vec, int lanes);
+
+    static const IRNodeType _node_type = IRNodeType::VectorReduce;
+};
+
 /** Represent a multi-dimensional region of a Func or an ImageParam that
  * needs to be prefetched. */
 struct Prefetch : public StmtNode<Prefetch> {
@@ -593,6 +593,195 @@ Expr halide_exp(Expr x_full) {
     return result;
 }
 
+namespace {
+
+// Polynomials and range reduction for sin, cos, tan, atan and tanh,
+// based on those from Cephes (http://www.netlib.org/cephes/).
+
+// Reduce x to x - k * pi/2, where r is in [-pi/4, pi/4], and
+// approximate the sine and cosine of r. The quadrant k is returned
+// modulo 4. The reduction is accurate for |x| up to about 8192;
+// codegen falls back to libm for vectors with larger lanes.
+void range_reduce_sin_cos(const Expr &x_full, Expr *sin_r, Expr *cos_r, Expr *quadrant) {
+    Type type = x_full.type();
+
+    // pi/2 split into three parts, the first two of which have few
+    // enough bits that multiplying them by k is exact.
+    float pi_over_2_part1 = 1.5703125f;
+    float pi_over_2_part2 = 4.837512969970703125e-4f;
+    float pi_over_2_part3 = 7.54978995489188216e-8f;
+    float two_over_pi = 0.636619772367581f;
+
+    Expr k_real = floor(x_full * two_over_pi + 0.5f);
+    Expr r = x_full - k_real * pi_over_2_part1;
+    r -= k_real * pi_over_2_part2;
+    r -= k_real * pi_over_2_part3;
+
+    // Computing k mod 4 in floating point is exact, and can't
+    // overflow when cast to an int.
+    Expr q_real = k_real - floor(k_real * 0.25f) * 4.0f;
+    *quadrant = cast(Int(32, type.lanes()), q_real);
+
+    Expr r2 = r * r;
+
+    float sin_coeff[] = {
+        -1.9515295891e-4f,
+        8.3321608736e-3f,
+        -1.6666654611e-1f};
+    *sin_r = evaluate_polynomial(r2, sin_coeff, sizeof(sin_coeff)/sizeof(sin_coeff[0])) * r2 * r + r;
+
+    float cos_coeff[] = {
+        2.443315711809948e-5f,
+        -1.388731625493765e-3f,
+        4.166664568298827e-2f};
+    *cos_r = evaluate_polynomial(r2, cos_coeff, sizeof(cos_coeff)/sizeof(cos_coeff[0])) * r2 * r2 - r2 * 0.5f + 1.0f;
+}
+
+// Sine or cosine of x, which must be finite.
+Expr sin_cos(const Expr &x, bool is_cos) {
+    Expr sin_r, cos_r, quadrant;
+    range_reduce_sin_cos(x, &sin_r, &cos_r, &quadrant);
+    // cos(x) = sin(x + pi/2)
+    if (is_cos) {
+        quadrant += 1;
+    }
+    Expr result = select((quadrant & 1) == 0, sin_r, cos_r);
+    return select((quadrant & 2) == 0, result, -result);
+}
+
+// The arctangent of a non-negative x.
+Expr atan_non_negative(const Expr &x) {
+    float tan_3_pi_over_8 = 2.414213562373095f;
+    float tan_pi_over_8 = 0.4142135623730950f;
+
+    // Reduce to [-tan(pi/8), tan(pi/8)] using
+    // atan(x) = pi/2 + atan(-1/x) for large x, and
+    // atan(x) = pi/4 + atan((x - 1)/(x + 1)) for medium x.
+    Expr large = x > tan_3_pi_over_8;
+    Expr medium = x > tan_pi_over_8;
+    Expr num = select(large, -1.0f, medium, x - 1.0f, x);
+    Expr den = select(large, x, medium, x + 1.0f, 1.0f);
+    Expr offset = select(large, 1.57079632679489661923f, medium, 0.78539816339744830962f, 0.0f);
+    Expr t = num / den;
+    Expr t2 = t * t;
+
+    float coeff[] = {
+        8.05374449538e-2f,
+        -1.38776856032e-1f,
+        1.99777106478e-1f,
+        -3.33329491539e-1f};
+    return offset + (evaluate_polynomial(t2, coeff, sizeof(coeff)/sizeof(coeff[0])) * t2 * t + t);
+}
+
+}  // namespace
+
+Expr halide_sin(Expr x_full) {
+    Type type = x_full.type();
+    internal_assert(type.element_of() == Float(32));
+
+    // The sine of an infinity or a nan is nan. Compute the sine of
+    // zero instead, and then fix it later.
+    Expr nan = Call::make(type, "nan_f32", {}, Call::PureExtern);
+    Expr inf = Call::make(type, "inf_f32", {}, Call::PureExtern);
+    Expr finite = abs(x_full) < inf;
+    Expr patched = select(finite, x_full, make_zero(type));
+
+    Expr result = select(finite, sin_cos(patched, false), nan);
+    return common_subexpression_elimination(result);
+}
+
+Expr halide_cos(Expr x_full) {
+    Type type = x_full.type();
+    internal_assert(type.element_of() == Float(32));
+
+    Expr nan = Call::make(type, "nan_f32", {}, Call::PureExtern);
+    Expr inf = Call::make(type, "inf_f32", {}, Call::PureExtern);
+    Expr finite = abs(x_full) < inf;
+    Expr patched = select(finite, x_full, make_zero(type));
+
+    Expr result = select(finite, sin_cos(patched, true), nan);
+    return common_subexpression_elimination(result);
+}
+
+Expr halide_tan(Expr x_full) {
+    Type type = x_full.type();
+    internal_assert(type.element_of() == Float(32));
+
+    Expr nan = Call::make(type, "nan_f32", {}, Call::PureExtern);
+    Expr inf = Call::make(type, "inf_f32", {}, Call::PureExtern);
+    Expr finite = abs(x_full) < inf;
+    Expr patched = select(finite, x_full, make_zero(type));
+
+    // tan(x) = -cot(x - pi/2)
+    Expr sin_r, cos_r, quadrant;
+    range_reduce_sin_cos(patched, &sin_r, &cos_r, &quadrant);
+    Expr result = select((quadrant & 1) == 0, sin_r / cos_r, -cos_r / sin_r);
+
+    result = select(finite, result, nan);
+    return common_subexpression_elimination(result);
+}
+
+Expr halide_atan(Expr x_full) {
+    Type type = x_full.type();
+    internal_assert(type.element_of() == Float(32));
+
+    Expr result = atan_non_negative(abs(x_full));
+    result = select(x_full < 0.0f, -result, result);
+    return common_subexpression_elimination(result);
+}
+
+Expr halide_atan2(Expr y, Expr x) {
+    Type type = y.type();
+    internal_assert(type.element_of() == Float(32) && x.type() == type);
+
+    // Take the arctangent of a ratio in [0, 1], so that it can't
+    // overflow, and then use symmetries to find the right octant.
+    Expr abs_x = abs(x), abs_y = abs(y);
+    Expr lo = min(abs_x, abs_y);
+    Expr hi = max(abs_x, abs_y);
+    Expr ratio = select(hi == 0.0f, make_zero(type), lo / hi);
+
+    Expr result = atan_non_negative(ratio);
+    result = select(abs_y > abs_x, 1.57079632679489661923f - result, result);
+    result = select(x < 0.0f, 3.14159265358979323846f - result, result);
+    result = select(y < 0.0f, -result, result);
+
+    // min and max may drop a nan operand, so propagate it explicitly.
+    Expr nan = Call::make(type, "nan_f32", {}, Call::PureExtern);
+    Expr is_nan = (Call::make(Bool(type.lanes()), "is_nan_f32", {x}, Call::PureExtern) ||
+                   Call::make(Bool(type.lanes()), "is_nan_f32", {y}, Call::PureExtern));
+    result = select(is_nan, nan, result);
+    return common_subexpression_elimination(result);
+}
+
+Expr halide_tanh(Expr x_full) {
+    Type type = x_full.type();
+    internal_assert(type.element_of() == Float(32));
+
+    // For small x, use an odd polynomial.
+    float coeff[] = {
+        -5.70498872745e-3f,
+        2.06390887954e-2f,
+        -5.37397155531e-2f,
+        1.33314422036e-1f,
+        -3.33332819422e-1f};
+    Expr x2 = x_full * x_full;
+    Expr small = evaluate_polynomial(x2, coeff, sizeof(coeff)/sizeof(coeff[0])) * x2 * x_full + x_full;
+
+    // Otherwise use tanh(x) = 1 - 2/(exp(2x) + 1). tanh(x) rounds to
+    // 1 for x > 9, so clamp x to keep exp well away from overflow.
+    Expr abs_x = abs(x_full);
+    Expr large = 1.0f - 2.0f / (halide_exp(min(abs_x, 10.0f) * 2.0f) + 1.0f);
+    large = select(x_full < 0.0f, -large, large);
+
+    Expr result = select(abs_x < 0.625f, small, large);
+
+    // The clamp above would turn a nan into +/-1.
+    Expr is_nan = Call::make(Bool(type.lanes()), "is_nan_f32", {x_full}, Call::PureExtern);
+    result = select(is_nan, x_full, result);
+    return common_subexpression_elimination(result);
+}
+
 Expr halide_erf(Expr x_full) {
     user_assert(x_full.type() == Float(32)) << "halide_erf only works for Float(32)";
 
@@ -165,6 +165,12 @@ void match_types(Expr &a, Expr &b);
 // @{
 Expr halide_log(Expr a);
 Expr halide_exp(Expr a);
+Expr halide_sin(Expr a);
+Expr halide_cos(Expr a);
+Expr halide_tan(Expr a);
+Expr halide_atan(Expr a);
+Expr halide_atan2(Expr y, Expr x);
+Expr halide_tanh(Expr a);
 Expr halide_erf(Expr a);
 // @}
 
@@ -966,8 +972,10 @@ inline Tuple tuple_select(const Expr &c0, const Tuple &v0, const Expr &c1, const
 // No backend supports these yet.
 
 /** Return the sine of a floating-point expression. If the argument is
- * not floating-point, it is cast to Float(32). Does not vectorize
- * well. */
+ * not floating-point, it is cast to Float(32). Vectorized Float(32)
+ * sines use a polynomial approximation, accurate to within 3 ulp away
+ * from the roots, unless strict_float is in effect. Vectors with any
+ * lane larger than 8192 in magnitude fall back to libm. */
 inline Expr sin(Expr x) {
     user_assert(x.defined()) << "sin of undefined Expr\n";
     if (x.type() == Float(64)) {
@@ -994,8 +1002,11 @@ inline Expr asin(Expr x) {
 }
 
 /** Return the cosine of a floating-point expression. If the argument
- * is not floating-point, it is cast to Float(32). Does not vectorize
- * well. */
+ * is not floating-point, it is cast to Float(32). Vectorized
+ * Float(32) cosines use a polynomial approximation, accurate to
+ * within 3 ulp away from the roots, unless strict_float is in
+ * effect. Vectors with any lane larger than 8192 in magnitude fall
+ * back to libm. */
 inline Expr cos(Expr x) {
     user_assert(x.defined()) << "cos of undefined Expr\n";
     if (x.type() == Float(64)) {
@@ -1022,8 +1033,11 @@ inline Expr acos(Expr x) {
 }
 
 /** Return the tangent of a floating-point expression. If the argument
- * is not floating-point, it is cast to Float(32). Does not vectorize
- * well. */
+ * is not floating-point, it is cast to Float(32). Vectorized
+ * Float(32) tangents use a polynomial approximation, accurate to
+ * within a few ulp away from the roots and poles, unless
+ * strict_float is in effect. Vectors with any lane larger than 8192
+ * in magnitude fall back to libm. */
 inline Expr tan(Expr x) {
     user_assert(x.defined()) << "tan of undefined Expr\n";
     if (x.type() == Float(64)) {
@@ -1036,8 +1050,9 @@ inline Expr tan(Expr x) {
 }
 
 /** Return the arctangent of a floating-point expression. If the
- * argument is not floating-point, it is cast to Float(32). Does not
- * vectorize well. */
+ * argument is not floating-point, it is cast to Float(32). Vectorized
+ * Float(32) arctangents use a polynomial approximation, accurate to
+ * within 4 ulp, unless strict_float is in effect. */
 inline Expr atan(Expr x) {
     user_assert(x.defined()) << "atan of undefined Expr\n";
     if (x.type() == Float(64)) {
@@ -1050,8 +1065,11 @@ inline Expr atan(Expr x) {
 }
 
 /** Return the angle of a floating-point gradient. If the argument is
- * not floating-point, it is cast to Float(32). Does not vectorize
- * well. */
+ * not floating-point, it is cast to Float(32). Vectorized Float(32)
+ * angles use a polynomial approximation, accurate to within 4 ulp,
+ * unless strict_float is in effect. The approximation does not
+ * distinguish signed zeros, and returns nan when both arguments are
+ * infinite. */
 inline Expr atan2(Expr y, Expr x) {
     user_assert(x.defined() && y.defined()) << "atan2 of undefined Expr\n";
 
@@ -1125,8 +1143,10 @@ inline Expr acosh(Expr x) {
 }
 
 /** Return the hyperbolic tangent of a floating-point expression.  If
- * the argument is not floating-point, it is cast to Float(32). Does
- * not vectorize well. */
+ * the argument is not floating-point, it is cast to Float(32).
+ * Vectorized Float(32) hyperbolic tangents use a polynomial
+ * approximation, accurate to within a few ulp, unless strict_float is
+ * in effect. */
 inline Expr tanh(Expr x) {
     user_assert(x.defined()) << "tanh of undefined Expr\n";
     if (x.type() == Float(64)) {
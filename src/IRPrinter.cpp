@@ -307,6 +307,30 @@ std::ostream &operator<<(std::ostream &stream, const LinkageType &type) {
     return stream;
 }
 
+std::ostream &operator<<(std::ostream &stream, const VectorReduce::Operator &op) {
+    switch (op) {
+    case VectorReduce::Add:
+        stream << "Add";
+        break;
+    case VectorReduce::Mul:
+        stream << "Mul";
+        break;
+    case VectorReduce::Min:
+        stream << "Min";
+        break;
+    case VectorReduce::Max:
+        stream << "Max";
+        break;
+    case VectorReduce::And:
+        stream << "And";
+        break;
+    case VectorReduce::Or:
+        stream << "Or";
+        break;
+    }
+    return stream;
+}
+
 IRPrinter::IRPrinter(ostream &s) : stream(s), indent(0) {
     s.setf(std::ios::fixed, std::ios::floatfield);
 }
@@ -875,5 +899,15 @@ void IRPrinter::visit(const Shuffle *op) {
     }
 }
 
+void IRPrinter::visit(const VectorReduce *op) {
+    stream << "("
+           << op->type
+           << ")vector_reduce("
+           << op->op
+           << ", "
+           << op->value
+           << ")";
+}
+
 }  // namespace Internal
 }  // namespace Halide
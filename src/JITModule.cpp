@@ -470,6 +470,8 @@ JITHandlers default_handlers;
 JITHandlers active_handlers;
 int64_t default_cache_size;
 
+}  // namespace
+
 void merge_handlers(JITHandlers &base, const JITHandlers &addins) {
     if (addins.custom_print) {
         base.custom_print = addins.custom_print;
@@ -503,6 +505,8 @@ void merge_handlers(JITHandlers &base, const JITHandlers &addins) {
     }
 }
 
+namespace {
+
 void print_handler(void *context, const char *msg) {
     if (context) {
         JITUserContext *jit_user_context = (JITUserContext *)context;
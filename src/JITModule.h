@@ -140,6 +140,9 @@ struct JITUserContext {
     JITHandlers handlers;
 };
 
+/** Replace the handlers in base with any non-null handlers in addins. */
+void merge_handlers(JITHandlers &base, const JITHandlers &addins);
+
 class JITSharedRuntime {
 public:
     // Note only the first llvm::Module passed in here is used. The same shared runtime is used for all JIT.
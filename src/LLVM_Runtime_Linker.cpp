@@ -89,6 +89,7 @@ DECLARE_CPP_INITMOD(device_interface)
 DECLARE_CPP_INITMOD(errors)
 DECLARE_CPP_INITMOD(fake_thread_pool)
 DECLARE_CPP_INITMOD(float16_t)
+DECLARE_CPP_INITMOD(frame_pipeline)
 DECLARE_CPP_INITMOD(gpu_device_selection)
 DECLARE_CPP_INITMOD(hexagon_dma)
 DECLARE_CPP_INITMOD(hexagon_host)
@@ -98,6 +99,7 @@ DECLARE_CPP_INITMOD(linux_host_cpu_count)
 DECLARE_CPP_INITMOD(linux_opengl_context)
 DECLARE_CPP_INITMOD(linux_yield)
 DECLARE_CPP_INITMOD(matlab)
+DECLARE_CPP_INITMOD(memory_budget)
 DECLARE_CPP_INITMOD(metadata)
 DECLARE_CPP_INITMOD(mingw_math)
 DECLARE_CPP_INITMOD(module_aot_ref_count)
@@ -188,9 +190,13 @@ DECLARE_NO_INITMOD(arm_cpu_features)
 #ifdef WITH_AARCH64
 DECLARE_LL_INITMOD(aarch64)
 DECLARE_CPP_INITMOD(aarch64_cpu_features)
+DECLARE_CPP_INITMOD(aarch64_linux_cpu_features)
+DECLARE_CPP_INITMOD(aarch64_osx_cpu_features)
 #else
 DECLARE_NO_INITMOD(aarch64)
 DECLARE_NO_INITMOD(aarch64_cpu_features)
+DECLARE_NO_INITMOD(aarch64_linux_cpu_features)
+DECLARE_NO_INITMOD(aarch64_osx_cpu_features)
 #endif  // WITH_AARCH64
 
 #ifdef WITH_PTX
@@ -811,6 +817,13 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             // intermingle code that is built with this flag with code that is
             // built without.
             modules.push_back(get_initmod_old_buffer_t(c, bits_64, debug));
+            modules.push_back(get_initmod_frame_pipeline(c, bits_64, debug));
+
+            // The default thread count for the memory budget needs
+            // halide_host_cpu_count.
+            if (t.os != Target::NoOS) {
+                modules.push_back(get_initmod_memory_budget(c, bits_64, debug));
+            }
 
             // MIPS doesn't support the atomics the profiler requires.
             if (t.arch != Target::MIPS && t.os != Target::NoOS &&
@@ -888,7 +901,15 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             }
             if (t.arch == Target::ARM) {
                 if (t.bits == 64) {
-                    modules.push_back(get_initmod_aarch64_cpu_features(c, bits_64, debug));
+                    // Detecting the ARMv8.2 extensions needs help
+                    // from the OS.
+                    if (t.os == Target::Linux || t.os == Target::Android) {
+                        modules.push_back(get_initmod_aarch64_linux_cpu_features(c, bits_64, debug));
+                    } else if (t.os == Target::OSX || t.os == Target::IOS) {
+                        modules.push_back(get_initmod_aarch64_osx_cpu_features(c, bits_64, debug));
+                    } else {
+                        modules.push_back(get_initmod_aarch64_cpu_features(c, bits_64, debug));
+                    }
                 } else {
                     modules.push_back(get_initmod_arm_cpu_features(c, bits_64, debug));
                 }
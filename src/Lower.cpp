@@ -8,7 +8,9 @@
 #include "AddImageChecks.h"
 #include "AddParameterChecks.h"
 #include "AllocationBoundsInference.h"
+#include "ArenaAllocations.h"
 #include "AsyncProducers.h"
+#include "AutoFuse.h"
 #include "BoundSmallAllocations.h"
 #include "Bounds.h"
 #include "BoundsInference.h"
@@ -19,6 +21,7 @@
 #include "DebugToFile.h"
 #include "Deinterleave.h"
 #include "EarlyFree.h"
+#include "EmulateFloat16Math.h"
 #include "FindCalls.h"
 #include "Func.h"
 #include "Function.h"
@@ -36,6 +39,8 @@
 #include "LoopCarry.h"
 #include "LowerWarpShuffles.h"
 #include "Memoization.h"
+#include "MemoryFootprint.h"
+#include "MultiversionLoops.h"
 #include "PartitionLoops.h"
 #include "PurifyIndexMath.h"
 #include "Prefetch.h"
@@ -112,6 +117,9 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     // Substitute in wrapper Funcs
     env = wrap_func_calls(env);
 
+    // Fuse the loops of independent siblings that read the same inputs
+    auto_fuse_siblings(env);
+
     // Compute a realization order and determine group of functions which loops
     // are to be fused together
     vector<string> order;
@@ -303,6 +311,12 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     s = inject_early_frees(s);
     debug(2) << "Lowering after injecting early frees:\n" << s << "\n\n";
 
+    if (t.has_feature(Target::ArenaAllocations)) {
+        debug(1) << "Packing allocations into arenas...\n";
+        s = pack_allocations_into_arenas(s, t);
+        debug(2) << "Lowering after packing allocations into arenas:\n" << s << "\n\n";
+    }
+
     if (t.has_feature(Target::Profile)) {
         debug(1) << "Injecting profiling...\n";
         s = inject_profiling(s, pipeline_name);
@@ -325,6 +339,10 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
         debug(2) << "Lowering after injecting warp shuffles:\n" << s << "\n\n";
     }
 
+    debug(1) << "Emulating Float(16) math...\n";
+    s = emulate_float16_math(s, t, any_strict_float);
+    debug(2) << "Lowering after emulating Float(16) math:\n" << s << "\n\n";
+
     debug(1) << "Simplifying...\n";
     s = common_subexpression_elimination(s);
 
@@ -348,6 +366,9 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     s = loop_invariant_code_motion(s);
     debug(1) << "Lowering after final simplification:\n" << s << "\n\n";
 
+    debug(1) << "Checking memory footprint...\n";
+    s = check_memory_footprint(s, outputs, pipeline_name, t);
+
     if (t.arch != Target::Hexagon && (t.features_any_of({Target::HVX_64, Target::HVX_128}))) {
         debug(1) << "Splitting off Hexagon offload...\n";
         s = inject_hexagon_rpc(s, t, result_module);
@@ -364,6 +385,14 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
         }
     }
 
+    // This duplicates loop nests, so do it after any custom passes,
+    // which may want to inspect the loops and accesses.
+    if (t.has_feature(Target::MultiversionLoops)) {
+        debug(1) << "Multiversioning loops on alignment and stride...\n";
+        s = multiversion_loops(s, t);
+        debug(2) << "Lowering after multiversioning loops:\n" << s << "\n\n";
+    }
+
     vector<Argument> public_args = args;
     for (const auto &out : outputs) {
         for (Parameter buf : out.output_buffers()) {
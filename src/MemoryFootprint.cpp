@@ -0,0 +1,559 @@
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+#include "Bounds.h"
+#include "CodeGen_Internal.h"
+#include "ExprUsesVar.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "MemoryFootprint.h"
+#include "Simplify.h"
+#include "Substitute.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+// The free variable standing for the number of threads in the
+// symbolic footprint.
+const char *const threads_name = "halide_num_threads";
+
+// Sums and maxima of byte counts, where an undefined Expr means
+// unbounded.
+Expr add_bytes(const Expr &a, const Expr &b) {
+    if (!a.defined() || !b.defined()) {
+        return Expr();
+    }
+    return simplify(a + b);
+}
+
+Expr max_bytes(const Expr &a, const Expr &b) {
+    if (!a.defined() || !b.defined()) {
+        return Expr();
+    }
+    return simplify(max(a, b));
+}
+
+MemoryUsage add_usage(const MemoryUsage &a, const MemoryUsage &b) {
+    return {add_bytes(a.heap, b.heap), add_bytes(a.stack, b.stack)};
+}
+
+MemoryUsage max_usage(const MemoryUsage &a, const MemoryUsage &b) {
+    return {max_bytes(a.heap, b.heap), max_bytes(a.stack, b.stack)};
+}
+
+MemoryUsage no_usage() {
+    return {make_zero(Int(64)), make_zero(Int(64))};
+}
+
+// Can the value of a LetStmt be substituted into an expression that
+// is evaluated elsewhere? Loads and impure calls might depend on
+// side-effects of the code in between. The buffer field queries are
+// pure, but we'd rather leave the results in terms of the buffer
+// fields, so that estimates can be substituted for them.
+class CanSubstitute : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) override {
+        result = false;
+    }
+
+    void visit(const Call *op) override {
+        if (!op->is_pure() || starts_with(op->name, "_halide_buffer_get_")) {
+            result = false;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = true;
+};
+
+bool can_substitute(const Expr &e) {
+    CanSubstitute c;
+    e.accept(&c);
+    return c.result;
+}
+
+class ComputeFootprint : public IRVisitor {
+    using IRVisitor::visit;
+
+    // The memory live at the current point in the program, and the
+    // most live so far, relative to the start of the innermost loop
+    // body or branch.
+    MemoryUsage current = no_usage(), peak = no_usage();
+
+    // The size of each live allocation, and whether it is on the heap.
+    map<string, std::pair<Expr, bool>> live;
+
+    // Are we still in the outermost chain of LetStmts?
+    bool in_prefix = true;
+
+    Expr threads = Variable::make(Int(32), threads_name);
+
+    // Rewrite the expressions computed inside some scope so that they
+    // no longer refer to a variable defined by it.
+    template<typename F>
+    void leave_scope(F f, MemoryUsage &usage) {
+        usage.heap = usage.heap.defined() ? f(usage.heap) : usage.heap;
+        usage.stack = usage.stack.defined() ? f(usage.stack) : usage.stack;
+    }
+
+    template<typename F>
+    void leave_scope(F f, size_t first_loop) {
+        leave_scope(f, current);
+        leave_scope(f, peak);
+        for (size_t i = first_loop; i < loops.size(); i++) {
+            leave_scope(f, loops[i].usage);
+        }
+    }
+
+    // Measure the peak usage of a statement in isolation.
+    MemoryUsage measure(const Stmt &s) {
+        MemoryUsage old_current = current, old_peak = peak;
+        bool old_prefix = in_prefix;
+        current = peak = no_usage();
+        in_prefix = false;
+        s.accept(this);
+        MemoryUsage result = peak;
+        current = old_current;
+        peak = old_peak;
+        in_prefix = old_prefix;
+        return result;
+    }
+
+    // Add the peak usage of a nested statement to what's live now.
+    void nested_peak(const MemoryUsage &usage) {
+        peak = max_usage(peak, add_usage(current, usage));
+    }
+
+    void visit(const LetStmt *op) override {
+        size_t first_loop = loops.size();
+        bool prefix = in_prefix;
+        op->body.accept(this);
+        const string &name = op->name;
+        if (can_substitute(op->value)) {
+            leave_scope([&](const Expr &e) {
+                return expr_uses_var(e, name) ? simplify(Let::make(name, op->value, e)) : e;
+            }, first_loop);
+        } else if (!prefix) {
+            // Take the worst case over all the values the variable
+            // could have.
+            Scope<Interval> scope;
+            scope.push(name, bounds_of_expr_in_scope(op->value, Scope<Interval>()));
+            leave_scope([&](const Expr &e) {
+                if (!expr_uses_var(e, name)) {
+                    return e;
+                }
+                Interval i = bounds_of_expr_in_scope(e, scope);
+                return i.has_upper_bound() ? simplify(i.max) : Expr();
+            }, first_loop);
+        }
+    }
+
+    void visit(const Allocate *op) override {
+        bool counted = false, on_heap = false;
+        Expr size;
+        if (!op->new_expr.defined()) {
+            int64_t elem_bytes = op->type.bytes() * op->type.lanes();
+            int64_t constant_size = op->constant_allocation_size();
+            if (op->memory_type == MemoryType::Stack ||
+                (op->memory_type == MemoryType::Auto && constant_size > 0 &&
+                 can_allocation_fit_on_stack(constant_size * elem_bytes))) {
+                counted = true;
+            } else if (op->memory_type == MemoryType::Heap ||
+                       op->memory_type == MemoryType::Auto) {
+                counted = on_heap = true;
+            }
+            if (counted) {
+                size = make_const(Int(64), elem_bytes);
+                for (const Expr &e : op->extents) {
+                    size *= cast(Int(64), e);
+                }
+                if (on_heap) {
+                    // Codegen pads heap allocations by one element.
+                    size += make_const(Int(64), elem_bytes);
+                }
+                if (!is_one(op->condition)) {
+                    size = select(op->condition, size, make_zero(Int(64)));
+                }
+                size = simplify(size);
+            }
+        }
+
+        if (counted) {
+            Expr &cur = on_heap ? current.heap : current.stack;
+            Expr &top = on_heap ? peak.heap : peak.stack;
+            cur = add_bytes(cur, size);
+            top = max_bytes(top, cur);
+            live[op->name] = {size, on_heap};
+        }
+
+        in_prefix = false;
+        op->body.accept(this);
+
+        // If nothing freed it, it's live until the end of its body.
+        auto it = live.find(op->name);
+        if (it != live.end()) {
+            Expr &cur = it->second.second ? current.heap : current.stack;
+            cur = cur.defined() ? simplify(cur - it->second.first) : cur;
+            live.erase(it);
+        }
+    }
+
+    void visit(const Free *op) override {
+        auto it = live.find(op->name);
+        if (it != live.end()) {
+            Expr &cur = it->second.second ? current.heap : current.stack;
+            cur = cur.defined() ? simplify(cur - it->second.first) : cur;
+            live.erase(it);
+        }
+    }
+
+    void visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Memory allocated inside device code doesn't come out of
+            // the host's budget.
+            return;
+        }
+
+        size_t first_loop = loops.size();
+        loops.push_back({op->name, no_usage()});
+        MemoryUsage body = measure(op->body);
+
+        // Take the worst case over all iterations.
+        Scope<Interval> scope;
+        scope.push(op->name, Interval(op->min, simplify(op->min + op->extent - 1)));
+        auto bound = [&](const Expr &e) {
+            if (!expr_uses_var(e, op->name)) {
+                return e;
+            }
+            Interval i = bounds_of_expr_in_scope(e, scope);
+            return i.has_upper_bound() ? simplify(i.max) : Expr();
+        };
+        leave_scope(bound, body);
+        for (size_t i = first_loop + 1; i < loops.size(); i++) {
+            leave_scope(bound, loops[i].usage);
+        }
+
+        if (op->for_type == ForType::Parallel) {
+            Expr copies = cast(Int(64), min(op->extent, threads));
+            leave_scope([&](const Expr &e) {
+                return is_zero(e) ? e : simplify(e * copies);
+            }, body);
+        }
+
+        loops[first_loop].usage = body;
+        nested_peak(body);
+    }
+
+    void visit(const IfThenElse *op) override {
+        MemoryUsage then_usage = measure(op->then_case);
+        MemoryUsage else_usage = no_usage();
+        if (op->else_case.defined()) {
+            else_usage = measure(op->else_case);
+        }
+        auto choose = [&](const Expr &a, const Expr &b) {
+            if (!a.defined() || !b.defined()) {
+                return Expr();
+            }
+            return equal(a, b) ? a : simplify(select(op->condition, a, b));
+        };
+        nested_peak({choose(then_usage.heap, else_usage.heap),
+                     choose(then_usage.stack, else_usage.stack)});
+    }
+
+    void visit(const Fork *op) override {
+        // Both sides run at once.
+        nested_peak(add_usage(measure(op->first), measure(op->rest)));
+    }
+
+    void visit(const Block *op) override {
+        in_prefix = false;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const ProducerConsumer *op) override {
+        in_prefix = false;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Acquire *op) override {
+        in_prefix = false;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Realize *op) override {
+        internal_error << "compute_memory_footprint must run after storage flattening\n";
+    }
+
+public:
+    vector<LoopMemoryFootprint> loops;
+
+    MemoryUsage result() const {
+        return peak;
+    }
+};
+
+// Find the buffer and scalar parameters a Stmt refers to.
+class FindParameters : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) override {
+        if (op->param.defined()) {
+            params[op->param.name()] = op->param;
+        } else if (op->image.defined()) {
+            images[op->image.name()] = op->image;
+        }
+    }
+
+public:
+    map<string, Parameter> params;
+    map<string, Buffer<>> images;
+};
+
+void add_buffer_estimates(const Parameter &p, map<string, Expr> &estimates) {
+    for (int i = 0; i < p.dimensions(); i++) {
+        string dim = std::to_string(i);
+        Expr min = p.min_constraint_estimate(i);
+        Expr extent = p.extent_constraint_estimate(i);
+        if (min.defined()) {
+            estimates[p.name() + ".min." + dim] = min;
+        }
+        if (extent.defined()) {
+            estimates[p.name() + ".extent." + dim] = extent;
+        }
+    }
+}
+
+// Is there anything that could allocate before the remainder of a
+// Stmt?
+class HasAllocationOrLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Allocate *op) override {
+        result = true;
+    }
+
+    void visit(const For *op) override {
+        result = true;
+    }
+
+public:
+    bool result = false;
+};
+
+bool has_allocation_or_loop(const Stmt &s) {
+    HasAllocationOrLoop h;
+    s.accept(&h);
+    return h.result;
+}
+
+// Put the budget check after the parameter and bounds query checks,
+// but before the first allocation.
+class InjectBudgetCheck : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Stmt visit(const Block *op) override {
+        if (has_allocation_or_loop(op->first)) {
+            return Block::make(check, op);
+        }
+        return Block::make(op->first, mutate(op->rest));
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        if (op->else_case.defined()) {
+            return Block::make(check, op);
+        }
+        return IfThenElse::make(op->condition, mutate(op->then_case));
+    }
+
+public:
+    Stmt check;
+
+    using IRMutator2::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        if (s.as<LetStmt>() || s.as<Block>() || s.as<IfThenElse>()) {
+            return IRMutator2::mutate(s);
+        }
+        return Block::make(check, s);
+    }
+};
+
+int default_num_threads() {
+    string threads = get_env_variable("HL_NUM_THREADS");
+    if (!threads.empty()) {
+        return std::max(1, std::atoi(threads.c_str()));
+    }
+    return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+}  // namespace
+
+MemoryFootprint compute_memory_footprint(const Stmt &s) {
+    ComputeFootprint c;
+    s.accept(&c);
+    return {c.result(), c.loops};
+}
+
+MemoryFootprint estimate_memory_footprint(const MemoryFootprint &footprint, const Stmt &s,
+                                          const vector<Function> &outputs, int threads) {
+    map<string, Expr> estimates;
+    FindParameters finder;
+    s.accept(&finder);
+    for (const auto &it : finder.params) {
+        const Parameter &p = it.second;
+        if (p.is_buffer()) {
+            add_buffer_estimates(p, estimates);
+        } else if (p.estimate().defined()) {
+            estimates[p.name()] = p.estimate();
+        }
+    }
+    for (const auto &it : finder.images) {
+        const Buffer<> &b = it.second;
+        for (int i = 0; i < b.dimensions(); i++) {
+            string dim = std::to_string(i);
+            estimates[b.name() + ".min." + dim] = b.dim(i).min();
+            estimates[b.name() + ".extent." + dim] = b.dim(i).extent();
+        }
+    }
+    for (const Function &f : outputs) {
+        for (const Parameter &p : f.output_buffers()) {
+            add_buffer_estimates(p, estimates);
+            for (const Bound &b : f.schedule().estimates()) {
+                const vector<string> &args = f.args();
+                auto arg = std::find(args.begin(), args.end(), b.var);
+                if (arg == args.end()) {
+                    continue;
+                }
+                string dim = std::to_string(arg - args.begin());
+                estimates[p.name() + ".min." + dim] = b.min;
+                estimates[p.name() + ".extent." + dim] = b.extent;
+            }
+        }
+    }
+
+    auto estimate = [&](const Expr &e) {
+        if (!e.defined()) {
+            return e;
+        }
+        Expr result = substitute(estimates, e);
+        // The estimates may refer to each other.
+        result = substitute(estimates, result);
+        return simplify(result);
+    };
+    Expr threads_var = Variable::make(Int(32), threads_name);
+    auto estimate_usage = [&](const MemoryUsage &u) {
+        MemoryUsage result = {estimate(u.heap), estimate(u.stack)};
+        if (result.heap.defined()) {
+            result.heap = simplify(substitute(threads_var, threads, result.heap));
+        }
+        if (result.stack.defined()) {
+            result.stack = simplify(substitute(threads_var, threads, result.stack));
+        }
+        return result;
+    };
+
+    MemoryFootprint result;
+    result.peak = estimate_usage(footprint.peak);
+    for (const LoopMemoryFootprint &l : footprint.loops) {
+        result.loops.push_back({l.loop, estimate_usage(l.usage)});
+    }
+    return result;
+}
+
+std::ostream &operator<<(std::ostream &stream, const MemoryFootprint &footprint) {
+    auto print = [&](const MemoryUsage &u) {
+        stream << "heap: ";
+        if (u.heap.defined()) {
+            stream << u.heap;
+        } else {
+            stream << "unbounded";
+        }
+        stream << ", stack: ";
+        if (u.stack.defined()) {
+            stream << u.stack;
+        } else {
+            stream << "unbounded";
+        }
+        stream << "\n";
+    };
+    stream << "peak ";
+    print(footprint.peak);
+    for (const LoopMemoryFootprint &l : footprint.loops) {
+        if (is_zero(l.usage.heap) && is_zero(l.usage.stack)) {
+            continue;
+        }
+        stream << "  loop " << l.loop << " ";
+        print(l.usage);
+    }
+    return stream;
+}
+
+Stmt check_memory_footprint(Stmt s, const vector<Function> &outputs,
+                            const string &pipeline_name, const Target &t) {
+    bool check = t.has_feature(Target::MemoryBudget);
+    if (!check && debug::debug_level() < 1) {
+        return s;
+    }
+
+    Expr threads_var = Variable::make(Int(32), threads_name);
+    MemoryFootprint footprint = compute_memory_footprint(s);
+    int threads = default_num_threads();
+    debug(1) << "Memory footprint of " << pipeline_name << ":\n"
+             << footprint
+             << "Estimated memory footprint of " << pipeline_name
+             << " with " << threads << " threads:\n"
+             << estimate_memory_footprint(footprint, s, outputs, threads);
+
+    if (!check) {
+        return s;
+    }
+    if (t.os == Target::NoOS ||
+        t.arch == Target::Hexagon ||
+        t.features_any_of({Target::HVX_64, Target::HVX_128})) {
+        user_warning << "Memory budgets are not supported for target " << t.to_string()
+                     << ", so " << pipeline_name << " will not check its memory use.\n";
+        return s;
+    }
+    if (!footprint.peak.heap.defined() || !footprint.peak.stack.defined()) {
+        user_warning << "Could not bound the memory use of " << pipeline_name
+                     << ", so it will not be checked against the memory budget.\n";
+        return s;
+    }
+
+    Expr runtime_threads = Call::make(Int(32), "halide_get_memory_budget_threads", {}, Call::Extern);
+    Expr required = footprint.peak.heap + footprint.peak.stack;
+    required = substitute(threads_var, runtime_threads, required);
+    required = simplify(cast(UInt(64), max(required, make_zero(Int(64)))));
+
+    string required_name = pipeline_name + ".memory_required";
+    string budget_name = pipeline_name + ".memory_budget";
+    Expr required_var = Variable::make(UInt(64), required_name);
+    Expr budget_var = Variable::make(UInt(64), budget_name);
+    Expr budget = Call::make(UInt(64), "halide_get_memory_budget", {}, Call::Extern);
+    Expr error = Call::make(Int(32), "halide_error_memory_budget_exceeded",
+                            {pipeline_name, required_var, budget_var}, Call::Extern);
+    // A budget of zero means no limit.
+    Stmt assertion = AssertStmt::make(budget_var == 0 || required_var <= budget_var, error);
+    assertion = LetStmt::make(required_name, required, assertion);
+    assertion = LetStmt::make(budget_name, budget, assertion);
+
+    InjectBudgetCheck injector;
+    injector.check = assertion;
+    return injector.mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,74 @@
+#ifndef HALIDE_MEMORY_FOOTPRINT_H
+#define HALIDE_MEMORY_FOOTPRINT_H
+
+/** \file
+ * Defines an analysis of the peak memory use of a lowered pipeline,
+ * and the lowering pass that checks it against a memory budget.
+ */
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Function.h"
+#include "IR.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** A number of bytes of heap and stack memory, as Int(64)
+ * expressions. An undefined expression means the number of bytes
+ * could not be bounded. */
+struct MemoryUsage {
+    Expr heap, stack;
+};
+
+/** The memory that one loop adds to what is live when it begins,
+ * including all the iterations of the loop that run at once. */
+struct LoopMemoryFootprint {
+    std::string loop;
+    MemoryUsage usage;
+};
+
+/** The peak memory use of a lowered Stmt, and of each loop in it in
+ * program order. */
+struct MemoryFootprint {
+    MemoryUsage peak;
+    std::vector<LoopMemoryFootprint> loops;
+};
+
+/** Compute the peak number of bytes allocated at once by a lowered
+ * Stmt (after storage flattening and inject_early_frees). Allocations
+ * with a custom new_expr, register allocations, and allocations inside
+ * device loops are not counted. The results are in terms of the
+ * variables defined by the outermost chain of LetStmts (e.g. the
+ * buffer mins and extents); other variables are bounded away. Each
+ * parallel loop is assumed to run min(extent, halide_num_threads)
+ * iterations at once, where halide_num_threads is a free Int(32)
+ * variable. */
+MemoryFootprint compute_memory_footprint(const Stmt &s);
+
+/** Substitute the estimates given for the output Funcs, the input
+ * buffers, and the scalar Params used by a lowered Stmt into its
+ * memory footprint, along with the given thread count for
+ * halide_num_threads, and simplify. The result is constant if there
+ * were estimates for everything it depends on. */
+MemoryFootprint estimate_memory_footprint(const MemoryFootprint &footprint, const Stmt &s,
+                                          const std::vector<Function> &outputs, int threads);
+
+std::ostream &operator<<(std::ostream &stream, const MemoryFootprint &footprint);
+
+/** Report the memory footprint of a lowered pipeline at debug level
+ * 1. If the target has the MemoryBudget feature, also inject an
+ * assertion on entry to the pipeline that its peak memory use (heap
+ * and stack) is within the budget returned by
+ * halide_get_memory_budget. */
+Stmt check_memory_footprint(Stmt s, const std::vector<Function> &outputs,
+                            const std::string &pipeline_name, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
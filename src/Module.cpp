@@ -1,5 +1,6 @@
 #include "Module.h"
 
+#include <algorithm>
 #include <array>
 #include <fstream>
 #include <future>
@@ -8,7 +9,10 @@
 #include "CodeGen_Internal.h"
 #include "Debug.h"
 #include "HexagonOffload.h"
+#include "IREquality.h"
+#include "IRMutator.h"
 #include "IROperator.h"
+#include "IRVisitor.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Output.h"
 #include "LLVM_Runtime_Linker.h"
@@ -464,6 +468,241 @@ void compile_standalone_runtime(const std::string &object_filename, Target t) {
     compile_standalone_runtime(Outputs().object(object_filename), t);
 }
 
+namespace {
+
+// Renames any function, call, or string that starts with one function
+// name to start with another instead, so that lowered code for
+// different sub-targets can be compared.
+class RenameFunction : public IRMutator2 {
+    using IRMutator2::visit;
+
+    const std::string &from, &to;
+
+    Expr visit(const Call *op) override {
+        Expr e = IRMutator2::visit(op);
+        op = e.as<Call>();
+        if (starts_with(op->name, from)) {
+            return Call::make(op->type, rename(op->name), op->args, op->call_type,
+                              op->func, op->value_index, op->image, op->param);
+        }
+        return e;
+    }
+
+    Expr visit(const StringImm *op) override {
+        if (starts_with(op->value, from)) {
+            return StringImm::make(rename(op->value));
+        }
+        return op;
+    }
+
+public:
+    RenameFunction(const std::string &from, const std::string &to) : from(from), to(to) {}
+
+    std::string rename(const std::string &name) const {
+        return starts_with(name, from) ? to + name.substr(from.size()) : name;
+    }
+};
+
+// Check whether two modules lowered for different targets contain the
+// same code, apart from the names of the functions in them.
+bool same_lowered_code(const Module &a, const std::string &a_name,
+                       const Module &b, const std::string &b_name) {
+    if (!a.submodules().empty() || !b.submodules().empty() ||
+        !a.external_code().empty() || !b.external_code().empty() ||
+        a.functions().size() != b.functions().size() ||
+        a.buffers().size() != b.buffers().size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.buffers().size(); i++) {
+        if (a.buffers()[i].get() != b.buffers()[i].get()) {
+            return false;
+        }
+    }
+    RenameFunction rename(b_name, a_name);
+    for (size_t i = 0; i < a.functions().size(); i++) {
+        const LoweredFunc &fa = a.functions()[i], &fb = b.functions()[i];
+        if (fa.name != rename.rename(fb.name) ||
+            fa.linkage != fb.linkage ||
+            fa.name_mangling != fb.name_mangling ||
+            fa.args.size() != fb.args.size() ||
+            !std::equal(fa.args.begin(), fa.args.end(), fb.args.begin()) ||
+            fa.body.defined() != fb.body.defined() ||
+            (fa.body.defined() && !equal(fa.body, rename.mutate(fb.body)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// One variant of a multitarget library.
+struct SubTarget {
+    std::string suffix, fn_name;
+    Module module;
+
+    // The assembly generated for the module, with fn_name replaced by
+    // a placeholder so that the code generated for different variants
+    // can be compared. Made on first use.
+    std::string assembly;
+    bool has_assembly = false;
+
+    SubTarget(const std::string &suffix, const std::string &fn_name, const Module &module)
+        : suffix(suffix), fn_name(fn_name), module(module) {}
+
+    const std::string &generated_assembly() {
+        if (!has_assembly) {
+            llvm::LLVMContext context;
+            std::unique_ptr<llvm::Module> llvm_module(compile_module_to_llvm_module(module, context));
+            llvm::SmallVector<char, 4096> buffer;
+            llvm::raw_svector_ostream out(buffer);
+            compile_llvm_module_to_assembly(*llvm_module, out);
+            assembly = replace_all(std::string(buffer.begin(), buffer.end()), fn_name, "<fn>");
+            has_assembly = true;
+        }
+        return assembly;
+    }
+};
+
+// Check whether two variants would produce the same machine
+// code. Instruction selection for the target's ISA happens after
+// lowering, so identical lowered code is necessary but not sufficient.
+bool same_generated_code(SubTarget &a, SubTarget &b) {
+    return (same_lowered_code(a.module, a.fn_name, b.module, b.fn_name) &&
+            a.generated_assembly() == b.generated_assembly());
+}
+
+// Only the wrapper of a multitarget library is called from outside
+// it, and the wrapper has its own argv and metadata entry points and
+// legacy buffer_t wrapper. Drop these from a variant, leaving a plain
+// entry point.
+void remove_variant_glue(Module &m, const std::string &fn_name) {
+    std::vector<LoweredFunc> &functions = m.functions();
+    bool seen_entry_point = false;
+    for (auto it = functions.begin(); it != functions.end();) {
+        if (it->name == fn_name && !seen_entry_point) {
+            seen_entry_point = true;
+        } else if (it->name == fn_name || it->name == fn_name + "_old_buffer_t") {
+            it = functions.erase(it);
+            continue;
+        }
+        if (it->linkage == LinkageType::ExternalPlusMetadata) {
+            it->linkage = LinkageType::External;
+        }
+        it++;
+    }
+}
+
+// Check whether a function can be compiled once for the baseline
+// target and called by every variant: it has no vector code, whose
+// instruction selection depends on the ISA, and it doesn't call other
+// functions in the module, which may differ between variants.
+class CanShareFunction : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    const std::vector<LoweredFunc> &functions;
+
+    void visit(const Call *op) override {
+        for (const LoweredFunc &f : functions) {
+            if (f.name == op->name) {
+                result = false;
+            }
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    CanShareFunction(const std::vector<LoweredFunc> &functions) : functions(functions) {}
+
+    bool result = true;
+
+    void include(const Expr &e) override {
+        if (e.type().is_vector()) {
+            result = false;
+        } else if (result) {
+            IRGraphVisitor::include(e);
+        }
+    }
+
+    void include(const Stmt &s) override {
+        if (result) {
+            IRGraphVisitor::include(s);
+        }
+    }
+};
+
+// Renames calls to functions in the given map.
+class RenameCalls : public IRMutator2 {
+    using IRMutator2::visit;
+
+    const std::map<std::string, std::string> &names;
+
+    Expr visit(const Call *op) override {
+        Expr e = IRMutator2::visit(op);
+        op = e.as<Call>();
+        auto it = names.find(op->name);
+        if (it != names.end()) {
+            return Call::make(op->type, it->second, op->args, op->call_type,
+                              op->func, op->value_index, op->image, op->param);
+        }
+        return e;
+    }
+
+public:
+    RenameCalls(const std::map<std::string, std::string> &names) : names(names) {}
+};
+
+// Replace the internal functions of a variant that are the same as
+// one in the baseline, and that can be shared, with calls to the
+// baseline's copy, which is made external so that the variant can
+// link to it.
+void share_functions_with_baseline(SubTarget &variant, SubTarget &baseline) {
+    RenameFunction rename(variant.fn_name, baseline.fn_name);
+    std::vector<LoweredFunc> &functions = variant.module.functions();
+    std::map<std::string, std::string> shared;
+    for (const LoweredFunc &f : functions) {
+        if (f.linkage != LinkageType::Internal || !f.body.defined()) {
+            continue;
+        }
+        // Functions made during lowering have the pipeline's name
+        // somewhere in theirs, e.g. the wrappers of extern stages.
+        std::string base_name = replace_all(f.name, variant.fn_name, baseline.fn_name);
+        for (LoweredFunc &g : baseline.module.functions()) {
+            if (g.name != base_name ||
+                g.linkage == LinkageType::ExternalPlusMetadata ||
+                g.name_mangling != f.name_mangling ||
+                g.args.size() != f.args.size() ||
+                !std::equal(g.args.begin(), g.args.end(), f.args.begin()) ||
+                !g.body.defined() ||
+                !equal(g.body, rename.mutate(f.body))) {
+                continue;
+            }
+            CanShareFunction can_share(baseline.module.functions());
+            g.body.accept(&can_share);
+            if (can_share.result) {
+                debug(1) << "compile_multitarget: sharing " << g.name << " with " << variant.fn_name << "\n";
+                g.linkage = LinkageType::External;
+                shared[f.name] = g.name;
+            }
+            break;
+        }
+    }
+    if (shared.empty()) {
+        return;
+    }
+    RenameCalls rename_calls(shared);
+    for (auto it = functions.begin(); it != functions.end();) {
+        if (shared.count(it->name)) {
+            it = functions.erase(it);
+        } else {
+            if (it->body.defined()) {
+                it->body = rename_calls.mutate(it->body);
+            }
+            it++;
+        }
+    }
+}
+
+}  // namespace
+
 void compile_multitarget(const std::string &fn_name,
                          const Outputs &output_files,
                          const std::vector<Target> &targets,
@@ -508,11 +747,16 @@ void compile_multitarget(const std::string &fn_name,
     // array-of-uint64 for calls to halide_can_use_target_features() anyway,
     // so we'll just build and maintain in that form to avoid extra conversion.
     constexpr int kFeaturesWordCount = (Target::FeatureEnd + 63) / (sizeof(uint64_t) * 8);
-    uint64_t runtime_features[kFeaturesWordCount] = {(uint64_t)-1LL};
+    uint64_t runtime_features[kFeaturesWordCount];
+    std::fill(runtime_features, runtime_features + kFeaturesWordCount, (uint64_t)-1LL);
 
     TemporaryObjectFileDir temp_dir;
     std::vector<Expr> wrapper_args;
     std::vector<LoweredArgument> base_target_args;
+
+    // Lower the pipeline for every target first, so that we can find
+    // sub-targets whose code would be identical.
+    std::vector<SubTarget> sub_targets;
     for (const Target &target : targets) {
         // arch-bits-os must be identical across all targets.
         if (target.os != base_target.os ||
@@ -555,16 +799,61 @@ void compile_multitarget(const std::string &fn_name,
             sub_fn_target = sub_fn_target.without_feature(Target::Matlab);
         }
 
-        Module sub_module = module_producer(sub_fn_name, sub_fn_target);
+        sub_targets.emplace_back(suffix, sub_fn_name, module_producer(sub_fn_name, sub_fn_target));
+        remove_variant_glue(sub_targets.back().module, sub_fn_name);
+    }
+
+    std::vector<bool> deduplicated(targets.size(), false);
+    for (size_t i = 0; i < targets.size(); i++) {
+        const Target &target = targets[i];
+        SubTarget &sub_target = sub_targets[i];
+
+        for (int i = 0; i < Target::FeatureEnd; ++i) {
+            if (!target.has_feature((Target::Feature) i)) {
+                runtime_features[i >> 6] &= ~(((uint64_t) 1) << (i & 63));
+            }
+        }
+
         // Re-assign every time -- should be the same across all targets anyway,
         // but base_target is always the last one we encounter.
-        base_target_args = sub_module.get_function_by_name(sub_fn_name).args;
+        base_target_args = sub_target.module.get_function_by_name(sub_target.fn_name).args;
+
+        // If a later target whose features are a subset of this one's
+        // generates the same code, any machine that can use this
+        // target can use that one instead, so don't emit a copy for
+        // this one. This is common when the extra features don't
+        // affect code generation for the pipeline, e.g. GPU features
+        // for a pipeline that runs on the CPU.
+        for (size_t j = i + 1; j < targets.size() && !deduplicated[i]; j++) {
+            bool subset = true;
+            for (int f = 0; f < Target::FeatureEnd; f++) {
+                subset = subset && (!targets[j].has_feature((Target::Feature)f) ||
+                                    target.has_feature((Target::Feature)f));
+            }
+            if (subset && same_generated_code(sub_targets[j], sub_target)) {
+                debug(1) << "compile_multitarget: " << target.to_string()
+                         << " generates the same code as " << targets[j].to_string() << ", skipping it\n";
+                deduplicated[i] = true;
+            }
+        }
+    }
 
-        Outputs sub_out = add_suffixes(output_files, suffix);
-        internal_assert(sub_out.object_name.empty());
-        sub_out.object_name = temp_dir.add_temp_object_file(output_files.static_library_name, suffix, target);
-        debug(1) << "compile_multitarget: compile_sub_target " << sub_out.object_name << "\n";
-        sub_module.compile(sub_out);
+    // Functions without vector code that are the same in every
+    // variant only need to be compiled once. Code for the baseline
+    // target runs on any machine that can use the other targets.
+    SubTarget &base_sub_target = sub_targets.back();
+    for (size_t i = 0; i + 1 < targets.size(); i++) {
+        if (!deduplicated[i]) {
+            share_functions_with_baseline(sub_targets[i], base_sub_target);
+        }
+    }
+
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (deduplicated[i]) {
+            continue;
+        }
+        const Target &target = targets[i];
+        const SubTarget &sub_target = sub_targets[i];
 
         uint64_t cur_target_features[kFeaturesWordCount] = {0};
         for (int i = 0; i < Target::FeatureEnd; ++i) {
@@ -573,6 +862,12 @@ void compile_multitarget(const std::string &fn_name,
             }
         }
 
+        Outputs sub_out = add_suffixes(output_files, sub_target.suffix);
+        internal_assert(sub_out.object_name.empty());
+        sub_out.object_name = temp_dir.add_temp_object_file(output_files.static_library_name, sub_target.suffix, target);
+        debug(1) << "compile_multitarget: compile_sub_target " << sub_out.object_name << "\n";
+        sub_target.module.compile(sub_out);
+
         Expr can_use;
         if (target != base_target) {
             std::vector<Expr> features_struct_args;
@@ -586,12 +881,8 @@ void compile_multitarget(const std::string &fn_name,
             can_use = IntImm::make(Int(32), 1);
         }
 
-        for (int i = 0; i < kFeaturesWordCount; ++i) {
-            runtime_features[i] &= cur_target_features[i];
-        }
-
         wrapper_args.push_back(can_use != 0);
-        wrapper_args.push_back(sub_fn_name);
+        wrapper_args.push_back(sub_target.fn_name);
     }
 
     // If we haven't specified "no runtime", build a runtime with the base target
@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "MultiversionLoops.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "ModulusRemainder.h"
+#include "Scope.h"
+#include "Simplify.h"
+#include "Substitute.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+
+namespace {
+
+bool is_cpu_loop(const For *op) {
+    return op->device_api == DeviceAPI::None || op->device_api == DeviceAPI::Host;
+}
+
+// A vector access of an input or output buffer that we can make
+// aligned by checking its host pointer at runtime.
+bool is_external_vector_access(const Type &t, const Expr &index, const Parameter &param,
+                               int vector_bytes) {
+    const Ramp *ramp = index.as<Ramp>();
+    return (t.is_vector() && ramp &&
+            (is_one(ramp->stride) || ramp->stride.as<Variable>()) &&
+            param.defined() && param.is_buffer() &&
+            param.host_alignment() < vector_bytes);
+}
+
+// Find the integer variables used by a loop nest but defined outside
+// of it, the smallest type touched by an external vector access, and
+// whether the loop nest can be multiversioned at all.
+class FindSymbols : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    const int vector_bytes;
+
+    void visit(const For *op) override {
+        if (!is_cpu_loop(op)) {
+            // We can't rename the buffers used by device code.
+            ok = false;
+        }
+        bound.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Let *op) override {
+        bound.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const LetStmt *op) override {
+        bound.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Variable *op) override {
+        if (op->type == Int(32) && !used.count(op->name)) {
+            used.emplace(op->name, op);
+        }
+    }
+
+    void visit_access(const Type &t, const Expr &index, const Parameter &param) {
+        if (is_external_vector_access(t, index, param, vector_bytes)) {
+            min_bytes = std::min(min_bytes, t.bytes());
+            if (const Variable *v = index.as<Ramp>()->stride.as<Variable>()) {
+                strides.insert(v->name);
+            }
+        }
+    }
+
+    void visit(const Load *op) override {
+        if (!op->image.defined()) {
+            visit_access(op->type, op->index, op->param);
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        visit_access(op->value.type(), op->index, op->param);
+        IRGraphVisitor::visit(op);
+    }
+
+public:
+    FindSymbols(int vector_bytes) : vector_bytes(vector_bytes), min_bytes(vector_bytes) {}
+
+    set<string> bound, strides;
+    map<string, Expr> used;
+    int min_bytes;
+    bool ok = true;
+};
+
+class CollectVariables : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *op) override {
+        names.insert(op->name);
+    }
+
+public:
+    set<string> names;
+};
+
+// Find the external buffers with vector accesses that would be
+// aligned if the host pointer was aligned and all the symbols were
+// multiples of the vector width, and the symbols those accesses
+// depend on.
+class FindAlignableAccesses : public IRVisitor {
+    using IRVisitor::visit;
+
+    const int vector_bytes;
+    const set<string> &symbols, &strides;
+    Scope<ModulusRemainder> alignment;
+
+    // The symbols each variable defined inside the loop nest depends on.
+    map<string, set<string>> let_symbols;
+
+    set<string> symbols_in(const Expr &e) {
+        CollectVariables vars;
+        e.accept(&vars);
+        set<string> result;
+        for (const string &v : vars.names) {
+            auto it = let_symbols.find(v);
+            if (it != let_symbols.end()) {
+                result.insert(it->second.begin(), it->second.end());
+            } else if (symbols.count(v)) {
+                result.insert(v);
+            }
+        }
+        return result;
+    }
+
+    template<typename LetOrLetStmt>
+    void visit_let(const LetOrLetStmt *op) {
+        op->value.accept(this);
+        let_symbols[op->name] = symbols_in(op->value);
+        if (op->value.type() == Int(32)) {
+            alignment.push(op->name, modulus_remainder(op->value, alignment));
+        }
+        op->body.accept(this);
+        if (op->value.type() == Int(32)) {
+            alignment.pop(op->name);
+        }
+        let_symbols.erase(op->name);
+    }
+
+    void visit(const Let *op) override {
+        visit_let(op);
+    }
+
+    void visit(const LetStmt *op) override {
+        visit_let(op);
+    }
+
+    void visit_access(const string &name, const Type &t, const Expr &index, const Parameter &param) {
+        if (!is_external_vector_access(t, index, param, vector_bytes)) {
+            return;
+        }
+        const Ramp *ramp = index.as<Ramp>();
+        if (const Variable *v = ramp->stride.as<Variable>()) {
+            if (!strides.count(v->name)) {
+                return;
+            }
+            dense_strides.insert(v->name);
+        }
+        const int lanes = vector_bytes / t.bytes();
+        ModulusRemainder mod_rem = modulus_remainder(ramp->base, alignment);
+        if (mod_rem.modulus % lanes == 0 && mod_rem.remainder % lanes == 0) {
+            buffers.emplace(name, param);
+            set<string> s = symbols_in(ramp->base);
+            aligned_symbols.insert(s.begin(), s.end());
+        }
+    }
+
+    void visit(const Load *op) override {
+        if (!op->image.defined()) {
+            visit_access(op->name, op->type, op->index, op->param);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        visit_access(op->name, op->value.type(), op->index, op->param);
+        IRVisitor::visit(op);
+    }
+
+public:
+    FindAlignableAccesses(int vector_bytes, int modulus,
+                          const set<string> &symbols, const set<string> &strides)
+        : vector_bytes(vector_bytes), symbols(symbols), strides(strides) {
+        for (const string &s : symbols) {
+            if (strides.count(s)) {
+                // In the fast path, these are exactly one.
+                alignment.push(s, ModulusRemainder(0, 1));
+            } else {
+                alignment.push(s, ModulusRemainder(modulus, 0));
+            }
+        }
+    }
+
+    map<string, Parameter> buffers;
+    set<string> aligned_symbols, dense_strides;
+};
+
+// Rename the loads and stores of some buffers.
+class RenameBuffers : public IRMutator2 {
+    using IRMutator2::visit;
+
+    const map<string, Parameter> &buffers;
+
+    Expr visit(const Load *op) override {
+        Expr e = IRMutator2::visit(op);
+        if (buffers.count(op->name)) {
+            op = e.as<Load>();
+            return Load::make(op->type, op->name + ".aligned", op->index,
+                              op->image, op->param, op->predicate);
+        }
+        return e;
+    }
+
+    Stmt visit(const Store *op) override {
+        Stmt s = IRMutator2::visit(op);
+        if (buffers.count(op->name)) {
+            op = s.as<Store>();
+            return Store::make(op->name + ".aligned", op->value, op->index,
+                               op->param, op->predicate);
+        }
+        return s;
+    }
+
+public:
+    RenameBuffers(const map<string, Parameter> &buffers) : buffers(buffers) {}
+};
+
+class MultiversionLoops : public IRMutator2 {
+    using IRMutator2::visit;
+
+    const int vector_bytes;
+
+    Stmt visit(const For *op) override {
+        if (!is_cpu_loop(op)) {
+            return op;
+        }
+
+        FindSymbols finder(vector_bytes);
+        op->accept(&finder);
+        if (finder.min_bytes == vector_bytes) {
+            // There are no vector accesses of external buffers we
+            // can make aligned. There won't be any in inner loops
+            // either.
+            return op;
+        }
+        if (!finder.ok) {
+            // Some inner loop nest runs on a device, but the others
+            // may still be worth multiversioning.
+            return IRMutator2::visit(op);
+        }
+
+        set<string> symbols, strides;
+        for (const auto &v : finder.used) {
+            if (!finder.bound.count(v.first)) {
+                symbols.insert(v.first);
+            }
+        }
+        for (const string &s : finder.strides) {
+            if (symbols.count(s)) {
+                strides.insert(s);
+            }
+        }
+
+        // Ask for every symbol to be a multiple of the number of
+        // lanes of the narrowest type accessed, so that the vector
+        // accesses of all types are aligned.
+        const int modulus = vector_bytes / finder.min_bytes;
+        FindAlignableAccesses alignable(vector_bytes, modulus, symbols, strides);
+        op->accept(&alignable);
+        if (alignable.buffers.empty() && alignable.dense_strides.empty()) {
+            // Inner loop nests depend on fewer symbols, so they may
+            // still have accesses we can align.
+            return IRMutator2::visit(op);
+        }
+
+        Expr condition = const_true();
+        Stmt fast = op;
+
+        map<string, Expr> replacements;
+        for (const string &s : alignable.dense_strides) {
+            condition = condition && finder.used[s] == 1;
+            replacements[s] = 1;
+        }
+        if (!replacements.empty()) {
+            fast = simplify(substitute(replacements, fast));
+        }
+
+        // Rewrite the symbols in a way that lets codegen see that
+        // they are multiples of the vector width.
+        replacements.clear();
+        for (const string &s : alignable.aligned_symbols) {
+            if (!alignable.dense_strides.count(s)) {
+                Expr var = finder.used[s];
+                condition = condition && (var % modulus) == 0;
+                replacements[s] = (var / modulus) * modulus;
+            }
+        }
+        fast = substitute(replacements, fast);
+
+        // Give the buffers new names that aren't marked as external
+        // to codegen, which assumes that non-external buffers are
+        // aligned to the native vector width.
+        fast = RenameBuffers(alignable.buffers).mutate(fast);
+        for (const auto &b : alignable.buffers) {
+            Expr host_ptr = Variable::make(Handle(), b.first, b.second);
+            condition = condition && (reinterpret<uint64_t>(host_ptr) % vector_bytes) == 0;
+            fast = LetStmt::make(b.first + ".aligned", host_ptr, fast);
+        }
+
+        debug(3) << "Multiversioning loop " << op->name << " on " << condition << "\n";
+
+        return IfThenElse::make(condition, fast, op);
+    }
+
+public:
+    MultiversionLoops(int vector_bytes) : vector_bytes(vector_bytes) {}
+};
+
+}  // namespace
+
+Stmt multiversion_loops(Stmt s, const Target &t) {
+    if (!t.has_feature(Target::MultiversionLoops) || t.arch == Target::Hexagon) {
+        // This doubles the code size of the loop nests it applies to,
+        // so it's opt-in. HVX code has its own handling of alignment
+        // in align_loads.
+        return s;
+    }
+    return MultiversionLoops(t.natural_vector_size<uint8_t>()).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
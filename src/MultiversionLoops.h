@@ -0,0 +1,30 @@
+#ifndef HALIDE_MULTIVERSION_LOOPS_H
+#define HALIDE_MULTIVERSION_LOOPS_H
+
+/** \file
+ * Defines a lowering pass that emits a second copy of loop nests that
+ * access input and output buffers with vectors, specialized for the
+ * case where those buffers are dense and aligned.
+ */
+
+#include "IR.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** For each outermost loop nest on the host that does vector loads or
+ * stores of external buffers, emit a fast path guarded by a runtime
+ * check that the host pointers are aligned to the native vector
+ * width, that the symbolic strides of the innermost dimension are
+ * one, and that the mins and strides used in the indexing are
+ * multiples of the vector width. Within the fast path, the vector
+ * loads and stores of those buffers are known to be dense and
+ * aligned. The original loop nest is kept as the fallback. Does
+ * nothing unless the target has the MultiversionLoops feature. */
+Stmt multiversion_loops(Stmt s, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
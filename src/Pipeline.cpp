@@ -1,9 +1,17 @@
 #include <algorithm>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 #include "Argument.h"
 #include "FindCalls.h"
 #include "Func.h"
+#include "IRMutator.h"
+#include "IRPrinter.h"
 #include "IRVisitor.h"
+#include "ImageParam.h"
 #include "InferArguments.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Output.h"
@@ -13,11 +21,13 @@
 #include "Pipeline.h"
 #include "PrintLoopNest.h"
 #include "RealizationOrder.h"
+#include "SimplifySpecializations.h"
 
 using namespace Halide::Internal;
 
 namespace Halide {
 
+using std::map;
 using std::set;
 using std::string;
 using std::vector;
@@ -42,8 +52,309 @@ Outputs static_library_outputs(const string &filename_prefix, const Target &targ
     return outputs;
 }
 
+// Rename every variable and allocation bound inside a Stmt to a
+// canonical name that depends only on the order in which they are
+// bound. Lowering names many things with unique_name, so lowering the
+// same pipeline twice gives different names; canonicalizing them lets
+// us recognize that the results are the same program.
+class CanonicalizeNames : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Scope<string> names;
+    int count = 0;
+
+    string bind(const string &name) {
+        string canonical = "#" + std::to_string(count++);
+        names.push(name, canonical);
+        return canonical;
+    }
+
+    string rename(const string &name) {
+        return names.contains(name) ? names.get(name) : name;
+    }
+
+    Expr visit(const Variable *op) override {
+        return Variable::make(op->type, rename(op->name), op->image, op->param, op->reduction_domain);
+    }
+
+    Expr visit(const Let *op) override {
+        Expr value = mutate(op->value);
+        string name = bind(op->name);
+        Expr body = mutate(op->body);
+        names.pop(op->name);
+        return Let::make(name, value, body);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        Expr value = mutate(op->value);
+        string name = bind(op->name);
+        Stmt body = mutate(op->body);
+        names.pop(op->name);
+        return LetStmt::make(name, value, body);
+    }
+
+    Stmt visit(const For *op) override {
+        Expr min = mutate(op->min);
+        Expr extent = mutate(op->extent);
+        string name = bind(op->name);
+        Stmt body = mutate(op->body);
+        names.pop(op->name);
+        return For::make(name, min, extent, op->for_type, op->device_api, body);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        vector<Expr> extents;
+        for (const Expr &e : op->extents) {
+            extents.push_back(mutate(e));
+        }
+        Expr condition = mutate(op->condition);
+        Expr new_expr;
+        if (op->new_expr.defined()) {
+            new_expr = mutate(op->new_expr);
+        }
+        string name = bind(op->name);
+        Stmt body = mutate(op->body);
+        names.pop(op->name);
+        return Allocate::make(name, op->type, op->memory_type, extents, condition,
+                              body, new_expr, op->free_function);
+    }
+
+    Expr visit(const Load *op) override {
+        return Load::make(op->type, rename(op->name), mutate(op->index), op->image,
+                          op->param, mutate(op->predicate));
+    }
+
+    Stmt visit(const Store *op) override {
+        return Store::make(rename(op->name), mutate(op->value), mutate(op->index),
+                           op->param, mutate(op->predicate));
+    }
+
+    Stmt visit(const Free *op) override {
+        return Free::make(rename(op->name));
+    }
+};
+
+// Prints IR for use as a jit_module_memo_key. IRPrinter rounds float
+// constants and leaves out the types of calls, so two different
+// pipelines could otherwise print the same way.
+class PrintExactIR : public IRPrinter {
+public:
+    PrintExactIR(std::ostream &s) : IRPrinter(s) {}
+
+protected:
+    using IRPrinter::visit;
+
+    void visit(const FloatImm *op) override {
+        uint64_t bits;
+        memcpy(&bits, &op->value, sizeof(bits));
+        stream << "(" << op->type << ")0x" << std::hex << bits << std::dec;
+    }
+
+    void visit(const Call *op) override {
+        stream << "(" << op->type << ", " << (int)op->call_type << ")";
+        IRPrinter::visit(op);
+    }
+};
+
+// A string that is the same for two modules if and only if jit
+// compiling them would give the same code, or the empty string if
+// we can't tell. The modules' embedded buffers (e.g. GPU kernel
+// source) and any externs that are themselves Pipelines could change
+// without changing the lowered code, so we don't try to match
+// modules that have them.
+string jit_module_memo_key(const Module &module, const map<string, JITExtern> &externs) {
+    if (!module.buffers().empty() || !module.submodules().empty()) {
+        return "";
+    }
+    std::ostringstream key;
+    for (const auto &it : externs) {
+        if (it.second.pipeline().defined()) {
+            return "";
+        }
+        key << "extern " << it.first << " = " << it.second.extern_c_function().address() << "\n";
+    }
+    key << "module name=" << module.name() << ", target=" << module.target().to_string() << "\n";
+    for (const LoweredFunc &f : module.functions()) {
+        key << (int)f.linkage << " func " << f.name << " (";
+        for (const Argument &arg : f.args) {
+            key << arg.name << ": " << (int)arg.kind << " " << arg.type
+                << " " << (int)arg.dimensions << ", ";
+        }
+        key << ") {\n";
+        PrintExactIR(key).print(CanonicalizeNames().mutate(f.body));
+        key << "}\n";
+    }
+    return key.str();
+}
+
+// Whether the host cpu has all the instruction set extensions that a
+// Target asks for. Features that don't describe the cpu (e.g. Debug,
+// or the GPU APIs) are ignored.
+bool host_can_use_target(const Target &t) {
+    static const Target::Feature cpu_features[] = {
+        Target::SSE41, Target::AVX, Target::AVX2, Target::FMA, Target::FMA4,
+        Target::F16C, Target::AVX512, Target::AVX512_KNL, Target::AVX512_Skylake,
+        Target::AVX512_Cannonlake, Target::AVX512_Cascadelake, Target::AVX512_Cooperlake,
+        Target::ARMv7s, Target::ARMDotProd, Target::ARMFp16,
+        Target::VSX, Target::POWER_ARCH_2_07,
+    };
+    Target host = get_host_target();
+    for (Target::Feature f : cpu_features) {
+        if (t.has_feature(f) && !host.has_feature(f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The number of previously jit-compiled modules each Pipeline keeps.
+const size_t max_memoized_jit_modules = 8;
+
 }  // namespace
 
+/** A memo of the code most recently jit-compiled for a Pipeline, most
+ * recent first, keyed by jit_module_memo_key of the module it was
+ * compiled from. Lowering always runs in full; the memo only skips
+ * LLVM codegen when lowering gives exactly the same code as one of
+ * the last few compilations. Shared by the Pipeline and its
+ * lazily-compiled specializations, which may compile from other
+ * threads. */
+struct JITModuleMemo {
+    std::mutex mutex;
+    std::list<std::pair<string, JITModule>> modules;
+
+    /** Get the code for a function in a module, reusing code compiled
+     * from an identical module if there is one. */
+    JITModule compile(const Module &module, const string &fn_name, const Target &target,
+                      std::map<string, JITExtern> externs) {
+        string key = jit_module_memo_key(module, externs);
+        if (!key.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = modules.begin(); it != modules.end(); it++) {
+                if (it->first == key) {
+                    debug(1) << "Reusing jit module previously compiled for " << fn_name << "\n";
+                    modules.splice(modules.begin(), modules, it);
+                    return modules.front().second;
+                }
+            }
+        }
+
+        auto f = module.get_function_by_name(fn_name);
+        JITModule jit_module(module, f, Pipeline::make_externs_jit_module(target, externs));
+        if (!key.empty()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            modules.emplace_front(key, jit_module);
+            if (modules.size() > max_memoized_jit_modules) {
+                modules.pop_back();
+            }
+        }
+        return jit_module;
+    }
+};
+
+/** The state needed to compile the specializations of a Pipeline
+ * lazily. See Pipeline::set_jit_lazy_specializations. */
+struct LazySpecializations {
+    /** The distinct specialization conditions in the pipeline. */
+    vector<Expr> conditions;
+
+    /** What's needed to compile the pipeline for a given set of
+     * condition values. The outputs are a copy of the pipeline taken
+     * when this was made, so that later changes to the Funcs don't
+     * leak into the variants compiled from it. The custom lowering
+     * passes are shared with the pipeline, so that they aren't
+     * deleted while this still uses them. */
+    vector<Function> outputs;
+    vector<std::shared_ptr<IRMutator2>> custom_passes;
+    std::map<string, JITExtern> jit_externs;
+    Target target;
+    string name;
+    vector<Argument> args;
+    std::shared_ptr<JITModuleMemo> jit_module_memo;
+
+    /** The code compiled so far, for each set of condition values. */
+    std::mutex mutex;
+    std::map<vector<bool>, JITModule> variants;
+
+    /** Get the code for the pipeline with the given condition values,
+     * compiling it if this is the first time we've seen them. */
+    JITModule get_variant(const vector<bool> &values) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = variants.find(values);
+        if (it != variants.end()) {
+            return it->second;
+        }
+
+        debug(1) << "Compiling specialization of " << name << " for conditions:\n";
+        for (size_t i = 0; i < conditions.size(); i++) {
+            debug(1) << "  " << conditions[i] << " = " << values[i] << "\n";
+        }
+
+        // Replace the conditions with their values in a copy of the
+        // pipeline, so that lowering drops the other branches.
+        map<string, Function> env;
+        for (Function f : outputs) {
+            populate_environment(f, env);
+        }
+        vector<Function> copied_outputs;
+        std::tie(copied_outputs, env) = deep_copy(outputs, env);
+        fix_specialization_conditions(env, conditions, values);
+
+        vector<IRMutator2 *> passes;
+        for (const auto &p : custom_passes) {
+            passes.push_back(p.get());
+        }
+
+        // Variants compiled before the pipeline's cache was last
+        // invalidated are in the memo.
+        Module module = lower(copied_outputs, name, target, args,
+                              LinkageType::ExternalPlusMetadata, passes).resolve_submodules();
+        JITModule jit_module = jit_module_memo->compile(module, name, target, jit_externs);
+        variants[values] = jit_module;
+        return jit_module;
+    }
+};
+
+/** The jit-compiled code for a Pipeline, and the arguments it
+ * expects. This is never modified once made, so realizations that are
+ * running when the Pipeline is recompiled can keep using it. */
+struct JITCache {
+    mutable RefCount ref_count;
+
+    /** The compiled pipeline. If lazy is set, this instead computes
+     * the value of each of its conditions. */
+    JITModule jit_module;
+    Target jit_target;
+
+    /** The arguments to the main function in the jit_module. */
+    vector<InferredArgument> inferred_args;
+
+    std::unique_ptr<LazySpecializations> lazy;
+};
+
+namespace Internal {
+template<>
+RefCount &ref_count<JITCache>(const JITCache *p) {
+    return p->ref_count;
+}
+
+template<>
+void destroy<JITCache>(const JITCache *p) {
+    delete p;
+}
+}
+
+/** An output of a Pipeline whose values are passed to the next call
+ * to realize. See Pipeline::add_state. */
+struct PipelineState {
+    Function func;
+    ImageParam previous;
+
+    /** The buffer the state was realized into by the last call, and
+     * the one before that, which we can realize into next. */
+    Buffer<> last, spare;
+};
+
 struct PipelineContents {
     mutable RefCount ref_count;
 
@@ -54,14 +365,30 @@ struct PipelineContents {
     string name;
 
     // Cached jit-compiled code
-    JITModule jit_module;
-    Target jit_target;
+    IntrusivePtr<JITCache> jit_cache;
+
+    // A memo of the code most recently jit-compiled for this
+    // pipeline. Unlike jit_cache, this survives invalidate_cache, so
+    // that changing the schedule back to one of the last few we've
+    // compiled only reruns lowering, not LLVM codegen.
+    std::shared_ptr<JITModuleMemo> jit_module_memo =
+        std::make_shared<JITModuleMemo>();
+
+    // Whether realize compiles specializations on first use, and the
+    // jit-compiled code it uses if so.
+    bool jit_lazy_specializations = false;
+    IntrusivePtr<JITCache> lazy_jit_cache;
+
+    /** Guards jit_cache, jit_handlers, jit_externs, and the custom
+     * lowering passes, so that many threads can realize the pipeline
+     * at once. */
+    std::mutex jit_mutex;
 
     /** Clear all cached state */
     void invalidate_cache() {
         module = Module("", Target());
-        jit_module = JITModule();
-        jit_target = Target();
+        jit_cache = nullptr;
+        lazy_jit_cache = nullptr;
         inferred_args.clear();
     }
 
@@ -81,15 +408,42 @@ struct PipelineContents {
     /** A set of custom passes to use when lowering this Func. */
     vector<CustomLoweringPass> custom_lowering_passes;
 
-    /** The inferred arguments. Also the arguments to the main
-     * function in the jit_module above. The two must be updated
-     * together. */
+    /** The same passes, each calling its deleter once neither the
+     * pipeline nor any lazily-compiled specializations of it use it
+     * any more. */
+    vector<std::shared_ptr<IRMutator2>> custom_lowering_pass_owners;
+
+    /** The inferred arguments. Copied into the jit_cache when jit
+     * compiling. */
     vector<InferredArgument> inferred_args;
 
     /** List of C funtions and Funcs to satisfy HalideExtern* and
      * define_extern calls. */
     std::map<std::string, JITExtern> jit_externs;
 
+    /** The outputs whose values are carried over between calls to
+     * realize. */
+    vector<PipelineState> states;
+
+    /** Guards states. Calls to realize that use them hold this until
+     * they have updated them, since each call reads the outputs of
+     * the one before. */
+    std::mutex state_mutex;
+
+    /** The index of the first buffer of an output in a Realization of
+     * this pipeline. */
+    size_t output_buffer_index(const Function &f) const {
+        size_t index = 0;
+        for (const Function &out : outputs) {
+            if (out.same_as(f)) {
+                return index;
+            }
+            index += out.output_types().size();
+        }
+        internal_error << "Function " << f.name() << " is not an output of this Pipeline\n";
+        return 0;
+    }
+
     PipelineContents() :
         module("", Target()) {
         user_context_arg.arg = Argument("__user_context", Argument::InputScalar, type_of<const void*>(), 0);
@@ -102,12 +456,8 @@ struct PipelineContents {
 
     void clear_custom_lowering_passes() {
         invalidate_cache();
-        for (size_t i = 0; i < custom_lowering_passes.size(); i++) {
-            if (custom_lowering_passes[i].deleter) {
-                custom_lowering_passes[i].deleter();
-            }
-        }
         custom_lowering_passes.clear();
+        custom_lowering_pass_owners.clear();
     }
 };
 
@@ -410,25 +760,95 @@ std::string Pipeline::generate_function_name() const {
 
 void *Pipeline::compile_jit(const Target &target_arg) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    return get_jit_cache(target_arg)->jit_module.main_function();
+}
+
+IntrusivePtr<JITCache> Pipeline::get_jit_cache(const Target &target_arg, JITHandlers *handlers,
+                                               bool allow_lazy) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+
+    // Held while compiling, so that other threads realizing this
+    // pipeline wait for the compiled code rather than racing to make
+    // their own.
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
+
+    if (handlers) {
+        *handlers = contents->jit_handlers;
+    }
+
+    const bool lazy = allow_lazy && contents->jit_lazy_specializations;
+    IntrusivePtr<JITCache> &cache = lazy ? contents->lazy_jit_cache : contents->jit_cache;
 
     Target target(target_arg);
+    if (target.os == Target::OSUnknown) {
+        // If we've already jit-compiled for a specific target, use that.
+        if (cache.defined()) {
+            return cache;
+        }
+        // Otherwise get the target from the environment
+        target = get_jit_target_from_environment();
+    }
     target.set_feature(Target::JIT);
     target.set_feature(Target::UserContext);
 
-    debug(2) << "jit-compiling for: " << target_arg << "\n";
+    if (lazy) {
+        if (cache.defined() && cache->jit_target == target) {
+            return cache;
+        }
+        cache = compile_lazy_jit_cache(target);
+        if (cache.defined()) {
+            return cache;
+        }
+        // There are no specializations to be lazy about, so share
+        // the ordinary compiled code.
+        cache = get_jit_cache_locked(target);
+        return cache;
+    }
+    return get_jit_cache_locked(target);
+}
+
+void *Pipeline::compile_jit(const vector<Target> &targets) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    user_assert(!targets.empty()) << "compile_jit needs at least one Target\n";
+
+    const Target &base_target = targets.back();
+    for (const Target &t : targets) {
+        user_assert(t.os == base_target.os &&
+                    t.arch == base_target.arch &&
+                    t.bits == base_target.bits)
+            << "All Targets passed to compile_jit must have matching arch-bits-os.\n";
+    }
+
+    if (targets.size() > 1) {
+        // Jitted code only runs on the machine that compiled it, so
+        // we can choose using the features of the host cpu.
+        for (size_t i = 0; i + 1 < targets.size(); i++) {
+            if (host_can_use_target(targets[i])) {
+                debug(1) << "compile_jit: host can use " << targets[i] << "\n";
+                return compile_jit(targets[i]);
+            }
+            debug(1) << "compile_jit: host can't use " << targets[i] << "\n";
+        }
+    }
+
+    return compile_jit(base_target);
+}
+
+// Compile the pipeline for the given target, unless we already
+// have. Must be called with the jit_mutex held.
+IntrusivePtr<JITCache> Pipeline::get_jit_cache_locked(const Target &target) {
+    debug(2) << "jit-compiling for: " << target << "\n";
 
     // If we're re-jitting for the same target, we can just keep the
     // old jit module.
-    if (contents->jit_target == target &&
-        contents->jit_module.compiled()) {
-        debug(2) << "Reusing old jit module compiled for :\n" << contents->jit_target << "\n";
-        return contents->jit_module.main_function();
+    if (contents->jit_cache.defined() &&
+        contents->jit_cache->jit_target == target) {
+        debug(2) << "Reusing old jit module compiled for :\n" << target << "\n";
+        return contents->jit_cache;
     }
     // Clear all cached info in case there is an error.
     contents->invalidate_cache();
 
-    contents->jit_target = target;
-
     // Infer an arguments vector
     infer_arguments();
 
@@ -446,12 +866,9 @@ void *Pipeline::compile_jit(const Target &target_arg) {
 
     // Compile to a module and also compile any submodules.
     Module module = compile_to_module(args, name, target).resolve_submodules();
-    auto f = module.get_function_by_name(name);
-
-    std::map<std::string, JITExtern> lowered_externs = contents->jit_externs;
 
-    // Compile to jit module
-    JITModule jit_module(module, f, make_externs_jit_module(target_arg, lowered_externs));
+    // Compile to jit module, unless we've compiled the same code before.
+    JITModule jit_module = contents->jit_module_memo->compile(module, name, target, contents->jit_externs);
 
     // Dump bitcode to a file if the environment variable
     // HL_GENBITCODE is defined to a nonzero value.
@@ -465,48 +882,117 @@ void *Pipeline::compile_jit(const Target &target_arg) {
         module.compile(Outputs().bitcode(file_name));
     }
 
-    contents->jit_module = jit_module;
+    JITCache *cache = new JITCache;
+    cache->jit_module = jit_module;
+    cache->jit_target = target;
+    cache->inferred_args = contents->inferred_args;
+    contents->jit_cache = cache;
 
-    return jit_module.main_function();
+    return contents->jit_cache;
+}
+
+// Make a JITCache that compiles specializations lazily, or return
+// nullptr if there aren't any. Must be called with the jit_mutex held.
+IntrusivePtr<JITCache> Pipeline::compile_lazy_jit_cache(const Target &target) {
+    map<string, Function> env;
+    for (Function f : contents->outputs) {
+        populate_environment(f, env);
+    }
+    vector<Expr> conditions = get_specialization_conditions(env);
+    if (conditions.empty()) {
+        return nullptr;
+    }
+
+    debug(2) << "Compiling " << conditions.size() << " specialization conditions lazily\n";
+
+    infer_arguments();
+    vector<Argument> args;
+    for (const InferredArgument &arg : contents->inferred_args) {
+        args.push_back(arg.arg);
+    }
+    string name = generate_function_name();
+
+    // Make a pipeline with the same arguments that computes the value
+    // of each condition. We run that first to decide which version
+    // of the real pipeline to call.
+    Var x("x");
+    Func values(name + "_specialization_conditions");
+    Expr value = cast<uint8_t>(conditions.back());
+    for (size_t i = conditions.size() - 1; i > 0; i--) {
+        value = select(x == (int)(i - 1), cast<uint8_t>(conditions[i - 1]), value);
+    }
+    values(x) = value;
+    Module module = Pipeline(values).compile_to_module(args, values.name(), target);
+
+    JITCache *cache = new JITCache;
+    cache->jit_module = JITModule(module, module.get_function_by_name(values.name()));
+    cache->jit_target = target;
+    cache->inferred_args = contents->inferred_args;
+
+    LazySpecializations *lazy = new LazySpecializations;
+    cache->lazy.reset(lazy);
+    lazy->conditions = conditions;
+    lazy->outputs = deep_copy(contents->outputs, env).first;
+    lazy->custom_passes = contents->custom_lowering_pass_owners;
+    lazy->jit_externs = contents->jit_externs;
+    lazy->target = target;
+    lazy->name = name;
+    lazy->args = args;
+    lazy->jit_module_memo = contents->jit_module_memo;
+
+    return cache;
 }
 
 
 void Pipeline::set_error_handler(void (*handler)(void *, const char *)) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->jit_handlers.custom_error = handler;
 }
 
 void Pipeline::set_custom_allocator(void *(*cust_malloc)(void *, size_t),
                                     void (*cust_free)(void *, void *)) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->jit_handlers.custom_malloc = cust_malloc;
     contents->jit_handlers.custom_free = cust_free;
 }
 
 void Pipeline::set_custom_do_par_for(int (*cust_do_par_for)(void *, int (*)(void *, int, uint8_t *), int, int, uint8_t *)) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->jit_handlers.custom_do_par_for = cust_do_par_for;
 }
 
 void Pipeline::set_custom_do_task(int (*cust_do_task)(void *, int (*)(void *, int, uint8_t *), int, uint8_t *)) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->jit_handlers.custom_do_task = cust_do_task;
 }
 
 void Pipeline::set_custom_trace(int (*trace_fn)(void *, const halide_trace_event_t *)) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->jit_handlers.custom_trace = trace_fn;
 }
 
 void Pipeline::set_custom_print(void (*cust_print)(void *, const char *)) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->jit_handlers.custom_print = cust_print;
 }
 
+void Pipeline::set_jit_lazy_specializations(bool lazy) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
+    contents->jit_lazy_specializations = lazy;
+}
+
 void Pipeline::set_jit_externs(const std::map<std::string, JITExtern> &externs) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->jit_externs = externs;
-    invalidate_cache();
+    contents->invalidate_cache();
 }
 
 const std::map<std::string, JITExtern> &Pipeline::get_jit_externs() {
@@ -516,13 +1002,20 @@ const std::map<std::string, JITExtern> &Pipeline::get_jit_externs() {
 
 void Pipeline::add_custom_lowering_pass(IRMutator2 *pass, std::function<void()> deleter) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->invalidate_cache();
     CustomLoweringPass p = {pass, deleter};
     contents->custom_lowering_passes.push_back(p);
+    contents->custom_lowering_pass_owners.emplace_back(pass, [deleter](IRMutator2 *) {
+        if (deleter) {
+            deleter();
+        }
+    });
 }
 
 void Pipeline::clear_custom_lowering_passes() {
     if (!defined()) return;
+    std::lock_guard<std::mutex> lock(contents->jit_mutex);
     contents->clear_custom_lowering_passes();
 }
 
@@ -531,6 +1024,41 @@ const vector<CustomLoweringPass> &Pipeline::custom_lowering_passes() {
     return contents->custom_lowering_passes;
 }
 
+void Pipeline::add_state(Func state, ImageParam previous) {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->state_mutex);
+    const Function &f = state.function();
+    bool is_output = false;
+    for (const Function &out : contents->outputs) {
+        is_output = is_output || out.same_as(f);
+    }
+    user_assert(is_output)
+        << "Can't use " << f.name() << " as state, because it is not an output of the Pipeline.\n";
+    user_assert(f.output_types().size() == 1)
+        << "Can't use " << f.name() << " as state, because it has multiple values.\n";
+    user_assert(f.output_types()[0] == previous.type() &&
+                f.dimensions() == previous.dimensions())
+        << "The ImageParam " << previous.name() << " for the previous values of "
+        << f.name() << " must have the same type and dimensionality as " << f.name() << "\n";
+    for (const PipelineState &s : contents->states) {
+        user_assert(!s.func.same_as(f))
+            << "Func " << f.name() << " is already used as state.\n";
+    }
+    PipelineState s;
+    s.func = f;
+    s.previous = previous;
+    contents->states.push_back(s);
+}
+
+void Pipeline::reset_state() {
+    user_assert(defined()) << "Pipeline is undefined\n";
+    std::lock_guard<std::mutex> lock(contents->state_mutex);
+    for (PipelineState &s : contents->states) {
+        s.last = Buffer<>();
+        s.spare = Buffer<>();
+    }
+}
+
 const JITHandlers &Pipeline::jit_handlers() {
     user_assert(defined()) << "Pipeline is undefined\n";
     return contents->jit_handlers;
@@ -538,6 +1066,11 @@ const JITHandlers &Pipeline::jit_handlers() {
 
 Realization Pipeline::realize(vector<int32_t> sizes, const Target &target,
                               const ParamMap &param_map) {
+    return realize(nullptr, std::move(sizes), target, param_map);
+}
+
+Realization Pipeline::realize(JITUserContext *context, vector<int32_t> sizes,
+                              const Target &target, const ParamMap &param_map) {
     user_assert(defined()) << "Pipeline is undefined\n";
     vector<Buffer<>> bufs;
     for (auto & out : contents->outputs) {
@@ -547,8 +1080,26 @@ Realization Pipeline::realize(vector<int32_t> sizes, const Target &target,
             bufs.emplace_back(t, sizes);
         }
     }
+    // Realize state into the buffer it was realized into two calls
+    // ago, if it's still the right shape and the caller has let go
+    // of the Buffer we returned for it.
+    {
+        std::lock_guard<std::mutex> lock(contents->state_mutex);
+        for (const PipelineState &s : contents->states) {
+            Buffer<> &buf = bufs[contents->output_buffer_index(s.func)];
+            bool reusable = s.spare.is_unique() && s.spare.dimensions() == buf.dimensions();
+            for (int i = 0; reusable && i < buf.dimensions(); i++) {
+                reusable = (s.spare.dim(i).min() == buf.dim(i).min() &&
+                            s.spare.dim(i).extent() == buf.dim(i).extent() &&
+                            s.spare.dim(i).stride() == buf.dim(i).stride());
+            }
+            if (reusable) {
+                buf = s.spare;
+            }
+        }
+    }
     Realization r(bufs);
-    realize(r, target, param_map);
+    realize(context, r, target, param_map);
     for (size_t i = 0; i < r.size(); i++) {
         r[i].copy_to_host();
     }
@@ -585,6 +1136,15 @@ Realization Pipeline::realize(const Target &target,
 
 namespace {
 
+struct ErrorBuffer;
+
+// The user context passed to jitted code. Handlers are called with a
+// pointer to this, so the default error handler can find the error
+// buffer without taking over the user_context field.
+struct JITCallUserContext : public JITUserContext {
+    ErrorBuffer *error_buffer;
+};
+
 struct ErrorBuffer {
     enum { MaxBufSize = 4096 };
     char buf[MaxBufSize];
@@ -628,29 +1188,34 @@ struct ErrorBuffer {
 
     static void handler(void *ctx, const char *message) {
         if (ctx) {
-            JITUserContext *ctx1 = (JITUserContext *)ctx;
-            ErrorBuffer *buf = (ErrorBuffer *)ctx1->user_context;
-            buf->concat(message);
+            JITCallUserContext *ctx1 = (JITCallUserContext *)ctx;
+            ctx1->error_buffer->concat(message);
         }
     }
 };
 
 struct JITFuncCallContext {
     ErrorBuffer error_buffer;
-    JITUserContext jit_context;
+    JITCallUserContext jit_context;
     bool custom_error_handler;
 
-    JITFuncCallContext(const JITHandlers &handlers) {
+    // The handlers in call_context, if any, override the handlers
+    // set on the Pipeline for this call only.
+    JITFuncCallContext(const JITHandlers &handlers, const JITUserContext *call_context = nullptr) {
         void *user_context = nullptr;
         JITHandlers local_handlers = handlers;
+        if (call_context) {
+            merge_handlers(local_handlers, call_context->handlers);
+            user_context = call_context->user_context;
+        }
         if (local_handlers.custom_error == nullptr) {
             custom_error_handler = false;
             local_handlers.custom_error = ErrorBuffer::handler;
-            user_context = &error_buffer;
         } else {
             custom_error_handler = true;
         }
         JITSharedRuntime::init_jit_user_context(jit_context, user_context, local_handlers);
+        jit_context.error_buffer = &error_buffer;
 
         debug(2) << "custom_print: " << (void *)jit_context.handlers.custom_print << '\n'
                  << "custom_malloc: " << (void *)jit_context.handlers.custom_malloc << '\n'
@@ -711,19 +1276,18 @@ private:
 // Make a vector of void *'s to pass to the jit call using the
 // currently bound value for all of the params and image
 // params.
-void Pipeline::prepare_jit_call_arguments(RealizationArg &outputs, const Target &target,
+void Pipeline::prepare_jit_call_arguments(RealizationArg &outputs, const JITCache &cache,
                                           const ParamMap &param_map, void *user_context,
                                           bool is_bounds_inference, JITCallArgs &args_result) {
     user_assert(defined()) << "Can't realize an undefined Pipeline\n";
 
-    JITModule &compiled_module = contents->jit_module;
-    internal_assert(compiled_module.argv_function());
+    internal_assert(cache.jit_module.argv_function());
 
     const bool no_param_map = &param_map == &ParamMap::empty_map();
 
     // Come up with the void * arguments to pass to the argv function
     size_t arg_index = 0;
-    for (const InferredArgument &arg : contents->inferred_args) {
+    for (const InferredArgument &arg : cache.inferred_args) {
         if (arg.param.defined()) {
             if (arg.param.same_as(contents->user_context_arg.param)) {
                 args_result.store[arg_index++] = user_context;
@@ -793,14 +1357,14 @@ Pipeline::make_externs_jit_module(const Target &target,
             PipelineContents &pipeline_contents(*pipeline.contents);
 
             // Ensure that the pipeline is compiled.
-            pipeline.compile_jit(target);
+            IntrusivePtr<JITCache> cache = pipeline.get_jit_cache(target);
 
-            free_standing_jit_externs.add_dependency(pipeline_contents.jit_module);
-            free_standing_jit_externs.add_symbol_for_export(iter->first, pipeline_contents.jit_module.entrypoint_symbol());
-            void *address = pipeline_contents.jit_module.entrypoint_symbol().address;
+            free_standing_jit_externs.add_dependency(cache->jit_module);
+            free_standing_jit_externs.add_symbol_for_export(iter->first, cache->jit_module.entrypoint_symbol());
+            void *address = cache->jit_module.entrypoint_symbol().address;
             std::vector<Type> arg_types;
             // Add the arguments to the compiled pipeline
-            for (const InferredArgument &arg : pipeline_contents.inferred_args) {
+            for (const InferredArgument &arg : cache->inferred_args) {
                 // TODO: it's not clear whether arg.arg.type is correct for
                 // the arg.is_buffer() case (AFAIK, is_buffer()==true isn't possible
                 // in current mtrunk Halide, but may be in some side branches that
@@ -828,7 +1392,11 @@ Pipeline::make_externs_jit_module(const Target &target,
 
 void Pipeline::realize(RealizationArg outputs, const Target &t,
                        const ParamMap &param_map) {
-    Target target = t;
+    realize(nullptr, std::move(outputs), t, param_map);
+}
+
+void Pipeline::realize(JITUserContext *context, RealizationArg outputs, const Target &target,
+                       const ParamMap &param_map) {
     user_assert(defined()) << "Can't realize an undefined Pipeline\n";
 
     debug(2) << "Realizing Pipeline for " << target << "\n";
@@ -851,17 +1419,6 @@ void Pipeline::realize(RealizationArg outputs, const Target &t,
             << "The Buffers passed to realize must all be allocated\n";
     }
 
-    // If target is unspecified...
-    if (target.os == Target::OSUnknown) {
-        // If we've already jit-compiled for a specific target, use that.
-        if (contents->jit_module.compiled()) {
-            target = contents->jit_target;
-        } else {
-            // Otherwise get the target from the environment
-            target = get_jit_target_from_environment();
-        }
-    }
-
     // We need to make a context for calling the jitted function to
     // carry the the set of custom handlers. Here's how handlers get
     // called when running jitted code:
@@ -884,17 +1441,100 @@ void Pipeline::realize(RealizationArg outputs, const Target &t,
     // user_context is just a pointer to a JITUserContext, which is a
     // member of the JITFuncCallContext which we will declare now:
 
-    // Ensure the module is compiled.
-    compile_jit(target);
+    // Ensure the module is compiled. If the target is unspecified,
+    // this uses the target we last compiled for, if any. From here
+    // on we only use the returned cache and handlers, so other
+    // threads may realize or recompile this pipeline meanwhile.
+    JITHandlers handlers;
+    IntrusivePtr<JITCache> cache = get_jit_cache(target, &handlers, true);
 
     // This has to happen after a runtime has been compiled in compile_jit.
-    JITFuncCallContext jit_context(jit_handlers());
+    JITFuncCallContext jit_context(handlers, context);
     void *user_context_storage = &jit_context.jit_context;
 
-    JITCallArgs args(contents->inferred_args.size() + outputs.size());
-    prepare_jit_call_arguments(outputs, target, param_map,
+    // Bind the previous values of any state outputs. Calls that use
+    // state take turns, since each one reads the outputs of the one
+    // before.
+    std::unique_lock<std::mutex> state_lock(contents->state_mutex);
+    if (contents->states.empty()) {
+        state_lock.unlock();
+    }
+    const ParamMap *call_param_map = &param_map;
+    ParamMap state_param_map;
+    vector<Buffer<>> state_outputs;
+    if (!contents->states.empty()) {
+        state_param_map = param_map;
+        call_param_map = &state_param_map;
+        for (PipelineState &s : contents->states) {
+            size_t index = contents->output_buffer_index(s.func);
+            Buffer<> out;
+            if (outputs.r) {
+                out = (*outputs.r)[index];
+            } else if (outputs.buffer_list) {
+                out = (*outputs.buffer_list)[index];
+            } else {
+                // Doesn't take ownership. The values are copied into
+                // a buffer of our own after the call.
+                out = Buffer<>(*outputs.buf);
+            }
+            state_outputs.push_back(out);
+
+            Parameter previous = s.previous.parameter();
+            Buffer<> *unused = nullptr;
+            if (!param_map.map(previous, unused).same_as(previous)) {
+                // Explicitly bound by the caller.
+                continue;
+            }
+
+            bool same_shape = s.last.defined() && s.last.dimensions() == out.dimensions();
+            for (int i = 0; same_shape && i < out.dimensions(); i++) {
+                same_shape = (s.last.dim(i).min() == out.dim(i).min() &&
+                              s.last.dim(i).extent() == out.dim(i).extent());
+            }
+            if (!same_shape) {
+                // Start from zeros.
+                vector<int> mins, extents;
+                for (int i = 0; i < out.dimensions(); i++) {
+                    mins.push_back(out.dim(i).min());
+                    extents.push_back(out.dim(i).extent());
+                }
+                s.last = Buffer<>(out.type(), extents);
+                memset(s.last.data(), 0, s.last.size_in_bytes());
+                s.last.set_min(mins);
+                s.spare = Buffer<>();
+            }
+            user_assert(s.last.data() != out.data())
+                << "Can't realize state " << s.func.name()
+                << " into the same buffer as its previous values.\n";
+            state_param_map.set(s.previous, s.last);
+        }
+    }
+
+    JITCallArgs args(cache->inferred_args.size() + outputs.size());
+    prepare_jit_call_arguments(outputs, *cache, *call_param_map,
                                &user_context_storage, false, args);
 
+    JITModule jit_module = cache->jit_module;
+    if (cache->lazy) {
+        // The cached module only computes the specialization
+        // conditions. Run it to find out which version of the
+        // pipeline we need, then get that, compiling it if necessary.
+        const size_t num_inputs = cache->inferred_args.size();
+        Runtime::Buffer<uint8_t> values((int)cache->lazy->conditions.size());
+        JITCallArgs values_args(num_inputs + 1);
+        for (size_t i = 0; i < num_inputs; i++) {
+            values_args.store[i] = args.store[i];
+        }
+        values_args.store[num_inputs] = values.raw_buffer();
+        int exit_status = jit_module.argv_function()(values_args.store);
+        if (exit_status) {
+            jit_context.finalize(exit_status);
+            return;
+        }
+        vector<bool> key(values.begin(), values.end());
+        jit_module = cache->lazy->get_variant(key);
+    }
+
 
     // The handlers in the jit_context default to the default handlers
     // in the runtime of the shared module (e.g. halide_print_impl,
@@ -934,15 +1574,34 @@ void Pipeline::realize(RealizationArg outputs, const Target &t,
     // exception.
 
     debug(2) << "Calling jitted function\n";
-    int exit_status = contents->jit_module.argv_function()(args.store);
+    int exit_status = jit_module.argv_function()(args.store);
     debug(2) << "Back from jitted function. Exit status was " << exit_status << "\n";
 
+    if (exit_status == 0) {
+        // This call's state outputs are the next call's previous
+        // values.
+        for (size_t i = 0; i < contents->states.size(); i++) {
+            PipelineState &s = contents->states[i];
+            s.spare = s.last;
+            s.last = state_outputs[i];
+            if (outputs.buf) {
+                // We can't keep a reference to a bare halide_buffer_t,
+                // because nothing stops the caller from freeing it.
+                s.last.copy_to_host();
+                s.last = s.last.copy();
+            }
+        }
+    }
+    if (state_lock.owns_lock()) {
+        state_lock.unlock();
+    }
+
     // If we're profiling, report runtimes and reset profiler stats.
-    if (target.has_feature(Target::Profile)) {
+    if (cache->jit_target.has_feature(Target::Profile)) {
         JITModule::Symbol report_sym =
-            contents->jit_module.find_symbol_by_name("halide_profiler_report");
+            jit_module.find_symbol_by_name("halide_profiler_report");
         JITModule::Symbol reset_sym =
-            contents->jit_module.find_symbol_by_name("halide_profiler_reset");
+            jit_module.find_symbol_by_name("halide_profiler_reset");
         if (report_sym.address && reset_sym.address) {
             void *uc = &jit_context.jit_context;
             void (*report_fn_ptr)(void *) = (void (*)(void *))(report_sym.address);
@@ -959,15 +1618,16 @@ void Pipeline::realize(RealizationArg outputs, const Target &t,
 void Pipeline::infer_input_bounds(RealizationArg outputs, const ParamMap &param_map) {
     Target target = get_jit_target_from_environment();
 
-    compile_jit(target);
+    JITHandlers handlers;
+    IntrusivePtr<JITCache> cache = get_jit_cache(target, &handlers);
 
     // This has to happen after a runtime has been compiled in compile_jit.
-    JITFuncCallContext jit_context(jit_handlers());
+    JITFuncCallContext jit_context(handlers);
     void *user_context_storage = &jit_context.jit_context;
 
-    size_t args_size = contents->inferred_args.size() + outputs.size();
+    size_t args_size = cache->inferred_args.size() + outputs.size();
     JITCallArgs args(args_size);
-    prepare_jit_call_arguments(outputs, target, param_map,
+    prepare_jit_call_arguments(outputs, *cache, param_map,
                                &user_context_storage, true, args);
 
     struct TrackedBuffer {
@@ -980,10 +1640,10 @@ void Pipeline::infer_input_bounds(RealizationArg outputs, const ParamMap &param_
     vector<TrackedBuffer> tracked_buffers(args_size);
 
     vector<size_t> query_indices;
-    for (size_t i = 0; i < contents->inferred_args.size(); i++) {
+    for (size_t i = 0; i < cache->inferred_args.size(); i++) {
         if (args.store[i] == nullptr) {
             query_indices.push_back(i);
-            InferredArgument ia = contents->inferred_args[i];
+            InferredArgument ia = cache->inferred_args[i];
             internal_assert(ia.param.defined() && ia.param.is_buffer());
             // Make some empty Buffers of the right dimensionality
             vector<int> initial_shape(ia.param.dimensions(), 0);
@@ -1009,7 +1669,7 @@ void Pipeline::infer_input_bounds(RealizationArg outputs, const ParamMap &param_
         }
 
         Internal::debug(2) << "Calling jitted function\n";
-        int exit_status = contents->jit_module.argv_function()(args.store);
+        int exit_status = cache->jit_module.argv_function()(args.store);
         jit_context.report_if_error(exit_status);
         Internal::debug(2) << "Back from jitted function\n";
         bool changed = false;
@@ -1040,7 +1700,7 @@ void Pipeline::infer_input_bounds(RealizationArg outputs, const ParamMap &param_
 
     // Now allocate the resulting buffers
     for (size_t i : query_indices) {
-        InferredArgument ia = contents->inferred_args[i];
+        InferredArgument ia = cache->inferred_args[i];
         Buffer<> *buf_out_param = nullptr;
         Parameter &p = param_map.map(ia.param, buf_out_param);
 
@@ -1082,10 +1742,185 @@ void Pipeline::infer_input_bounds(int x_size, int y_size, int z_size, int w_size
 
 void Pipeline::invalidate_cache() {
     if (defined()) {
+        std::lock_guard<std::mutex> lock(contents->jit_mutex);
         contents->invalidate_cache();
     }
 }
 
+struct CallableContents {
+    mutable RefCount ref_count;
+
+    // Where each input to the jitted function comes from.
+    struct Slot {
+        enum Kind {
+            UserContext,  // The JITUserContext for the call
+            Constant,     // A Buffer embedded in the pipeline
+            Argument      // One of the arguments to the call
+        } kind;
+        const void *value;
+        size_t arg_index;
+    };
+    vector<Slot> slots;
+
+    // The arguments to the call, inputs then outputs.
+    vector<Argument> arguments;
+    size_t num_inputs;
+
+    // Keeps embedded Buffers alive.
+    vector<Buffer<>> constants;
+
+    JITModule jit_module;
+    int (*argv_function)(const void **){nullptr};
+    JITHandlers jit_handlers;
+
+    // For reporting profiler results when the target has Profile.
+    void (*profiler_report)(void *){nullptr};
+    void (*profiler_reset)(){nullptr};
+};
+
+namespace Internal {
+template<>
+RefCount &ref_count<CallableContents>(const CallableContents *p) {
+    return p->ref_count;
+}
+
+template<>
+void destroy<CallableContents>(const CallableContents *p) {
+    delete p;
+}
+}
+
+Callable Pipeline::compile_to_callable(const vector<Argument> &args, const Target &target) {
+    user_assert(defined()) << "Can't compile an undefined Pipeline\n";
+
+    Callable c;
+    JITHandlers handlers;
+    IntrusivePtr<JITCache> cache = get_jit_cache(target, &handlers);
+
+    c.contents = new CallableContents;
+    CallableContents &cc = *c.contents;
+
+    cc.arguments = args;
+    cc.num_inputs = args.size();
+    for (const Argument &arg : args) {
+        user_assert(arg.is_input())
+            << "Argument " << arg.name << " to compile_to_callable must be an input\n";
+    }
+    for (const InferredArgument &arg : cache->inferred_args) {
+        CallableContents::Slot slot = {CallableContents::Slot::Constant, nullptr, 0};
+        if (arg.param.defined() && arg.param.same_as(contents->user_context_arg.param)) {
+            slot.kind = CallableContents::Slot::UserContext;
+        } else if (!arg.param.defined()) {
+            internal_assert(arg.buffer.defined());
+            cc.constants.push_back(arg.buffer);
+            slot.value = arg.buffer.raw_buffer();
+        } else {
+            size_t i = 0;
+            while (i < args.size() && args[i].name != arg.arg.name) {
+                i++;
+            }
+            user_assert(i < args.size())
+                << "Pipeline uses " << arg.arg.name
+                << ", which is not in the arguments to compile_to_callable\n";
+            user_assert(args[i].is_buffer() == arg.arg.is_buffer() &&
+                        (args[i].is_buffer() || args[i].type == arg.arg.type))
+                << "Argument " << args[i].name << " to compile_to_callable doesn't match "
+                << "the Param of the same name used by the Pipeline\n";
+            slot.kind = CallableContents::Slot::Argument;
+            slot.arg_index = i;
+        }
+        cc.slots.push_back(slot);
+    }
+    for (const Function &f : contents->outputs) {
+        for (const Parameter &p : f.output_buffers()) {
+            cc.arguments.push_back(Argument(p.name(), Argument::OutputBuffer, p.type(), p.dimensions()));
+        }
+    }
+
+    cc.jit_module = cache->jit_module;
+    cc.argv_function = cc.jit_module.argv_function();
+    cc.jit_handlers = handlers;
+    if (cache->jit_target.has_feature(Target::Profile)) {
+        JITModule::Symbol report_sym = cc.jit_module.find_symbol_by_name("halide_profiler_report");
+        JITModule::Symbol reset_sym = cc.jit_module.find_symbol_by_name("halide_profiler_reset");
+        if (report_sym.address && reset_sym.address) {
+            cc.profiler_report = (void (*)(void *))report_sym.address;
+            cc.profiler_reset = (void (*)())reset_sym.address;
+        }
+    }
+    return c;
+}
+
+Callable::Callable() : contents(nullptr) {
+}
+
+bool Callable::defined() const {
+    return contents.defined();
+}
+
+const vector<Argument> &Callable::arguments() const {
+    user_assert(defined()) << "Callable is undefined\n";
+    return contents->arguments;
+}
+
+int Callable::call(size_t argc, const Arg *argv) const {
+    return call(nullptr, argc, argv);
+}
+
+int Callable::call(JITUserContext *context, size_t argc, const Arg *argv) const {
+    user_assert(defined()) << "Can't call an undefined Callable\n";
+    const CallableContents &cc = *contents;
+
+    user_assert(argc == cc.arguments.size())
+        << "Callable expects " << cc.arguments.size()
+        << " arguments, but was called with " << argc << "\n";
+    for (size_t i = 0; i < argc; i++) {
+        const Argument &a = cc.arguments[i];
+        if (a.is_buffer()) {
+            user_assert(argv[i].is_buffer && argv[i].value)
+                << "Argument " << a.name << " to Callable must be a defined buffer\n";
+        } else {
+            // Any pointer may be passed for a Handle.
+            user_assert(!argv[i].is_buffer &&
+                        (argv[i].type == a.type ||
+                         (argv[i].type.is_handle() && a.type.is_handle())))
+                << "Argument " << a.name << " to Callable must be a scalar of type " << a.type << "\n";
+        }
+    }
+
+    JITFuncCallContext jit_context(cc.jit_handlers, context);
+    void *user_context_storage = &jit_context.jit_context;
+
+    Pipeline::JITCallArgs args(cc.slots.size() + argc - cc.num_inputs);
+    size_t arg_index = 0;
+    for (const CallableContents::Slot &slot : cc.slots) {
+        switch (slot.kind) {
+        case CallableContents::Slot::UserContext:
+            args.store[arg_index++] = &user_context_storage;
+            break;
+        case CallableContents::Slot::Constant:
+            args.store[arg_index++] = slot.value;
+            break;
+        case CallableContents::Slot::Argument:
+            args.store[arg_index++] = argv[slot.arg_index].value;
+            break;
+        }
+    }
+    for (size_t i = cc.num_inputs; i < argc; i++) {
+        args.store[arg_index++] = argv[i].value;
+    }
+
+    int exit_status = cc.argv_function(args.store);
+
+    if (cc.profiler_report) {
+        cc.profiler_report(&jit_context.jit_context);
+        cc.profiler_reset();
+    }
+
+    jit_context.finalize(exit_status);
+    return exit_status;
+}
+
 JITExtern::JITExtern(Pipeline pipeline)
     : pipeline_(pipeline) {
 }
@@ -21,7 +21,9 @@
 namespace Halide {
 
 struct Argument;
+struct CallableContents;
 class Func;
+struct JITCache;
 struct Outputs;
 struct PipelineContents;
 
@@ -54,6 +56,81 @@ struct CustomLoweringPass {
 
 struct JITExtern;
 
+/** A jit-compiled Pipeline with its arguments resolved ahead of
+ * time, so that it can be called with very low overhead. The
+ * arguments are passed directly to the call, in the order given to
+ * Pipeline::compile_to_callable, followed by one buffer per output
+ * (one per Tuple element for Funcs that return a Tuple). Scalars
+ * must have exactly the type of the corresponding Param. Buffers may
+ * be passed as a Buffer, a Runtime::Buffer, or a halide_buffer_t *.
+ *
+ * Calling a Callable never touches the Pipeline it came from, so it
+ * is safe to call the same Callable from multiple threads at
+ * once. The custom handlers set on the Pipeline when the Callable
+ * was made are used for every call. Calls don't allocate on the heap
+ * unless the pipeline has more than 64 arguments.
+ *
+ * The return value is the exit status of the pipeline. Errors are
+ * reported in the same way as Pipeline::realize, unless a custom
+ * error handler is installed, in which case the non-zero status is
+ * returned instead. */
+class Callable {
+public:
+    /** A single argument to a Callable. Constructed implicitly from
+     * the arguments to operator(). */
+    struct Arg {
+        // A halide_buffer_t *, or the address of a scalar.
+        const void *value{nullptr};
+        // The type of the scalar. Unused for buffers.
+        Type type;
+        bool is_buffer{false};
+
+        Arg() = default;
+
+        template<typename T,
+                 typename = typename std::enable_if<std::is_arithmetic<T>::value || std::is_pointer<T>::value>::type>
+        Arg(const T &scalar) : value(&scalar), type(type_of<T>()) {}
+
+        Arg(halide_buffer_t *buf) : value(buf), is_buffer(true) {}
+
+        template<typename T>
+        Arg(const Buffer<T> &buf) : value(buf.raw_buffer()), is_buffer(true) {}
+
+        template<typename T, int D>
+        Arg(const Runtime::Buffer<T, D> &buf) : value(buf.raw_buffer()), is_buffer(true) {}
+    };
+
+    /** Make an undefined Callable. */
+    Callable();
+
+    /** Check if this Callable has been compiled from a Pipeline. */
+    bool defined() const;
+
+    /** The arguments the Callable expects, including the output
+     * buffers. */
+    const std::vector<Argument> &arguments() const;
+
+    /** Run the pipeline with the given arguments. */
+    template<typename... Args>
+    int operator()(Args &&... args) const {
+        // The trailing Arg avoids a zero-length array.
+        const Arg argv[] = {Arg(std::forward<Args>(args))..., Arg()};
+        return call(sizeof...(Args), argv);
+    }
+
+    /** Run the pipeline with an array of arguments. */
+    int call(size_t argc, const Arg *argv) const;
+
+    /** Run the pipeline with an array of arguments, and with the
+     * user context and custom handlers in the given
+     * JITUserContext. See Pipeline::realize. */
+    int call(Internal::JITUserContext *context, size_t argc, const Arg *argv) const;
+
+private:
+    friend class Pipeline;
+    Internal::IntrusivePtr<CallableContents> contents;
+};
+
 /** A class representing a Halide pipeline. Constructed from the Func
  * or Funcs that it outputs. */
 class Pipeline {
@@ -95,9 +172,21 @@ public:
     struct JITCallArgs; // Opaque structure to optimize away dynamic allocation in this path.
 
     // For the three method below, precisely one of the first two args should be non-null
-    void prepare_jit_call_arguments(RealizationArg &output, const Target &target, const ParamMap &param_map,
+    void prepare_jit_call_arguments(RealizationArg &output, const JITCache &cache, const ParamMap &param_map,
                                     void *user_context, bool is_bounds_inference, JITCallArgs &args_result);
 
+    // Get the jit-compiled code for the given target, compiling it
+    // first if necessary, and optionally the custom handlers to call
+    // it with. If allow_lazy is true and the pipeline compiles
+    // specializations lazily, the result may only compute the
+    // specialization conditions. Safe to call from multiple threads
+    // at once.
+    Internal::IntrusivePtr<JITCache> get_jit_cache(const Target &target,
+                                                   Internal::JITHandlers *handlers = nullptr,
+                                                   bool allow_lazy = false);
+    Internal::IntrusivePtr<JITCache> get_jit_cache_locked(const Target &target);
+    Internal::IntrusivePtr<JITCache> compile_lazy_jit_cache(const Target &target);
+
     static std::vector<Internal::JITModule> make_externs_jit_module(const Target &target,
                                                                     std::map<std::string, JITExtern> &externs_in_out);
 
@@ -254,6 +343,22 @@ public:
      */
      void *compile_jit(const Target &target = get_jit_target_from_environment());
 
+    /** Jit compile the pipeline for the first of the given Targets
+     * whose instruction set extensions the host cpu has, as reported
+     * by get_host_target. The Targets should be in order of preference, and must all have
+     * the same arch, bits, and os. The last is the baseline, and is
+     * used if none of the others can be. Subsequent calls to realize
+     * with no Target use the one chosen. */
+    void *compile_jit(const std::vector<Target> &targets);
+
+    /** Jit compile the pipeline, and return a Callable that runs it
+     * with the given arguments. Every Param and ImageParam the
+     * pipeline uses must be in the list. Use this instead of realize
+     * when the pipeline is small enough that the per-call overhead
+     * of realize matters. See Callable. */
+    Callable compile_to_callable(const std::vector<Argument> &args,
+                                 const Target &target = get_jit_target_from_environment());
+
     /** Set the error handler function that be called in the case of
      * runtime errors during halide pipelines. If you are compiling
      * statically, you can also just define your own function with
@@ -360,6 +465,46 @@ public:
      * map unless set otherwise. */
     const std::map<std::string, JITExtern> &get_jit_externs();
 
+    /** Compile specializations lazily when jit compiling for
+     * realize. Instead of compiling every branch of every
+     * specialization up front, realize first computes which
+     * specialization conditions are true, then compiles a version of
+     * the pipeline with only those branches the first time it sees
+     * that combination, and caches it. Useful when a pipeline has
+     * many specializations but only a few are used in practice.
+     *
+     * infer_input_bounds, compile_to_callable, and use as a JITExtern
+     * still compile every specialization. */
+    void set_jit_lazy_specializations(bool lazy = true);
+
+    /** Carry the values of an output of this Pipeline over from one
+     * call to realize to the next, for things like temporal filters
+     * and running averages over a stream of frames. On each call,
+     * the ImageParam previous is bound to the buffer that state was
+     * realized into by the previous call (or to zeros of the same
+     * shape, on the first call, or if the shape of the output has
+     * changed), unless it is bound in the ParamMap passed to
+     * realize. The state Func must be a single-valued output of the
+     * Pipeline, and previous must have the same type and
+     * dimensionality.
+     *
+     * No data is copied between calls: the Pipeline just keeps a
+     * reference to the output buffer. The exception is realizing into
+     * a bare halide_buffer_t, which the Pipeline can't keep a
+     * reference to, so it copies the values. When realize allocates the
+     * output buffers itself, the state is realized into the buffer
+     * from two calls ago if nothing but the Pipeline refers to it any
+     * more, so that a caller that drops each result before the next
+     * call only ever uses two buffers per state, used alternately. A
+     * Buffer the caller keeps is never overwritten. Calls to realize
+     * a Pipeline with state from several threads run one at a
+     * time. */
+    void add_state(Func state, ImageParam previous);
+
+    /** Forget the values of the state outputs, so that the next call
+     * to realize sees zeros. */
+    void reset_state();
+
     /** Get a struct containing the currently set custom functions
      * used by JIT. */
     const Internal::JITHandlers &jit_handlers();
@@ -418,6 +563,33 @@ public:
     void realize(RealizationArg output, const Target &target = Target(),
                  const ParamMap &param_map = ParamMap::empty_map());
 
+    /** Evaluate this Pipeline with a user context and custom handlers
+     * that apply to this call only. Any non-null handlers in the
+     * context override the ones set on the Pipeline, and the
+     * handlers are passed the context, so they can find its
+     * user_context field.
+     *
+     * Once the Pipeline has been compiled (with compile_jit, or by
+     * an earlier call to realize), any number of threads may realize
+     * it at once, with or without a context. Each call uses the
+     * compiled code and handlers as they were when it started, so
+     * recompiling, invalidating the cache, or setting handlers, jit
+     * externs, or custom lowering passes while other threads are
+     * realizing is also safe, although other threads may or may not
+     * see the change. Params that differ
+     * between concurrent calls must be passed in a ParamMap, since
+     * Param::set changes the value seen by every call. */
+    // @{
+    Realization realize(Internal::JITUserContext *context,
+                        std::vector<int32_t> sizes,
+                        const Target &target = Target(),
+                        const ParamMap &param_map = ParamMap::empty_map());
+    void realize(Internal::JITUserContext *context,
+                 RealizationArg output,
+                 const Target &target = Target(),
+                 const ParamMap &param_map = ParamMap::empty_map());
+    // @}
+
     /** For a given size of output, or a given set of output buffers,
      * determine the bounds required of all unbound ImageParams
      * referenced. Communicates the result by allocating new buffers
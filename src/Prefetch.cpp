@@ -60,6 +60,64 @@ public:
     }
 };
 
+// Roughly how many cycles it takes to get data from main memory, and
+// how many simple operations a core retires per cycle. Used to pick
+// the distance for automatic prefetches.
+const int memory_latency_cycles = 200;
+const int ops_per_cycle = 2;
+const int max_auto_prefetch_distance = 32;
+
+// Estimate the number of simple operations in one execution of a
+// stmt. Loops with non-constant extents are assumed to be short.
+class EstimateCost : public IRVisitor {
+    using IRVisitor::visit;
+
+    template<typename T>
+    void visit_op(const T *op, int op_cost) {
+        cost += op_cost;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Add *op) override { visit_op(op, 1); }
+    void visit(const Sub *op) override { visit_op(op, 1); }
+    void visit(const Mul *op) override { visit_op(op, 1); }
+    void visit(const Div *op) override { visit_op(op, op->type.is_float() ? 4 : 8); }
+    void visit(const Mod *op) override { visit_op(op, 8); }
+    void visit(const Min *op) override { visit_op(op, 1); }
+    void visit(const Max *op) override { visit_op(op, 1); }
+    void visit(const Select *op) override { visit_op(op, 1); }
+    void visit(const Cast *op) override { visit_op(op, 1); }
+    void visit(const Provide *op) override { visit_op(op, 1); }
+
+    void visit(const Call *op) override {
+        // Loads from Funcs and images, and extern calls such as
+        // transcendentals.
+        visit_op(op, op->call_type == Call::PureExtern || op->call_type == Call::Extern ? 20 : 1);
+    }
+
+    void visit(const For *op) override {
+        int64_t old_cost = cost;
+        cost = 0;
+        op->body.accept(this);
+        const int64_t *extent = as_const_int(op->extent);
+        cost = old_cost + cost * (extent ? std::max(*extent, (int64_t)1) : 8);
+    }
+
+public:
+    int64_t cost = 0;
+};
+
+// Pick how many iterations ahead to prefetch, so that the data
+// arrives in time for the iteration that uses it.
+Expr auto_prefetch_distance(const Stmt &loop_body) {
+    EstimateCost estimate;
+    loop_body.accept(&estimate);
+    int64_t cost = std::max(estimate.cost, (int64_t)1);
+    int64_t distance = (memory_latency_cycles * ops_per_cycle + cost - 1) / cost;
+    distance = std::min(distance, (int64_t)max_auto_prefetch_distance);
+    return (int)distance;
+}
+
 class InjectPrefetch : public IRMutator2 {
 public:
     InjectPrefetch(const map<string, Function> &e, const map<string, Box> &buffers)
@@ -102,9 +160,20 @@ private:
     Stmt visit(const Prefetch *op) override {
         Stmt body = mutate(op->body);
 
-        const PrefetchDirective &p = op->prefetch;
+        PrefetchDirective p = op->prefetch;
         Expr loop_var = Variable::make(Int(32), p.var);
 
+        const bool is_auto = !p.offset.defined();
+        if (is_auto) {
+            // Only prefetch automatically from buffers that are
+            // allocated outside of this loop.
+            if (!buffer_bounds.contains(p.name) &&
+                external_buffers.find(p.name) == external_buffers.end()) {
+                return body;
+            }
+            p.offset = auto_prefetch_distance(body);
+        }
+
         // Add loop variable + prefetch offset to interval scope for box computation
         Expr fetch_at = loop_var + p.offset;
         map<string, Box> boxes_rw = boxes_touched(LetStmt::make(p.var, fetch_at, body));
@@ -117,6 +186,17 @@ private:
         // that shifts the base address of the prefetched box so that
         // the box is completely within the bounds.
         const auto &b = boxes_rw.find(p.name);
+        if (is_auto && b != boxes_rw.end()) {
+            // Only prefetch strided accesses, i.e. those that move
+            // with the loop variable.
+            bool moves = false;
+            for (const Interval &i : b->second.bounds) {
+                moves = moves || expr_uses_var(i.min, p.var) || expr_uses_var(i.max, p.var);
+            }
+            if (!moves) {
+                return body;
+            }
+        }
         if (b != boxes_rw.end()) {
             Box prefetch_box = b->second;
             // Only prefetch the region that is in bounds.
@@ -149,10 +229,14 @@ private:
                 condition = simplify(prefetch_box.used && condition);
             }
             internal_assert(!new_bounds.empty());
-            return Prefetch::make(op->name, op->types, new_bounds, op->prefetch, condition, std::move(body));
+            return Prefetch::make(op->name, op->types, new_bounds, p, condition, std::move(body));
         }
 
-        if (!body.same_as(op->body)) {
+        if (is_auto) {
+            // The input isn't used in the loop after all (e.g. it was
+            // inlined).
+            return body;
+        } else if (!body.same_as(op->body)) {
             return Prefetch::make(op->name, op->types, op->bounds, op->prefetch, op->condition, std::move(body));
         } else if (op->bounds.empty()) {
             // Remove the Prefetch IR since it is prefetching an empty region
@@ -192,6 +276,48 @@ private:
         }
     }
 
+    // Add placeholder prefetches for every Func and image read by
+    // the loop body, other than the ones already prefetched.
+    Stmt add_auto_prefetches(const string &loop_var, const PrefetchDirective &p,
+                             set<string> &seen, Stmt body) {
+        FindInputs inputs;
+        body.accept(&inputs);
+        for (const auto &i : inputs.calls) {
+            const Call *call = i.second;
+            if (seen.count(i.first) ||
+                starts_with(prefix, i.first + ".")) {
+                // Skip the Func being computed.
+                continue;
+            }
+            seen.insert(i.first);
+            PrefetchDirective q = p;
+            q.name = i.first;
+            q.param = call->param;
+            if (call->call_type == Call::Image && !q.param.defined()) {
+                // An embedded Buffer.
+                q.var = loop_var;
+                body = Prefetch::make(q.name, {call->type}, Region(), q, const_true(), body);
+            } else {
+                body = add_placeholder_prefetch(loop_var, q, body);
+            }
+        }
+        return body;
+    }
+
+    class FindInputs : public IRVisitor {
+        using IRVisitor::visit;
+
+        void visit(const Call *op) override {
+            IRVisitor::visit(op);
+            if (op->call_type == Call::Halide || op->call_type == Call::Image) {
+                calls.emplace(op->name, op);
+            }
+        }
+
+    public:
+        map<string, const Call *> calls;
+    };
+
     Stmt visit(const For *op) override {
         Stmt body = mutate(op->body);
 
@@ -201,13 +327,23 @@ private:
             set<string> seen;
             for (int i = prefetch_list.size() - 1; i >= 0; --i) {
                 const PrefetchDirective &p = prefetch_list[i];
-                if (!ends_with(op->name, "." + p.var) || (seen.find(p.name) != seen.end())) {
+                if (p.name.empty() ||
+                    !ends_with(op->name, "." + p.var) ||
+                    seen.find(p.name) != seen.end()) {
                     continue;
                 }
                 seen.insert(p.name);
 
                 body = add_placeholder_prefetch(op->name, p, body);
             }
+            // Automatic prefetches only cover the inputs that weren't
+            // prefetched explicitly, whichever was scheduled first.
+            for (int i = prefetch_list.size() - 1; i >= 0; --i) {
+                const PrefetchDirective &p = prefetch_list[i];
+                if (p.name.empty() && ends_with(op->name, "." + p.var)) {
+                    body = add_auto_prefetches(op->name, p, seen, body);
+                }
+            }
         }
 
         Stmt stmt;
@@ -110,12 +110,14 @@ void PythonExtensionGen::convert_buffer(string name, const LoweredArgument* arg)
     assert(arg->dimensions);
     dest << "    halide_buffer_t buffer_" << name << ";\n";
     dest << "    halide_dimension_t dimensions_" << name << "[" << (int)arg->dimensions << "];\n";
+    dest << "    Py_buffer view_" << name << ";\n";
     dest << "    if (_convert_py_buffer_to_halide(";
     dest << /*pyobj*/ "py_" << name << ", ";
     dest << /*dimensions*/ (int)arg->dimensions << ", ";
     dest << /*flags*/ (arg->is_output() ? "PyBUF_WRITABLE" : "0") << ", ";
     dest << /*dim*/ "dimensions_" << name << ", ";
     dest << /*out*/ "&buffer_" << name << ", ";
+    dest << /*view*/ "&view_" << name << ", ";
     dest << /*name*/ "\"" << name << "\"";
     dest << ") < 0) {\n";
     dest << "        return NULL;\n";
@@ -145,21 +147,10 @@ void PythonExtensionGen::compile(const Module &module) {
 extern "C" {
 #endif
 
-static __attribute__((unused)) int _convert_py_buffer_to_halide(
-        PyObject* pyobj, int dimensions, int flags,
-        halide_dimension_t* dim,  // array of size `dimensions`
-        halide_buffer_t* out, const char* name) {
-    Py_buffer buf;
-    int ret = PyObject_GetBuffer(
-      pyobj, &buf, PyBUF_FORMAT | PyBUF_STRIDED_RO | PyBUF_ANY_CONTIGUOUS | flags);
-    if (ret < 0) {
-      return ret;
-    }
-    if (dimensions && buf.ndim != dimensions) {
-      PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected %d dimensions, got %d",
-                   name, dimensions, buf.ndim);
-      return -1;
-    }
+/* Convert a Python buffer view to a halide_buffer_t, with `dim` having room
+ * for buf->ndim dimensions. Doesn't release the view. */
+static __attribute__((unused)) int _py_buffer_to_halide(
+        Py_buffer* buf, halide_dimension_t* dim, halide_buffer_t* out, const char* name) {
     /* We'll get a buffer that's either:
      * C_CONTIGUOUS (last dimension varies the fastest, i.e., has stride=1) or
      * F_CONTIGUOUS (first dimension varies the fastest, i.e., has stride=1).
@@ -169,11 +160,11 @@ static __attribute__((unused)) int _convert_py_buffer_to_halide(
      * (transpose) so we can process it without having to reallocate.
      */
     int i, j, j_step;
-    if (PyBuffer_IsContiguous(&buf, 'F')) {
+    if (PyBuffer_IsContiguous(buf, 'F')) {
       j = 0;
       j_step = 1;
-    } else if (PyBuffer_IsContiguous(&buf, 'C')) {
-      j = buf.ndim - 1;
+    } else if (PyBuffer_IsContiguous(buf, 'C')) {
+      j = buf->ndim - 1;
       j_step = -1;
     } else {
       /* Python checks all dimensions and strides, so this typically indicates
@@ -181,31 +172,31 @@ static __attribute__((unused)) int _convert_py_buffer_to_halide(
       PyErr_Format(PyExc_ValueError, "Invalid buffer: neither C nor Fortran contiguous");
       return -1;
     }
-    for (i = 0; i < buf.ndim; ++i, j += j_step) {
+    for (i = 0; i < buf->ndim; ++i, j += j_step) {
         dim[i].min = 0;
-        dim[i].stride = (int)(buf.strides[j] / buf.itemsize); // strides is in bytes
-        dim[i].extent = (int)buf.shape[j];
+        dim[i].stride = (int)(buf->strides[j] / buf->itemsize); // strides is in bytes
+        dim[i].extent = (int)buf->shape[j];
         dim[i].flags = 0;
-        if (buf.suboffsets && buf.suboffsets[i] >= 0) {
+        if (buf->suboffsets && buf->suboffsets[i] >= 0) {
             // Halide doesn't support arrays of pointers. But we should never see this
             // anyway, since we specified PyBUF_STRIDED.
             PyErr_Format(PyExc_ValueError, "Invalid buffer: suboffsets not supported");
             return -1;
         }
     }
-    if (dim[buf.ndim - 1].extent * dim[buf.ndim - 1].stride * buf.itemsize != buf.len) {
+    if (dim[buf->ndim - 1].extent * dim[buf->ndim - 1].stride * buf->itemsize != buf->len) {
         PyErr_Format(PyExc_ValueError, "Invalid buffer: length %ld, but computed length %ld",
-                     buf.len, buf.shape[0] * buf.strides[0]);
+                     buf->len, buf->shape[0] * buf->strides[0]);
         return -1;
     }
     memset(out, 0, sizeof(*out));
-    if (!buf.format) {
+    if (!buf->format) {
         out->type.code = halide_type_uint;
         out->type.bits = 8;
     } else {
         /* Convert struct type code. See
          * https://docs.python.org/2/library/struct.html#module-struct */
-        char* p = buf.format;
+        char* p = buf->format;
         while (strchr("@<>!=", *p)) {
             p++;  // ignore little/bit endian (and alignment)
         }
@@ -221,25 +212,233 @@ static __attribute__((unused)) int _convert_py_buffer_to_halide(
         }
         const char* type_codes = "bB?hHiIlLqQfd";  // integers and floats
         if (strchr(type_codes, *p)) {
-            out->type.bits = buf.itemsize * 8;
+            out->type.bits = buf->itemsize * 8;
         } else {
             // We don't handle 's' and 'p' (char[]) and 'P' (void*)
-            PyErr_Format(PyExc_ValueError, "Invalid data type for %s: %s", name, buf.format);
+            PyErr_Format(PyExc_ValueError, "Invalid data type for %s: %s", name, buf->format);
             return -1;
         }
     }
     out->type.lanes = 1;
-    out->dimensions = buf.ndim;
+    out->dimensions = buf->ndim;
     out->dim = dim;
-    out->host = (uint8_t*)buf.buf;
+    out->host = (uint8_t*)buf->buf;
+    return 0;
+}
+
+static __attribute__((unused)) int _convert_py_buffer_to_halide(
+        PyObject* pyobj, int dimensions, int flags,
+        halide_dimension_t* dim,  // array of size `dimensions`
+        halide_buffer_t* out,
+        Py_buffer* buf,  // must be released by the caller on success
+        const char* name) {
+    int ret = PyObject_GetBuffer(
+      pyobj, buf, PyBUF_FORMAT | PyBUF_STRIDED_RO | PyBUF_ANY_CONTIGUOUS | flags);
+    if (ret < 0) {
+      return ret;
+    }
+    if (dimensions && buf->ndim != dimensions) {
+      PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected %d dimensions, got %d",
+                   name, dimensions, buf->ndim);
+      PyBuffer_Release(buf);
+      return -1;
+    }
+    if (_py_buffer_to_halide(buf, dim, out, name) < 0) {
+      PyBuffer_Release(buf);
+      return -1;
+    }
     return 0;
 }
 
+/* An argument to a batched entry point that is a buffer. It may be given
+ * as a list or tuple with one buffer per item in the batch, as a single
+ * buffer with an extra outermost dimension indexing the items (a "stack"),
+ * or, for inputs, as a single buffer shared by every item. */
+typedef struct {
+    PyObject* obj;
+    int dimensions;
+    int flags;
+    int is_list;
+    int is_stacked;
+    Py_buffer* views;
+    Py_ssize_t num_views;
+    halide_dimension_t* whole_dim; // `dimensions` + 1, for a stack
+    halide_buffer_t whole;
+    halide_buffer_t* buffers;      // one per item
+    halide_dimension_t* dims;      // `dimensions` per item
+} _batched_buffer;
+
+static __attribute__((unused)) int _check_batch_size(Py_ssize_t* n, Py_ssize_t size, const char* name) {
+    if (*n >= 0 && *n != size) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected a batch of %d items, got %d",
+                     name, (int)*n, (int)size);
+        return -1;
+    }
+    *n = size;
+    return 0;
+}
+
+static __attribute__((unused)) int _batched_buffer_init(
+        _batched_buffer* b, PyObject* pyobj, int dimensions, int flags,
+        Py_ssize_t* n, const char* name) {
+    memset(b, 0, sizeof(*b));
+    b->obj = pyobj;
+    b->dimensions = dimensions;
+    b->flags = flags;
+    if (PyList_Check(pyobj) || PyTuple_Check(pyobj)) {
+        b->is_list = 1;
+        return _check_batch_size(n, PySequence_Size(pyobj), name);
+    }
+    b->views = (Py_buffer*)calloc(1, sizeof(Py_buffer));
+    if (!b->views) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (PyObject_GetBuffer(pyobj, &b->views[0],
+                           PyBUF_FORMAT | PyBUF_STRIDED_RO | PyBUF_ANY_CONTIGUOUS | flags) < 0) {
+        return -1;
+    }
+    b->num_views = 1;
+    if (b->views[0].ndim != dimensions && b->views[0].ndim != dimensions + 1) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected %d dimensions (or %d for a stack), got %d",
+                     name, dimensions, dimensions + 1, b->views[0].ndim);
+        return -1;
+    }
+    b->whole_dim = (halide_dimension_t*)calloc(dimensions + 1, sizeof(halide_dimension_t));
+    if (!b->whole_dim) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (_py_buffer_to_halide(&b->views[0], b->whole_dim, &b->whole, name) < 0) {
+        return -1;
+    }
+    if (b->views[0].ndim == dimensions + 1) {
+        b->is_stacked = 1;
+        return _check_batch_size(n, b->whole_dim[dimensions].extent, name);
+    }
+    return 0;
+}
+
+static __attribute__((unused)) int _batched_buffer_fill(
+        _batched_buffer* b, Py_ssize_t n, int is_output, const char* name) {
+    Py_ssize_t i;
+    int d;
+    b->buffers = (halide_buffer_t*)calloc(n + 1, sizeof(halide_buffer_t));
+    b->dims = (halide_dimension_t*)calloc((n + 1) * (b->dimensions + 1), sizeof(halide_dimension_t));
+    if (!b->buffers || !b->dims) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (b->is_list) {
+        b->views = (Py_buffer*)calloc(n + 1, sizeof(Py_buffer));
+        if (!b->views) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        for (i = 0; i < n; i++) {
+            PyObject* item = PySequence_GetItem(b->obj, i);
+            int ret;
+            if (!item) {
+                return -1;
+            }
+            ret = _convert_py_buffer_to_halide(item, b->dimensions, b->flags,
+                                               b->dims + i * b->dimensions, &b->buffers[i],
+                                               &b->views[i], name);
+            Py_DECREF(item);
+            if (ret < 0) {
+                return -1;
+            }
+            b->num_views++;
+        }
+        return 0;
+    }
+    if (is_output && !b->is_stacked && n > 1) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: Outputs can't be shared by the items in a batch",
+                     name);
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        b->buffers[i] = b->whole;
+        b->buffers[i].dimensions = b->dimensions;
+        b->buffers[i].dim = b->dims + i * b->dimensions;
+        for (d = 0; d < b->dimensions; d++) {
+            b->buffers[i].dim[d] = b->whole_dim[d];
+        }
+        if (b->is_stacked) {
+            b->buffers[i].host += (int64_t)i * b->whole_dim[b->dimensions].stride * ((b->whole.type.bits + 7) / 8);
+        }
+    }
+    return 0;
+}
+
+static __attribute__((unused)) void _batched_buffer_release(_batched_buffer* b) {
+    Py_ssize_t i;
+    for (i = 0; i < b->num_views; i++) {
+        PyBuffer_Release(&b->views[i]);
+    }
+    free(b->views);
+    free(b->whole_dim);
+    free(b->buffers);
+    free(b->dims);
+}
+
+/* Parse a scalar argument to a batched entry point, given either as a list
+ * or tuple with one value per item, or as one value shared by every item. */
+static __attribute__((unused)) int _batched_scalar_size(
+        PyObject* pyobj, Py_ssize_t* n, const char* name) {
+    if (PyList_Check(pyobj) || PyTuple_Check(pyobj)) {
+        return _check_batch_size(n, PySequence_Size(pyobj), name);
+    }
+    return 0;
+}
+
+static __attribute__((unused)) int _batched_scalar_fill(
+        PyObject* pyobj, const char* format, size_t size, Py_ssize_t n, void* values) {
+    Py_ssize_t i;
+    if (PyList_Check(pyobj) || PyTuple_Check(pyobj)) {
+        for (i = 0; i < n; i++) {
+            /* Lists and tuples keep their items alive, so this is safe for
+             * borrowed PyObject* values too. */
+            PyObject* item = PySequence_GetItem(pyobj, i);
+            int ok;
+            if (!item) {
+                return -1;
+            }
+            ok = PyArg_Parse(item, format, (char*)values + i * size);
+            Py_DECREF(item);
+            if (!ok) {
+                return -1;
+            }
+        }
+    } else {
+        if (!PyArg_Parse(pyobj, format, values)) {
+            return -1;
+        }
+        for (i = 1; i < n; i++) {
+            memcpy((char*)values + i * size, values, size);
+        }
+    }
+    return 0;
+}
+
+static __attribute__((unused)) PyObject* _batched_result(const int* results, Py_ssize_t n) {
+    Py_ssize_t i;
+    for (i = 0; i < n; i++) {
+        if (results[i] != 0) {
+            PyErr_Format(PyExc_ValueError, "Halide error %d in batch item %d", results[i], (int)i);
+            return NULL;
+        }
+    }
+    Py_INCREF(Py_True);
+    return Py_True;
+}
+
 )INLINE_CODE";
 
     for (auto &f : module.functions()) {
-        if (!has_legacy_buffers(f)) {
+        if (f.linkage != LinkageType::Internal && !has_legacy_buffers(f)) {
             compile(f);
+            compile_batch(f);
         }
     }
 
@@ -247,11 +446,14 @@ static __attribute__((unused)) int _convert_py_buffer_to_halide(
     dest << "static PyMethodDef _methods[] = {\n";
     for (auto &f : module.functions()) {
         /* With the legacy_buffer_wrappers feature, Halide stores every function
-         * twice, once with new and once with old buffers. Ignore the latter. */
-        if (!has_legacy_buffers(f)) {
+         * twice, once with new and once with old buffers. Ignore the latter,
+         * and functions that aren't visible outside the module. */
+        if (f.linkage != LinkageType::Internal && !has_legacy_buffers(f)) {
             const string basename = remove_namespaces(f.name);
             dest << "    {\"" << basename << "\", (PyCFunction)_f_" << basename
                  << ", METH_VARARGS|METH_KEYWORDS, NULL},\n";
+            dest << "    {\"" << basename << "_batch\", (PyCFunction)_f_" << basename
+                 << "_batch, METH_VARARGS|METH_KEYWORDS, NULL},\n";
         }
     }
     dest << "    {0, 0, 0, NULL},  // sentinel\n";
@@ -343,9 +545,13 @@ void PythonExtensionGen::compile(const LoweredFunc &f) {
             dest << "py_" << arg_names[i];
         }
     }
-    dest << ");";
-    dest << R"INLINE_CODE(
-    if (result != 0) {
+    dest << ");\n";
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].is_buffer()) {
+            dest << "    PyBuffer_Release(&view_" << arg_names[i] << ");\n";
+        }
+    }
+    dest << R"INLINE_CODE(    if (result != 0) {
         /* In the optimal case, we'd be generating an exception declared
          * in python_bindings/src, but since we're self-contained,
          * we don't have access to that API. */
@@ -358,5 +564,158 @@ void PythonExtensionGen::compile(const LoweredFunc &f) {
     dest << "}\n";
 }
 
+void PythonExtensionGen::compile_batch(const LoweredFunc &f) {
+    const std::vector<LoweredArgument> &args = f.args;
+    const string basename = remove_namespaces(f.name);
+    std::vector<string> arg_names(args.size());
+    for (size_t i = 0; i < args.size(); i++) {
+        arg_names[i] = sanitize_name(args[i].name);
+    }
+
+    // The arguments for each item of the batch, and the task that runs
+    // one item, for halide_do_par_for.
+    for (size_t i = 0; i < args.size(); i++) {
+        if (!can_convert(&args[i])) {
+            dest << "// " << f.name << " (batched)\n";
+            dest << "static PyObject* _f_" << basename << "_batch(PyObject* module, PyObject* args, PyObject* kwargs) {\n";
+            dest << "    PyErr_Format(PyExc_NotImplementedError, "
+                 << "\"Can't convert argument " << args[i].name << " from Python\");\n";
+            dest << "    return NULL;\n";
+            dest << "}\n";
+            return;
+        }
+    }
+    dest << "struct _batch_closure_" << basename << " {\n";
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].is_buffer()) {
+            dest << "    halide_buffer_t* " << arg_names[i] << ";\n";
+        } else {
+            dest << "    " << print_type(&args[i]).second << "* " << arg_names[i] << ";\n";
+        }
+    }
+    dest << "    int* results;\n";
+    dest << "};\n\n";
+
+    dest << "static int _batch_task_" << basename << "(void* user_context, int i, uint8_t* closure) {\n";
+    dest << "    struct _batch_closure_" << basename << "* c = (struct _batch_closure_" << basename << "*)closure;\n";
+    dest << "    c->results[i] = " << f.name << "(";
+    for (size_t i = 0; i < args.size(); i++) {
+        if (i > 0) {
+            dest << ", ";
+        }
+        if (args[i].is_buffer()) {
+            dest << "&c->" << arg_names[i] << "[i]";
+        } else {
+            dest << "c->" << arg_names[i] << "[i]";
+        }
+    }
+    dest << ");\n";
+    dest << "    return 0;\n";
+    dest << "}\n\n";
+
+    // The entry point parses all of the arguments, then runs every item of
+    // the batch on the Halide thread pool with the GIL released.
+    dest << "// " << f.name << " (batched)\n";
+    dest << "static PyObject* _f_" << basename << "_batch(PyObject* module, PyObject* args, PyObject* kwargs) {\n";
+    dest << "    static const char* kwlist[] = {";
+    for (size_t i = 0; i < args.size(); i++) {
+        dest << "\"" << arg_names[i] << "\", ";
+    }
+    dest << "NULL};\n";
+    for (size_t i = 0; i < args.size(); i++) {
+        dest << "    PyObject* py_" << arg_names[i] << ";\n";
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].is_buffer()) {
+            dest << "    _batched_buffer buffer_" << arg_names[i] << ";\n";
+        } else {
+            dest << "    " << print_type(&args[i]).second << "* values_" << arg_names[i] << " = NULL;\n";
+        }
+    }
+    dest << "    struct _batch_closure_" << basename << " closure;\n";
+    dest << "    int* results = NULL;\n";
+    dest << "    PyObject* ret = NULL;\n";
+    dest << "    Py_ssize_t n = -1;\n";
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].is_buffer()) {
+            dest << "    memset(&buffer_" << arg_names[i] << ", 0, sizeof(_batched_buffer));\n";
+        }
+    }
+    dest << "    if (!PyArg_ParseTupleAndKeywords(args, kwargs, \"";
+    for (size_t i = 0; i < args.size(); i++) {
+        dest << "O";
+    }
+    dest << "\", (char**)kwlist";
+    for (size_t i = 0; i < args.size(); i++) {
+        dest << ", &py_" << arg_names[i];
+    }
+    dest << ")) {\n";
+    dest << "        return NULL;\n";
+    dest << "    }\n";
+
+    // Find the size of the batch.
+    for (size_t i = 0; i < args.size(); i++) {
+        const string &name = arg_names[i];
+        if (args[i].is_buffer()) {
+            dest << "    if (_batched_buffer_init(&buffer_" << name << ", py_" << name << ", "
+                 << (int)args[i].dimensions << ", "
+                 << (args[i].is_output() ? "PyBUF_WRITABLE" : "0") << ", &n, \"" << name << "\") < 0) {\n";
+        } else {
+            dest << "    if (_batched_scalar_size(py_" << name << ", &n, \"" << name << "\") < 0) {\n";
+        }
+        dest << "        goto done;\n";
+        dest << "    }\n";
+    }
+    dest << "    if (n < 0) {\n";
+    dest << "        n = 1;\n";
+    dest << "    }\n";
+
+    // Unpack the arguments for each item.
+    for (size_t i = 0; i < args.size(); i++) {
+        const string &name = arg_names[i];
+        if (args[i].is_buffer()) {
+            dest << "    if (_batched_buffer_fill(&buffer_" << name << ", n, "
+                 << (args[i].is_output() ? 1 : 0) << ", \"" << name << "\") < 0) {\n";
+            dest << "        goto done;\n";
+            dest << "    }\n";
+            dest << "    closure." << name << " = buffer_" << name << ".buffers;\n";
+        } else {
+            const auto type = print_type(&args[i]);
+            dest << "    values_" << name << " = (" << type.second << "*)calloc(n + 1, sizeof(" << type.second << "));\n";
+            dest << "    if (!values_" << name << ") {\n";
+            dest << "        PyErr_NoMemory();\n";
+            dest << "        goto done;\n";
+            dest << "    }\n";
+            dest << "    if (_batched_scalar_fill(py_" << name << ", \"" << type.first << "\", sizeof("
+                 << type.second << "), n, values_" << name << ") < 0) {\n";
+            dest << "        goto done;\n";
+            dest << "    }\n";
+            dest << "    closure." << name << " = values_" << name << ";\n";
+        }
+    }
+    dest << "    results = (int*)calloc(n + 1, sizeof(int));\n";
+    dest << "    if (!results) {\n";
+    dest << "        PyErr_NoMemory();\n";
+    dest << "        goto done;\n";
+    dest << "    }\n";
+    dest << "    closure.results = results;\n";
+    dest << R"INLINE_CODE(    Py_BEGIN_ALLOW_THREADS
+    halide_do_par_for(NULL, _batch_task_)INLINE_CODE" << basename << R"INLINE_CODE(, 0, (int)n, (uint8_t*)&closure);
+    Py_END_ALLOW_THREADS
+    ret = _batched_result(results, n);
+done:
+)INLINE_CODE";
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].is_buffer()) {
+            dest << "    _batched_buffer_release(&buffer_" << arg_names[i] << ");\n";
+        } else {
+            dest << "    free(values_" << arg_names[i] << ");\n";
+        }
+    }
+    dest << "    free(results);\n";
+    dest << "    return ret;\n";
+    dest << "}\n";
+}
+
 }
 }
@@ -18,6 +18,11 @@ public:
 
     void compile(const Module &module);
     void compile(const LoweredFunc &f);
+
+    /** Emit <name>_batch, which takes a list (or, for buffers, a stack)
+     * of values for each argument, and runs the items of the batch in
+     * parallel on the Halide thread pool with the GIL released. */
+    void compile_batch(const LoweredFunc &f);
 private:
     void convert_buffer(std::string name, const LoweredArgument* arg);
     std::ostream &dest;
@@ -209,6 +209,11 @@ class ExprCost : public IRVisitor {
         arith += 1;
     }
 
+    void visit(const VectorReduce *op) override {
+        op->value.accept(this);
+        arith += op->value.type().lanes() - 1;
+    }
+
     void visit(const Let *let) override {
         let->value.accept(this);
         let->body.accept(this);
@@ -51,6 +51,10 @@ class RemoveDeadAllocations : public IRMutator2 {
     }
 
     Stmt visit(const Allocate *op) override {
+        if (op->new_expr.defined()) {
+            // The new_expr may refer to another allocation.
+            mutate(op->new_expr);
+        }
         allocs.push(op->name, 1);
         Stmt body = mutate(op->body);
 
@@ -213,11 +213,12 @@ struct FuncScheduleContents {
     std::vector<Bound> estimates;
     std::map<std::string, Internal::FunctionPtr> wrappers;
     MemoryType memory_type;
-    bool memoized, async;
+    bool memoized, async, auto_fuse;
 
     FuncScheduleContents() :
         store_level(LoopLevel::inlined()), compute_level(LoopLevel::inlined()),
-        memory_type(MemoryType::Auto), memoized(false), async(false) {};
+        memory_type(MemoryType::Auto), memoized(false), async(false),
+        auto_fuse(false) {};
 
     // Pass an IRMutator2 through to all Exprs referenced in the FuncScheduleContents
     void mutate(IRMutator2 *mutator) {
@@ -329,6 +330,7 @@ FuncSchedule FuncSchedule::deep_copy(
     copy.contents->memory_type = contents->memory_type;
     copy.contents->memoized = contents->memoized;
     copy.contents->async = contents->async;
+    copy.contents->auto_fuse = contents->auto_fuse;
 
     // Deep-copy wrapper functions.
     for (const auto &iter : contents->wrappers) {
@@ -364,6 +366,14 @@ bool FuncSchedule::async() const {
     return contents->async;
 }
 
+bool &FuncSchedule::auto_fuse() {
+    return contents->auto_fuse;
+}
+
+bool FuncSchedule::auto_fuse() const {
+    return contents->auto_fuse;
+}
+
 std::vector<StorageDim> &FuncSchedule::storage_dims() {
     return contents->storage_dims;
 }
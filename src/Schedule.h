@@ -352,8 +352,12 @@ struct FusedPair {
 };
 
 struct PrefetchDirective {
+    // The Func or image to prefetch. Empty if every input of the loop
+    // should be prefetched (see Func::auto_prefetch).
     std::string name;
     std::string var;
+    // The prefetch distance in iterations of the loop over var. If
+    // undefined, it is chosen during lowering.
     Expr offset;
     PrefetchBoundStrategy strategy;
     // If it's a prefetch load from an image parameter, this points to that.
@@ -397,6 +401,13 @@ public:
     bool &async();
     bool async() const;
 
+    /** May this Function be fused with independent siblings that
+     * read the same input (see \ref Func::auto_fuse) */
+    // @{
+    bool &auto_fuse();
+    bool auto_fuse() const;
+    // @}
+
     /** The list and order of dimensions used to store this
      * function. The first dimension in the vector corresponds to the
      * innermost dimension for storage (i.e. which dimension is
@@ -151,8 +151,66 @@ vector<Definition> propagate_specialization_in_definition(Definition &def, const
     return result;
 }
 
+void get_conditions_in_definition(const Definition &def, vector<Expr> &conditions) {
+    for (const Specialization &s : def.specializations()) {
+        if (!is_const(s.condition)) {
+            bool seen = false;
+            for (const Expr &c : conditions) {
+                seen = seen || equal(c, s.condition);
+            }
+            if (!seen) {
+                conditions.push_back(s.condition);
+            }
+        }
+        get_conditions_in_definition(s.definition, conditions);
+    }
+}
+
+void fix_conditions_in_definition(Definition &def,
+                                  const vector<Expr> &conditions,
+                                  const vector<bool> &values) {
+    for (Specialization &s : def.specializations()) {
+        for (size_t i = 0; i < conditions.size(); i++) {
+            if (equal(conditions[i], s.condition)) {
+                s.condition = values[i] ? const_true() : const_false();
+                break;
+            }
+        }
+        fix_conditions_in_definition(s.definition, conditions, values);
+    }
+}
+
 }  // namespace
 
+vector<Expr> get_specialization_conditions(const map<string, Function> &env) {
+    vector<Expr> conditions;
+    for (const auto &iter : env) {
+        const Function &func = iter.second;
+        if (func.definition().defined()) {
+            get_conditions_in_definition(func.definition(), conditions);
+        }
+        for (const Definition &def : func.updates()) {
+            get_conditions_in_definition(def, conditions);
+        }
+    }
+    return conditions;
+}
+
+void fix_specialization_conditions(map<string, Function> &env,
+                                   const vector<Expr> &conditions,
+                                   const vector<bool> &values) {
+    internal_assert(conditions.size() == values.size());
+    for (auto &iter : env) {
+        Function &func = iter.second;
+        if (func.definition().defined()) {
+            fix_conditions_in_definition(func.definition(), conditions, values);
+        }
+        for (size_t i = 0; i < func.updates().size(); i++) {
+            fix_conditions_in_definition(func.update(i), conditions, values);
+        }
+    }
+}
+
 void simplify_specializations(map<string, Function> &env) {
     for (auto &iter : env) {
         Function &func = iter.second;
@@ -18,6 +18,18 @@ namespace Internal {
  * specializations. */
 void simplify_specializations(std::map<std::string, Function> &env);
 
+/** Get the distinct non-constant specialization conditions of all
+ * the Funcs in env, including those of nested specializations. */
+std::vector<Expr> get_specialization_conditions(const std::map<std::string, Function> &env);
+
+/** Replace the condition of every specialization of the Funcs in env
+ * that is equal to conditions[i] with the constant values[i], so that
+ * simplify_specializations prunes the branches that can't be
+ * taken. */
+void fix_specialization_conditions(std::map<std::string, Function> &env,
+                                   const std::vector<Expr> &conditions,
+                                   const std::vector<bool> &values);
+
 }  // namespace Internal
 }  // namespace Halide
 
@@ -39,6 +39,62 @@ Expr Simplify::visit(const Broadcast *op, ConstBounds *bounds) {
     }
 }
 
+Expr Simplify::visit(const VectorReduce *op, ConstBounds *bounds) {
+    ConstBounds value_bounds;
+    Expr value = mutate(op->value, &value_bounds);
+
+    const int lanes = op->type.lanes();
+    const int factor = op->value.type().lanes() / lanes;
+    if (factor == 1) {
+        if (bounds) {
+            *bounds = value_bounds;
+        }
+        return value;
+    }
+
+    if (bounds && no_overflow_int(op->type)) {
+        switch (op->op) {
+        case VectorReduce::Add:
+            *bounds = value_bounds;
+            bounds->min *= factor;
+            bounds->max *= factor;
+            break;
+        case VectorReduce::Min:
+        case VectorReduce::Max:
+            *bounds = value_bounds;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // A reduction of a broadcast doesn't need to look at the lanes
+    // individually.
+    if (const Broadcast *b = value.as<Broadcast>()) {
+        Expr v = b->value;
+        switch (op->op) {
+        case VectorReduce::Add:
+            v = mutate(v * make_const(v.type(), factor), nullptr);
+            break;
+        case VectorReduce::Mul:
+            v = Expr();
+            break;
+        default:
+            // Min, Max, And, and Or are all idempotent.
+            break;
+        }
+        if (v.defined()) {
+            return lanes == 1 ? v : Broadcast::make(v, lanes);
+        }
+    }
+
+    if (value.same_as(op->value)) {
+        return op;
+    } else {
+        return VectorReduce::make(op->op, value, lanes);
+    }
+}
+
 Expr Simplify::visit(const Variable *op, ConstBounds *bounds) {
     if (bounds_info.contains(op->name)) {
         const ConstBounds &b = bounds_info.get(op->name);
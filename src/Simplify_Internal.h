@@ -233,6 +233,7 @@ public:
     Expr visit(const Load *op, ConstBounds *bounds);
     Expr visit(const Call *op, ConstBounds *bounds);
     Expr visit(const Shuffle *op, ConstBounds *bounds);
+    Expr visit(const VectorReduce *op, ConstBounds *bounds);
     Expr visit(const Let *op, ConstBounds *bounds);
     Stmt visit(const LetStmt *op);
     Stmt visit(const AssertStmt *op);
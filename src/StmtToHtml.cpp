@@ -653,6 +653,16 @@ private:
         stream << close_span();
     }
 
+    void visit(const VectorReduce *op) override {
+        stream << open_span("VectorReduce");
+        stream << open_span("Type") << op->type << close_span();
+        stream << symbol("vector_reduce") << matched("(");
+        stream << op->op << matched(",") << " ";
+        print(op->value);
+        stream << matched(")");
+        stream << close_span();
+    }
+
 public:
     void print(Expr ir) {
         ir.accept(this);
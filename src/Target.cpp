@@ -10,7 +10,7 @@
 #include "Util.h"
 #include "DeviceInterface.h"
 
-#if defined(__powerpc__) && defined(__linux__)
+#if (defined(__powerpc__) || defined(__aarch64__)) && defined(__linux__)
 // This uses elf.h and must be included after "LLVM_Headers.h", which
 // uses llvm/support/Elf.h.
 #include <sys/auxv.h>
@@ -79,6 +79,16 @@ Target calculate_host_target() {
 #else
 #if defined(__arm__) || defined(__aarch64__)
     Target::Arch arch = Target::ARM;
+
+#if defined(__aarch64__) && defined(__linux__)
+    // The ARMv8.2 extensions are reported in the ELF hwcaps.
+    const unsigned long fphp = 1 << 9;
+    const unsigned long asimdhp = 1 << 10;
+    const unsigned long asimddp = 1 << 20;
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    if (hwcap & asimddp) initial_features.push_back(Target::ARMDotProd);
+    if ((hwcap & fphp) && (hwcap & asimdhp)) initial_features.push_back(Target::ARMFp16);
+#endif
 #else
 #if defined(__powerpc__) && defined(__linux__)
     Target::Arch arch = Target::POWERPC;
@@ -139,6 +149,8 @@ Target calculate_host_target() {
         const uint32_t avx512_knl = avx512 | avx512pf | avx512er;
         const uint32_t avx512_skylake = avx512 | avx512vl | avx512bw | avx512dq;
         const uint32_t avx512_cannonlake = avx512_skylake | avx512ifma; // Assume ifma => vbmi
+        const uint32_t avx512vnni = 1U << 11; // In ecx, not ebx
+        const uint32_t avx512bf16 = 1U << 5;  // In eax, with cpuid(eax=7, ecx=1)
         if ((info2[1] & avx2) == avx2) {
             initial_features.push_back(Target::AVX2);
         }
@@ -153,6 +165,15 @@ Target calculate_host_target() {
             if ((info2[1] & avx512_cannonlake) == avx512_cannonlake) {
                 initial_features.push_back(Target::AVX512_Cannonlake);
             }
+            if ((info2[1] & avx512_skylake) == avx512_skylake &&
+                (info2[2] & avx512vnni) == avx512vnni) {
+                initial_features.push_back(Target::AVX512_Cascadelake);
+                int info3[4];
+                cpuid(info3, 7, 1);
+                if ((info3[0] & avx512bf16) == avx512bf16) {
+                    initial_features.push_back(Target::AVX512_Cooperlake);
+                }
+            }
         }
     }
 #ifdef _WIN32
@@ -295,6 +316,14 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"avx512_knl", Target::AVX512_KNL},
     {"avx512_skylake", Target::AVX512_Skylake},
     {"avx512_cannonlake", Target::AVX512_Cannonlake},
+    {"avx512_cascadelake", Target::AVX512_Cascadelake},
+    {"avx512_cooperlake", Target::AVX512_Cooperlake},
+    {"arm_dot_prod", Target::ARMDotProd},
+    {"arm_fp16", Target::ARMFp16},
+    {"arena_allocations", Target::ArenaAllocations},
+    {"memory_budget", Target::MemoryBudget},
+    {"multiversion_loops", Target::MultiversionLoops},
+    {"relaxed_float16", Target::RelaxedFloat16},
     {"trace_loads", Target::TraceLoads},
     {"trace_stores", Target::TraceStores},
     {"trace_realizations", Target::TraceRealizations},
@@ -723,13 +752,17 @@ int Target::natural_vector_size(const Halide::Type &t) const {
         }
     } else if (arch == Target::X86) {
         if (is_integer && (has_feature(Halide::Target::AVX512_Skylake) ||
-                           has_feature(Halide::Target::AVX512_Cannonlake))) {
-            // AVX512BW exists on Skylake and Cannonlake
+                           has_feature(Halide::Target::AVX512_Cannonlake) ||
+                           has_feature(Halide::Target::AVX512_Cascadelake) ||
+                           has_feature(Halide::Target::AVX512_Cooperlake))) {
+            // AVX512BW exists on Skylake and everything after it
             return 64 / data_size;
         } else if (t.is_float() && (has_feature(Halide::Target::AVX512) ||
                                     has_feature(Halide::Target::AVX512_KNL) ||
                                     has_feature(Halide::Target::AVX512_Skylake) ||
-                                    has_feature(Halide::Target::AVX512_Cannonlake))) {
+                                    has_feature(Halide::Target::AVX512_Cannonlake) ||
+                                    has_feature(Halide::Target::AVX512_Cascadelake) ||
+                                    has_feature(Halide::Target::AVX512_Cooperlake))) {
             // AVX512F is on all AVX512 architectures
             return 64 / data_size;
         } else if (has_feature(Halide::Target::AVX2)) {
@@ -91,6 +91,14 @@ struct Target {
         AVX512_KNL = halide_target_feature_avx512_knl,
         AVX512_Skylake = halide_target_feature_avx512_skylake,
         AVX512_Cannonlake = halide_target_feature_avx512_cannonlake,
+        AVX512_Cascadelake = halide_target_feature_avx512_cascadelake,
+        AVX512_Cooperlake = halide_target_feature_avx512_cooperlake,
+        ARMDotProd = halide_target_feature_arm_dot_prod,
+        ARMFp16 = halide_target_feature_arm_fp16,
+        ArenaAllocations = halide_target_feature_arena_allocations,
+        MemoryBudget = halide_target_feature_memory_budget,
+        MultiversionLoops = halide_target_feature_multiversion_loops,
+        RelaxedFloat16 = halide_target_feature_relaxed_float16,
         TraceLoads = halide_target_feature_trace_loads,
         TraceStores = halide_target_feature_trace_stores,
         TraceRealizations = halide_target_feature_trace_realizations,
@@ -279,6 +279,14 @@ void dir_rmdir(const std::string &name) {
     #endif
 }
 
+bool dir_make(const std::string &name) {
+    #ifdef _WIN32
+    return CreateDirectoryA(name.c_str(), nullptr) != 0;
+    #else
+    return ::mkdir(name.c_str(), 0777) == 0;
+    #endif
+}
+
 FileStat file_stat(const std::string &name) {
     #ifdef _MSC_VER
     struct _stat a;
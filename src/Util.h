@@ -259,6 +259,11 @@ void ensure_no_file_exists(const std::string &name);
 /** Wrapper for rmdir(). Asserts upon error. */
 void dir_rmdir(const std::string &name);
 
+/** Wrapper for mkdir(). Returns true if the directory was created,
+ * and false otherwise, including if it already exists. Does not
+ * assert upon error. */
+bool dir_make(const std::string &name);
+
 /** Wrapper for stat(). Asserts upon error. */
 FileStat file_stat(const std::string &name);
 
@@ -683,6 +683,28 @@ class VectorSubs : public IRMutator2 {
         }
     }
 
+    // Match a binary operator with a broadcast load from the given
+    // buffer and index on one side. If it does, reduce the other side
+    // to a scalar and combine it with the load instead.
+    template<typename T>
+    Expr reduce_into_load(const T *op, VectorReduce::Operator reduce_op,
+                          const string &name, const Expr &index) {
+        if (!op) {
+            return Expr();
+        }
+        Expr self[2] = {op->a, op->b};
+        Expr other[2] = {op->b, op->a};
+        for (int i = 0; i < 2; i++) {
+            const Broadcast *b = self[i].as<Broadcast>();
+            const Load *load = b ? b->value.as<Load>() : nullptr;
+            if (load && load->name == name && equal(load->index, index) &&
+                other[i].type().is_vector()) {
+                return T::make(load, VectorReduce::make(reduce_op, other[i], 1));
+            }
+        }
+        return Expr();
+    }
+
     Stmt visit(const Store *op) override {
         Expr predicate = mutate(op->predicate);
         Expr value = mutate(op->value);
@@ -690,11 +712,31 @@ class VectorSubs : public IRMutator2 {
 
         if (predicate.same_as(op->predicate) && value.same_as(op->value) && index.same_as(op->index)) {
             return op;
-        } else {
-            int lanes = std::max(predicate.type().lanes(), std::max(value.type().lanes(), index.type().lanes()));
-            return Store::make(op->name, widen(value, lanes), widen(index, lanes),
-                               op->param, widen(predicate, lanes));
         }
+
+        if (index.type().is_scalar() && predicate.type().is_scalar() && value.type().is_vector()) {
+            // Every lane is being stored to the same place. If this is
+            // an update of that place (e.g. a reduction over a
+            // vectorized RVar), do a horizontal reduction of the
+            // vector first. Otherwise the last lane wins.
+            Expr reduced = reduce_into_load(value.as<Add>(), VectorReduce::Add, op->name, index);
+            if (!reduced.defined()) {
+                reduced = reduce_into_load(value.as<Mul>(), VectorReduce::Mul, op->name, index);
+            }
+            if (!reduced.defined()) {
+                reduced = reduce_into_load(value.as<Min>(), VectorReduce::Min, op->name, index);
+            }
+            if (!reduced.defined()) {
+                reduced = reduce_into_load(value.as<Max>(), VectorReduce::Max, op->name, index);
+            }
+            if (reduced.defined()) {
+                return Store::make(op->name, reduced, index, op->param, predicate);
+            }
+        }
+
+        int lanes = std::max(predicate.type().lanes(), std::max(value.type().lanes(), index.type().lanes()));
+        return Store::make(op->name, widen(value, lanes), widen(index, lanes),
+                           op->param, widen(predicate, lanes));
     }
 
     Stmt visit(const AssertStmt *op) override {
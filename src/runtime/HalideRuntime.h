@@ -137,6 +137,41 @@ extern void halide_shutdown_thread_pool();
 typedef int (*halide_do_par_for_t)(void *, halide_task_t, int, int, uint8_t*);
 extern halide_do_par_for_t halide_set_custom_do_par_for(halide_do_par_for_t do_par_for);
 
+/** A function that runs one stage of a stream of frames on the given
+ * frame, typically by calling an AOT-compiled pipeline on that
+ * frame's buffers. Should return zero on success. */
+typedef int (*halide_frame_t)(void *user_context, int frame, uint8_t *closure);
+
+/** A stage of the software pipeline run by halide_do_frames. */
+struct halide_frame_stage_t {
+    /** The function to call for each frame, and the closure to pass it. */
+    halide_frame_t fn;
+    uint8_t *closure;
+
+    /** The indices of the earlier stages whose results for a frame
+     * this stage reads. */
+    const int *producers;
+    int num_producers;
+};
+
+/** Run num_frames frames through a sequence of num_stages stages as
+ * a software pipeline on the thread pool. Stage k of frame n starts
+ * once stage k has finished frame n - 1, and the producers of stage k
+ * have finished frame n, so later stages of one frame overlap earlier
+ * stages of the next. Each stage runs its frames in order, one at a
+ * time, and the parallel loops of the pipelines it calls share the
+ * thread pool with the other stages. At most max_in_flight frames are
+ * in flight at once: no stage starts frame n until every stage has
+ * finished frame n - max_in_flight. Stages must be listed after their
+ * producers. If a stage returns a non-zero value on a frame, no
+ * frame that needs its slot starts and the stages that depend on it
+ * do not run on it, though stages of other frames in flight may
+ * still run. The first such value is returned once the stages
+ * already running finish. Otherwise returns zero. */
+extern int halide_do_frames(void *user_context, int num_stages,
+                            const struct halide_frame_stage_t *stages,
+                            int num_frames, int max_in_flight);
+
 /** An opaque struct representing a semaphore. Used by the task system for async tasks. */
 struct halide_semaphore_t {
     uint64_t _private[2];
@@ -309,6 +344,44 @@ extern void halide_join_thread(struct halide_thread *);
  */
 extern int halide_set_num_threads(int n);
 
+/** Ways the default thread pool can place its worker threads on the
+ * cpus of the machine. */
+typedef enum halide_thread_affinity_t {
+    /** Let the OS move worker threads freely. */
+    halide_thread_affinity_none = 0,
+
+    /** Pin each worker to its own cpu, filling up the cpus of one
+     * NUMA node before moving on to the next. Best when the pool has
+     * fewer threads than a node has cpus. */
+    halide_thread_affinity_compact = 1,
+
+    /** Pin each worker to its own cpu, spreading consecutive workers
+     * across the NUMA nodes, so that each node has its own group of
+     * workers and memory bandwidth is shared evenly between them. */
+    halide_thread_affinity_scatter = 2,
+} halide_thread_affinity_t;
+
+/** Set how the default thread pool places its worker threads, and
+ * return the old placement. The default is read from the environment
+ * variable HL_THREAD_AFFINITY, which may be "none", "compact" or
+ * "scatter", and is none if it is not set. Workers that already exist
+ * keep their placement, so call this before running any pipelines,
+ * or after halide_shutdown_thread_pool. Pinning is supported on
+ * Linux, and on Windows for the cpus of the first processor group. It
+ * is not supported on other platforms, where this setting is
+ * ignored. The thread that calls into a pipeline is never pinned.
+ *
+ * When the workers are pinned to more than one NUMA node, the default
+ * halide_do_par_for splits each parallel loop into one contiguous
+ * slice per node, and the workers of a node run its slice before
+ * helping with the others. Parallel loops over the same range are
+ * split the same way. The default allocator does not touch the memory
+ * it returns, so the rows of a buffer a parallel loop writes are
+ * placed on the node that wrote them, and are local to the workers
+ * that read them in the next parallel loop over those rows.
+ */
+extern int halide_set_thread_affinity(int affinity);
+
 /** Halide calls these functions to allocate and free memory. To
  * replace in AOT code, use the halide_set_custom_malloc and
  * halide_set_custom_free, or (on platforms that support weak
@@ -840,6 +913,24 @@ extern void halide_set_gpu_device(int n);
  * HL_GPU_DEVICE. */
 extern int halide_get_gpu_device(void *user_context);
 
+/** Set the memory budget, in bytes, checked on entry by pipelines
+ * compiled with the memory_budget target feature, and the number of
+ * iterations of each parallel loop they should assume run at once. A
+ * budget of zero means no limit, and a thread count of zero means the
+ * number of threads the thread pool uses (see
+ * halide_set_num_threads). If never called, Halide uses the
+ * environment variable HL_MEMORY_BUDGET, which may have a k, m, or g
+ * suffix, read the first time a pipeline checks its budget. */
+extern void halide_set_memory_budget(uint64_t bytes, int threads);
+
+/** Halide calls these functions to get the memory budget and thread
+ * count described above. Implement them yourself to use a different
+ * budget per user_context. */
+// @{
+extern uint64_t halide_get_memory_budget(void *user_context);
+extern int halide_get_memory_budget_threads(void *user_context);
+// @}
+
 /** Set the soft maximum amount of memory, in bytes, that the LRU
  *  cache will use to memoize Func results.  This is not a strict
  *  maximum in that concurrency and simultaneous use of memoized
@@ -1131,6 +1222,11 @@ enum halide_error_code_t {
      * by zero was evaluated. */
     halide_error_code_integer_division_by_zero = -44,
 
+    /** A pipeline compiled with the memory_budget target feature
+     * would have needed more memory than the budget given by
+     * halide_get_memory_budget. */
+    halide_error_code_memory_budget_exceeded = -45,
+
 };
 
 /** Halide calls the functions below on various error conditions. The
@@ -1210,6 +1306,8 @@ extern int halide_error_device_interface_no_device(void *user_context);
 extern int halide_error_host_and_device_dirty(void *user_context);
 extern int halide_error_buffer_is_null(void *user_context, const char *routine);
 extern int halide_error_integer_division_by_zero(void *user_context);
+extern int halide_error_memory_budget_exceeded(void *user_context, const char *pipeline_name,
+                                               uint64_t required, uint64_t budget);
 // @}
 
 /** Optional features a compilation Target can have.
@@ -1287,7 +1385,15 @@ typedef enum halide_target_feature_t {
     halide_target_feature_check_unsafe_promises = 55, ///< Insert assertions for promises.
     halide_target_feature_hexagon_dma = 56, ///< Enable Hexagon DMA buffers.
     halide_target_feature_embed_bitcode = 57,  ///< Emulate clang -fembed-bitcode flag.
-    halide_target_feature_end = 58 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
+    halide_target_feature_avx512_cascadelake = 58, ///< Enable the AVX512 features supported by Cascade Lake Xeon processors. This includes all of the Skylake features, plus AVX512-VNNI.
+    halide_target_feature_avx512_cooperlake = 59, ///< Enable the AVX512 features supported by Cooper Lake Xeon processors. This includes all of the Cascade Lake features, plus AVX512-BF16.
+    halide_target_feature_arm_dot_prod = 60, ///< Enable ARMv8.2-a dotprod extension (i.e. udot and sdot instructions)
+    halide_target_feature_arm_fp16 = 61, ///< Enable ARMv8.2-a half-precision floating point data processing
+    halide_target_feature_arena_allocations = 62, ///< Pack the heap allocations at each loop level into a single allocation.
+    halide_target_feature_memory_budget = 63, ///< Check that the peak memory use of the pipeline fits in the budget given by halide_get_memory_budget.
+    halide_target_feature_multiversion_loops = 64, ///< Emit a second version of vectorized loop nests for dense and aligned input and output buffers.
+    halide_target_feature_relaxed_float16 = 65, ///< On targets without native half-precision arithmetic, keep intermediate Float(16) results in Float(32) instead of rounding each one.
+    halide_target_feature_end = 66 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
 /** This function is called internally by Halide in some situations to determine
@@ -4,8 +4,17 @@
 namespace Halide { namespace Runtime { namespace Internal {
 
 WEAK CpuFeatures halide_get_cpu_features() {
-    // AArch64 has no CPU-specific Features.
-    return CpuFeatures();
+    // We don't know how to detect the ARMv8.2 extensions on this OS
+    // (see aarch64_linux_cpu_features.cpp and
+    // aarch64_osx_cpu_features.cpp for the ones we do), so report
+    // them as unavailable rather than unknown. Otherwise
+    // can_use_target would assume we have them, and a multitarget
+    // pipeline would pick code that may crash with an illegal
+    // instruction.
+    CpuFeatures features;
+    features.set_known(halide_target_feature_arm_dot_prod);
+    features.set_known(halide_target_feature_arm_fp16);
+    return features;
 }
 
 }}} // namespace Halide::Runtime::Internal
@@ -0,0 +1,32 @@
+#include "HalideRuntime.h"
+#include "cpu_features.h"
+
+extern "C" int sysctlbyname(const char *name, void *oldp, size_t *oldlenp,
+                            void *newp, size_t newlen);
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// Whether a hw.optional sysctl says the cpu has a feature. Older
+// versions of the OS don't have the sysctls for newer features, in
+// which case we assume the feature isn't there.
+WEAK bool sysctl_has_feature(const char *name) {
+    int value = 0;
+    size_t size = sizeof(value);
+    return sysctlbyname(name, &value, &size, NULL, 0) == 0 && value != 0;
+}
+
+WEAK CpuFeatures halide_get_cpu_features() {
+    CpuFeatures features;
+    features.set_known(halide_target_feature_arm_dot_prod);
+    features.set_known(halide_target_feature_arm_fp16);
+
+    if (sysctl_has_feature("hw.optional.arm.FEAT_DotProd")) {
+        features.set_available(halide_target_feature_arm_dot_prod);
+    }
+    if (sysctl_has_feature("hw.optional.arm.FEAT_FP16")) {
+        features.set_available(halide_target_feature_arm_fp16);
+    }
+    return features;
+}
+
+}}} // namespace Halide::Runtime::Internal
@@ -9,4 +9,14 @@ WEAK int halide_host_cpu_count() {
     return sysconf(97);
 }
 
+// Leave thread placement to the scheduler, which moves threads between
+// big and little cores as the load changes.
+WEAK int halide_host_cpu_nodes(int *cpu_node, int max_cpus) {
+    return 0;
+}
+
+WEAK int halide_pin_current_thread(int cpu) {
+    return -1;
+}
+
 }
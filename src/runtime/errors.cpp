@@ -290,4 +290,12 @@ WEAK int halide_error_integer_division_by_zero(void *user_context) {
     return halide_error_code_integer_division_by_zero;
 }
 
+WEAK int halide_error_memory_budget_exceeded(void *user_context, const char *pipeline_name,
+                                             uint64_t required, uint64_t budget) {
+    error(user_context) << "Pipeline " << pipeline_name << " requires up to "
+                        << required << " bytes of memory, which exceeds the budget of "
+                        << budget << " bytes.\n";
+    return halide_error_code_memory_budget_exceeded;
+}
+
 }  // extern "C"
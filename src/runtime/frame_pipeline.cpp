@@ -0,0 +1,162 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+
+// Runs a stream of frames through a sequence of stages as a software
+// pipeline. Each stage is one serial task of a single
+// halide_do_parallel_tasks call, whose iterations are the frames. A
+// stage acquires a semaphore per producer before each frame, which
+// the producer releases when it finishes that frame, and a semaphore
+// counting the free frame slots, which is released when all the
+// stages of a frame are done.
+namespace Halide { namespace Runtime { namespace Internal {
+
+struct frame_pipeline {
+    int num_stages;
+    int max_in_flight;
+
+    // The number of stages still to finish the frame using each slot.
+    int *remaining;
+
+    // One semaphore per stage counting the frame slots it may use.
+    halide_semaphore_t *free_slots;
+};
+
+struct frame_stage {
+    frame_pipeline *pipeline;
+    const halide_frame_stage_t *stage;
+
+    // The semaphores of the consumers of this stage that wait on it.
+    halide_semaphore_t **consumers;
+    int num_consumers;
+};
+
+WEAK int frame_stage_task(void *user_context, int min, int extent,
+                          uint8_t *closure, void *task_parent) {
+    frame_stage *s = (frame_stage *)closure;
+    frame_pipeline *p = s->pipeline;
+    for (int frame = min; frame < min + extent; frame++) {
+        int result = s->stage->fn(user_context, frame, s->stage->closure);
+        if (result != 0) {
+            return result;
+        }
+        for (int i = 0; i < s->num_consumers; i++) {
+            halide_semaphore_release(s->consumers[i], 1);
+        }
+        // The last stage to finish a frame frees its slot for the
+        // frame max_in_flight later. No stage of that frame can run
+        // until the slot is released, so resetting the count first
+        // is safe.
+        int slot = frame % p->max_in_flight;
+        if (__sync_sub_and_fetch(&p->remaining[slot], 1) == 0) {
+            p->remaining[slot] = p->num_stages;
+            for (int i = 0; i < p->num_stages; i++) {
+                halide_semaphore_release(&p->free_slots[i], 1);
+            }
+        }
+    }
+    return 0;
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int halide_do_frames(void *user_context, int num_stages,
+                          const halide_frame_stage_t *stages,
+                          int num_frames, int max_in_flight) {
+    if (num_frames <= 0 || num_stages <= 0) {
+        return 0;
+    }
+    if (max_in_flight < 1) {
+        max_in_flight = 1;
+    }
+    if (max_in_flight > num_frames) {
+        max_in_flight = num_frames;
+    }
+
+    int num_edges = 0;
+    for (int i = 0; i < num_stages; i++) {
+        for (int j = 0; j < stages[i].num_producers; j++) {
+            int producer = stages[i].producers[j];
+            if (producer < 0 || producer >= i) {
+                halide_error(user_context, "halide_do_frames: each stage's producers must be earlier stages.\n");
+                return halide_error_code_generic_error;
+            }
+        }
+        num_edges += stages[i].num_producers;
+    }
+
+    frame_pipeline p;
+    p.num_stages = num_stages;
+    p.max_in_flight = max_in_flight;
+    p.remaining = (int *)__builtin_alloca(sizeof(int) * max_in_flight);
+    p.free_slots = (halide_semaphore_t *)__builtin_alloca(sizeof(halide_semaphore_t) * num_stages);
+    for (int i = 0; i < max_in_flight; i++) {
+        p.remaining[i] = num_stages;
+    }
+
+    // One semaphore per producer-consumer edge, in the order of the
+    // consumers' producer lists.
+    halide_semaphore_t *edges =
+        (halide_semaphore_t *)__builtin_alloca(sizeof(halide_semaphore_t) * (num_edges + 1));
+    halide_semaphore_t **consumers =
+        (halide_semaphore_t **)__builtin_alloca(sizeof(halide_semaphore_t *) * (num_edges + 1));
+    halide_semaphore_acquire_t *acquires =
+        (halide_semaphore_acquire_t *)__builtin_alloca(sizeof(halide_semaphore_acquire_t) * (num_edges + num_stages));
+    frame_stage *closures = (frame_stage *)__builtin_alloca(sizeof(frame_stage) * num_stages);
+    halide_parallel_task_t *tasks =
+        (halide_parallel_task_t *)__builtin_alloca(sizeof(halide_parallel_task_t) * num_stages);
+
+    // Give each stage its slice of the consumer semaphores.
+    int next_consumer = 0;
+    for (int i = 0; i < num_stages; i++) {
+        closures[i].pipeline = &p;
+        closures[i].stage = stages + i;
+        closures[i].consumers = consumers + next_consumer;
+        closures[i].num_consumers = 0;
+        for (int c = i + 1; c < num_stages; c++) {
+            for (int j = 0; j < stages[c].num_producers; j++) {
+                next_consumer += stages[c].producers[j] == i;
+            }
+        }
+    }
+
+    int next_edge = 0, next_acquire = 0;
+    for (int i = 0; i < num_stages; i++) {
+        halide_parallel_task_t &task = tasks[i];
+        task.semaphores = acquires + next_acquire;
+        task.num_semaphores = 0;
+
+        halide_semaphore_init(&p.free_slots[i], max_in_flight);
+        acquires[next_acquire].semaphore = &p.free_slots[i];
+        acquires[next_acquire].count = 1;
+        next_acquire++;
+        task.num_semaphores++;
+
+        for (int j = 0; j < stages[i].num_producers; j++) {
+            halide_semaphore_t *edge = edges + next_edge++;
+            halide_semaphore_init(edge, 0);
+            frame_stage &producer = closures[stages[i].producers[j]];
+            producer.consumers[producer.num_consumers++] = edge;
+            acquires[next_acquire].semaphore = edge;
+            acquires[next_acquire].count = 1;
+            next_acquire++;
+            task.num_semaphores++;
+        }
+
+        task.fn = frame_stage_task;
+        task.closure = (uint8_t *)(closures + i);
+        task.name = NULL;
+        task.min = 0;
+        task.extent = num_frames;
+        task.min_threads = 0;
+        // A stage runs its frames in order, one at a time.
+        task.serial = true;
+    }
+
+    return halide_do_parallel_tasks(user_context, num_stages, tasks, NULL);
+}
+
+}
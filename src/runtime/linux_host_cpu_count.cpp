@@ -1,11 +1,127 @@
 #include "HalideRuntime.h"
+#include "runtime_internal.h"
 
 extern "C" {
 
 extern long sysconf(int);
+extern size_t fread(void *, size_t, size_t, void *);
+extern int sched_setaffinity(int pid, size_t cpusetsize, const void *mask);
+extern int sched_getaffinity(int pid, size_t cpusetsize, void *mask);
 
 WEAK int halide_host_cpu_count() {
     return sysconf(84);
 }
 
 }
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// The largest number of NUMA nodes we look for.
+const int max_nodes = 64;
+
+// Read a small sysfs file into a null-terminated string.
+WEAK bool read_sys_file(const char *path, char *buf, size_t size) {
+    void *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    size_t len = fread(buf, 1, size - 1, f);
+    fclose(f);
+    buf[len] = 0;
+    return true;
+}
+
+// Parse a sysfs list of cpus or nodes (e.g. "0-7,16-23") and mark
+// each one in it as belonging to the given node.
+WEAK void mark_cpu_list(const char *list, int node, int *cpu_node, int max_cpus) {
+    while (*list >= '0' && *list <= '9') {
+        int first = 0, last;
+        while (*list >= '0' && *list <= '9') {
+            first = first * 10 + (*list++ - '0');
+        }
+        last = first;
+        if (*list == '-') {
+            list++;
+            last = 0;
+            while (*list >= '0' && *list <= '9') {
+                last = last * 10 + (*list++ - '0');
+            }
+        }
+        for (int cpu = first; cpu <= last && cpu < max_cpus; cpu++) {
+            cpu_node[cpu] = node;
+        }
+        if (*list == ',') {
+            list++;
+        }
+    }
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK int halide_host_cpu_nodes(int *cpu_node, int max_cpus) {
+    for (int i = 0; i < max_cpus; i++) {
+        cpu_node[i] = -1;
+    }
+    // Node numbers can have gaps (e.g. when a node is offline), so
+    // get the list of them rather than counting up until one is
+    // missing.
+    char online[1024];
+    int nodes = 0;
+    if (Halide::Runtime::Internal::read_sys_file("/sys/devices/system/node/online", online, sizeof(online))) {
+        int node_of[Halide::Runtime::Internal::max_nodes];
+        for (int i = 0; i < Halide::Runtime::Internal::max_nodes; i++) {
+            node_of[i] = -1;
+        }
+        Halide::Runtime::Internal::mark_cpu_list(online, 0, node_of, Halide::Runtime::Internal::max_nodes);
+        for (int node = 0; node < Halide::Runtime::Internal::max_nodes; node++) {
+            if (node_of[node] != 0) {
+                continue;
+            }
+            char path[64];
+            char *dst = halide_string_to_string(path, path + sizeof(path), "/sys/devices/system/node/node");
+            dst = halide_int64_to_string(dst, path + sizeof(path), node, 1);
+            halide_string_to_string(dst, path + sizeof(path), "/cpulist");
+            char list[1024];
+            if (Halide::Runtime::Internal::read_sys_file(path, list, sizeof(list))) {
+                Halide::Runtime::Internal::mark_cpu_list(list, node, cpu_node, max_cpus);
+                nodes = node + 1;
+            }
+        }
+    }
+    // Leave out the cpus this process isn't allowed to run on (e.g. in
+    // a container), because we couldn't pin workers to them.
+    uint64_t allowed[16];
+    if (nodes > 0 && sched_getaffinity(0, sizeof(allowed), allowed) == 0) {
+        for (int i = 0; i < max_cpus; i++) {
+            if (i >= (int)(sizeof(allowed) * 8) || !(allowed[i / 64] & ((uint64_t)1 << (i % 64)))) {
+                cpu_node[i] = -1;
+            }
+        }
+    }
+    if (nodes == 0) {
+        // No NUMA information (e.g. a kernel without NUMA support), so
+        // treat all the cpus as one node.
+        int cpus = halide_host_cpu_count();
+        for (int i = 0; i < cpus && i < max_cpus; i++) {
+            cpu_node[i] = 0;
+        }
+        nodes = 1;
+    }
+    return nodes;
+}
+
+WEAK int halide_pin_current_thread(int cpu) {
+    // Large enough for the default kernel limit of 1024 cpus.
+    uint64_t mask[16];
+    if (cpu < 0 || cpu >= (int)(sizeof(mask) * 8)) {
+        return -1;
+    }
+    memset(mask, 0, sizeof(mask));
+    mask[cpu / 64] = (uint64_t)1 << (cpu % 64);
+    // A pid of zero is the calling thread.
+    return sched_setaffinity(0, sizeof(mask), mask);
+}
+
+}
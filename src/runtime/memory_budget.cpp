@@ -0,0 +1,72 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+#include "scoped_spin_lock.h"
+
+// Runtime settings for the memory budget checked by pipelines compiled
+// with Target::MemoryBudget.
+namespace Halide { namespace Runtime { namespace Internal {
+
+WEAK uint64_t halide_memory_budget = 0;
+WEAK int halide_memory_budget_threads = 0;
+WEAK int halide_memory_budget_lock = 0;
+WEAK bool halide_memory_budget_initialized = false;
+
+// Parse a number of bytes, optionally followed by a k, m, or g suffix.
+WEAK uint64_t parse_memory_size(const char *str) {
+    uint64_t result = 0;
+    while (*str >= '0' && *str <= '9') {
+        result = result * 10 + (*str - '0');
+        str++;
+    }
+    switch (*str) {
+    case 'k':
+    case 'K':
+        result <<= 10;
+        break;
+    case 'm':
+    case 'M':
+        result <<= 20;
+        break;
+    case 'g':
+    case 'G':
+        result <<= 30;
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK void halide_set_memory_budget(uint64_t bytes, int threads) {
+    ScopedSpinLock lock(&halide_memory_budget_lock);
+    halide_memory_budget = bytes;
+    halide_memory_budget_threads = threads;
+    halide_memory_budget_initialized = true;
+}
+
+WEAK uint64_t halide_get_memory_budget(void *user_context) {
+    ScopedSpinLock lock(&halide_memory_budget_lock);
+    if (!halide_memory_budget_initialized) {
+        const char *var = getenv("HL_MEMORY_BUDGET");
+        halide_memory_budget = var ? parse_memory_size(var) : 0;
+        halide_memory_budget_initialized = true;
+    }
+    return halide_memory_budget;
+}
+
+WEAK int halide_get_memory_budget_threads(void *user_context) {
+    {
+        ScopedSpinLock lock(&halide_memory_budget_lock);
+        if (halide_memory_budget_threads > 0) {
+            return halide_memory_budget_threads;
+        }
+    }
+    // Assume parallel loops use all the threads in the thread pool.
+    return halide_get_num_threads();
+}
+
+}
@@ -8,4 +8,13 @@ WEAK int halide_host_cpu_count() {
     return sysconf(58);
 }
 
+// OS X and iOS have no way to pin a thread to a core.
+WEAK int halide_host_cpu_nodes(int *cpu_node, int max_cpus) {
+    return 0;
+}
+
+WEAK int halide_pin_current_thread(int cpu) {
+    return -1;
+}
+
 }
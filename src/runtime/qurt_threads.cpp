@@ -32,6 +32,15 @@ int halide_host_cpu_count() {
     return 4;
 }
 
+// Threads are not pinned on Hexagon.
+WEAK int halide_host_cpu_nodes(int *cpu_node, int max_cpus) {
+    return 0;
+}
+
+WEAK int halide_pin_current_thread(int cpu) {
+    return -1;
+}
+
 #define STACK_SIZE 256*1024
 
 WEAK struct halide_thread *halide_spawn_thread(void (*f)(void *), void *closure) {
@@ -135,6 +135,14 @@ WEAK int halide_profiler_pipeline_start(void *user_context,
                                         int num_funcs,
                                         const uint64_t *func_names);
 WEAK int halide_host_cpu_count();
+// Set cpu_node[i] to the NUMA node of cpu i, or -1 if there is no
+// such cpu or we can't run on it, and return the number of
+// nodes. Returns zero if the cpu topology is unknown.
+WEAK int halide_host_cpu_nodes(int *cpu_node, int max_cpus);
+// Restrict the calling thread to the given cpu. Returns zero on success.
+WEAK int halide_pin_current_thread(int cpu);
+// The number of threads the thread pool runs parallel loops on.
+WEAK int halide_get_num_threads();
 
 WEAK int halide_device_and_host_malloc(void *user_context, struct halide_buffer_t *buf,
                                        const struct halide_device_interface_t *device_interface);
@@ -33,6 +33,10 @@ struct work {
     int sibling_count;
     work *parent_job;
     int threads_reserved;
+
+    // The NUMA node whose workers this job is meant for, or -1 if
+    // any thread may run it.
+    int node;
   
     void *user_context;
     int active_workers;
@@ -88,6 +92,19 @@ WEAK int default_desired_num_threads() {
     return desired_num_threads;
 }
 
+WEAK int default_thread_affinity() {
+    const char *affinity_str = getenv("HL_THREAD_AFFINITY");
+    if (affinity_str && strcmp(affinity_str, "compact") == 0) {
+        return halide_thread_affinity_compact;
+    } else if (affinity_str && strcmp(affinity_str, "scatter") == 0) {
+        return halide_thread_affinity_scatter;
+    }
+    return halide_thread_affinity_none;
+}
+
+#define MAX_CPUS 1024
+#define MAX_NUMA_NODES 64
+
 // The work queue and thread pool is weak, so one big work queue is shared by all halide functions
 struct work_queue_t {
     // all fields are protected by this mutex.
@@ -96,6 +113,11 @@ struct work_queue_t {
     // The desired number threads doing work (HL_NUM_THREADS).
     int desired_threads_working;
 
+    // How worker threads are placed on cpus (HL_THREAD_AFFINITY), and
+    // whether that has been decided yet.
+    int desired_thread_affinity;
+    bool thread_affinity_chosen;
+
     // All fields after this must be zero in the initial state. See assert_zeroed
     // Field serves both to mark the offset in struct and as layout padding.
     int zero_marker;
@@ -126,6 +148,18 @@ struct work_queue_t {
     // Keep track of threads so they can be joined at shutdown
     halide_thread *threads[MAX_THREADS];
 
+    // The cpus to pin new workers to, in the order the workers are
+    // created, and their NUMA nodes. Empty if workers are not pinned.
+    int worker_cpus[MAX_THREADS];
+    int worker_cpu_nodes[MAX_THREADS];
+    int num_worker_cpus;
+
+    // The number of pinned workers on each NUMA node, and the nodes
+    // that have any, in the order their first worker was created.
+    int workers_on_node[MAX_NUMA_NODES];
+    int worker_nodes[MAX_NUMA_NODES];
+    int num_worker_nodes;
+
     // Global flags indicating the threadpool should shut down, and
     // whether the thread pool has been initialized.
     bool shutdown, initialized;
@@ -142,7 +176,7 @@ struct work_queue_t {
 
     // Used to check initial state is correct.
     void assert_zeroed() const {
-        // Assert that all fields except the mutex and desired hreads count are zeroed.
+        // Assert that all fields except the mutex and desired settings are zeroed.
         const char *bytes = ((const char *)&this->zero_marker);
         const char *limit = ((const char *)this) + sizeof(work_queue_t);
         while (bytes < limit && *bytes == 0) {
@@ -163,6 +197,49 @@ struct work_queue_t {
 
 WEAK work_queue_t work_queue = {};
 
+// Choose the cpus that workers are pinned to for the given
+// affinity. Must be called while the work queue is locked.
+WEAK void assign_worker_cpus(int affinity) {
+    work_queue.num_worker_cpus = 0;
+    if (affinity == halide_thread_affinity_none) {
+        return;
+    }
+
+    int cpu_node[MAX_CPUS];
+    int nodes = halide_host_cpu_nodes(cpu_node, MAX_CPUS);
+    if (nodes <= 0) {
+        return;
+    }
+    if (nodes > MAX_NUMA_NODES) {
+        nodes = MAX_NUMA_NODES;
+    }
+
+    // The next cpu to consider on each node.
+    int next_cpu[MAX_NUMA_NODES] = {0};
+    int node = 0, empty_nodes = 0;
+    while (work_queue.num_worker_cpus < MAX_THREADS && empty_nodes < nodes) {
+        int cpu = next_cpu[node];
+        while (cpu < MAX_CPUS && cpu_node[cpu] != node) {
+            cpu++;
+        }
+        if (cpu < MAX_CPUS) {
+            work_queue.worker_cpus[work_queue.num_worker_cpus] = cpu;
+            work_queue.worker_cpu_nodes[work_queue.num_worker_cpus] = node;
+            work_queue.num_worker_cpus++;
+            next_cpu[node] = cpu + 1;
+            empty_nodes = 0;
+            if (affinity == halide_thread_affinity_compact) {
+                // Stay on this node until it runs out of cpus.
+                continue;
+            }
+        } else {
+            next_cpu[node] = MAX_CPUS;
+            empty_nodes++;
+        }
+        node = (node + 1) % nodes;
+    }
+}
+
 #if EXTENDED_DEBUG
 WEAK void print_job(work *job, const char *indent, const char *prefix = NULL) {
     if (prefix == NULL) {
@@ -192,7 +269,10 @@ WEAK void dump_job_state() {
 
 WEAK void worker_thread(void *);
 
-WEAK void worker_thread_already_locked(work *owned_job) {
+// Run jobs until owned_job is done, or until the thread pool shuts
+// down if there is no owned job. node is the NUMA node the calling
+// thread is pinned to, or -1 if it isn't pinned.
+WEAK void worker_thread_already_locked(work *owned_job, int node) {
     while (owned_job ? owned_job->running() : !work_queue.shutdown) {
         work *job = work_queue.jobs;
         work **prev_ptr = &work_queue.jobs;
@@ -220,6 +300,11 @@ WEAK void worker_thread_already_locked(work *owned_job) {
 
         dump_job_state();
 
+        // A runnable job meant for the workers of another node. We
+        // only take it if there is nothing else to do.
+        work *stolen_job = NULL;
+        work **stolen_prev_ptr = NULL;
+
         // Find a job to run, prefering things near the top of the stack.
         while (job) {
             print_job(job, "", "Considering job ");
@@ -257,8 +342,15 @@ WEAK void worker_thread_already_locked(work *owned_job) {
                 log_message("Cannot add worker to job " << job->task.name);
             }              
               
+            bool on_other_node = job->node >= 0 && job->node != node;
+
             if (enough_threads && can_use_this_thread_stack && can_add_worker) {
-                if (job->make_runnable()) {
+                if (on_other_node) {
+                    if (!stolen_job) {
+                        stolen_job = job;
+                        stolen_prev_ptr = prev_ptr;
+                    }
+                } else if (job->make_runnable()) {
                     break;
                 } else {
                      log_message("Cannot acquire semaphores for " << job->task.name);
@@ -268,6 +360,12 @@ WEAK void worker_thread_already_locked(work *owned_job) {
             job = job->next_job;
         }
 
+        if (!job && stolen_job && stolen_job->make_runnable()) {
+            log_message("Stealing job " << stolen_job->task.name << " from node " << stolen_job->node);
+            job = stolen_job;
+            prev_ptr = stolen_prev_ptr;
+        }
+
         if (!job) {
             // There is no runnable job. Go to sleep.
             if (owned_job) {
@@ -382,7 +480,7 @@ WEAK void worker_thread_already_locked(work *owned_job) {
                 log_message("Marking " << job->sibling_count << " siblings ");
                 if (job->siblings[i].exit_status == 0) {
                     job->siblings[i].exit_status = result;
-                    wake_owners |= (job->active_workers == 0 && job->siblings[i].owner_is_sleeping);
+                    wake_owners |= (job->siblings[i].active_workers == 0 && job->siblings[i].owner_is_sleeping);
                 }
                 log_message("Done marking siblings.");
             }
@@ -411,11 +509,34 @@ WEAK void worker_thread_already_locked(work *owned_job) {
 
 WEAK void worker_thread(void *arg) {
     halide_mutex_lock(&work_queue.mutex);
-    worker_thread_already_locked((work *)arg);
+    worker_thread_already_locked((work *)arg, -1);
     halide_mutex_unlock(&work_queue.mutex);
 }
 
-WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_parent) {
+// The argument is cpu * MAX_NUMA_NODES + node.
+WEAK void pinned_worker_thread(void *arg) {
+    int cpu_and_node = (int)(intptr_t)arg;
+    halide_pin_current_thread(cpu_and_node / MAX_NUMA_NODES);
+    halide_mutex_lock(&work_queue.mutex);
+    worker_thread_already_locked(NULL, cpu_and_node % MAX_NUMA_NODES);
+    halide_mutex_unlock(&work_queue.mutex);
+}
+
+WEAK halide_thread *spawn_worker_thread_already_locked() {
+    int n = work_queue.num_worker_cpus;
+    if (n == 0) {
+        return halide_spawn_thread(worker_thread, NULL);
+    }
+    int i = work_queue.threads_created % n;
+    int cpu = work_queue.worker_cpus[i];
+    int node = work_queue.worker_cpu_nodes[i];
+    if (work_queue.workers_on_node[node]++ == 0) {
+        work_queue.worker_nodes[work_queue.num_worker_nodes++] = node;
+    }
+    return halide_spawn_thread(pinned_worker_thread, (void *)(intptr_t)(cpu * MAX_NUMA_NODES + node));
+}
+
+WEAK void initialize_work_queue_already_locked() {
     if (!work_queue.initialized) {
         work_queue.assert_zeroed();
 
@@ -426,8 +547,30 @@ WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_paren
             work_queue.desired_threads_working = default_desired_num_threads();
         }
         work_queue.desired_threads_working = clamp_num_threads(work_queue.desired_threads_working);
+        if (!work_queue.thread_affinity_chosen) {
+            work_queue.desired_thread_affinity = default_thread_affinity();
+            work_queue.thread_affinity_chosen = true;
+        }
+        assign_worker_cpus(work_queue.desired_thread_affinity);
         work_queue.initialized = true;
     }
+}
+
+// Spawn more threads if necessary, either because
+// work_queue.desired_threads_working has increased, or because there
+// aren't enough threads free to run a job that needs min_threads.
+WEAK void spawn_worker_threads_already_locked(int min_threads) {
+    while (work_queue.threads_created < MAX_THREADS &&
+           ((work_queue.threads_created < work_queue.desired_threads_working - 1) ||
+            (work_queue.threads_created + 1) - work_queue.threads_reserved < min_threads)) {
+        work_queue.a_team_size++;
+        work_queue.threads[work_queue.threads_created] = spawn_worker_thread_already_locked();
+        work_queue.threads_created++;
+    }
+}
+
+WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_parent) {
+    initialize_work_queue_already_locked();
 
     // Gather some information about the work.
 
@@ -478,16 +621,7 @@ WEAK void enqueue_work_already_locked(int num_jobs, work *jobs, work *task_paren
             min_threads += 1;
         }
     
-        // Spawn more threads if necessary.
-        while (work_queue.threads_created < MAX_THREADS &&
-               ((work_queue.threads_created < work_queue.desired_threads_working - 1) ||
-                (work_queue.threads_created + 1) - work_queue.threads_reserved < min_threads)) {
-            // We might need to make some new threads, if work_queue.desired_threads_working has
-            // increased, or if there aren't enough threads to complete this new task.
-            work_queue.a_team_size++;
-            work_queue.threads[work_queue.threads_created++] =
-                halide_spawn_thread(worker_thread, NULL);
-        }
+        spawn_worker_threads_already_locked(min_threads);
         log_message("enqueue_work_already_locked top level job " << jobs[0].task.name << " with min_threads " << min_threads << " work_queue.threads_created " << work_queue.threads_created << " work_queue.threads_reserved " << work_queue.threads_reserved);
         if (job_has_acquires || job_may_block) {
             work_queue.threads_reserved++;
@@ -581,30 +715,59 @@ WEAK int halide_default_do_par_for(void *user_context, halide_task_t f,
         return 0;
     }
 
-    work job;
-    job.task.fn = NULL;
-    job.task.min = min;
-    job.task.extent = size;
-    job.task.serial = false;
-    job.task.semaphores = NULL;
-    job.task.num_semaphores = 0;
-    job.task.closure = closure;
-    job.task.min_threads = 0;
-    job.task.name = NULL;
-    job.task_fn = f;
-    job.user_context = user_context;
-    job.exit_status = 0;
-    job.active_workers = 0;
-    job.next_semaphore = 0;
-    job.owner_is_sleeping = false;
-    job.siblings = &job; // guarantees no other job points to the same siblings.
-    job.sibling_count = 0;
-    job.parent_job = NULL;
     halide_mutex_lock(&work_queue.mutex);
-    enqueue_work_already_locked(1, &job, NULL);
-    worker_thread_already_locked(&job);
+
+    // Make the workers first, so that we know which nodes they are on.
+    initialize_work_queue_already_locked();
+    spawn_worker_threads_already_locked(0);
+
+    // If the workers are pinned to more than one NUMA node, split the
+    // loop into one contiguous slice per node, in node order, and
+    // make each slice a job for the workers of that node. A loop over
+    // the same range is always split the same way, so a slice of a
+    // buffer written by one parallel loop is read by the workers of
+    // the same node in the next, and pages placed by first touch stay
+    // local. Threads run slices meant for other nodes only when there
+    // is nothing else for them to do.
+    int num_jobs = 1;
+    if (work_queue.num_worker_nodes > 1 && size >= work_queue.num_worker_nodes) {
+        num_jobs = work_queue.num_worker_nodes;
+    }
+    work *jobs = (work *)__builtin_alloca(sizeof(work) * num_jobs);
+
+    for (int i = 0; i < num_jobs; i++) {
+        int slice_min = min + (int)(((int64_t)size * i) / num_jobs);
+        int slice_max = min + (int)(((int64_t)size * (i + 1)) / num_jobs);
+        work &job = jobs[i];
+        job.task.fn = NULL;
+        job.task.min = slice_min;
+        job.task.extent = slice_max - slice_min;
+        job.task.serial = false;
+        job.task.semaphores = NULL;
+        job.task.num_semaphores = 0;
+        job.task.closure = closure;
+        job.task.min_threads = 0;
+        job.task.name = NULL;
+        job.task_fn = f;
+        job.node = num_jobs > 1 ? work_queue.worker_nodes[i] : -1;
+        job.user_context = user_context;
+        job.exit_status = 0;
+        job.active_workers = 0;
+        job.next_semaphore = 0;
+        job.owner_is_sleeping = false;
+        job.parent_job = NULL;
+    }
+
+    enqueue_work_already_locked(num_jobs, jobs, NULL);
+    int exit_status = 0;
+    for (int i = 0; i < num_jobs; i++) {
+        worker_thread_already_locked(jobs + i, -1);
+        if (jobs[i].exit_status != 0) {
+            exit_status = jobs[i].exit_status;
+        }
+    }
     halide_mutex_unlock(&work_queue.mutex);
-    return job.exit_status;
+    return exit_status;
 }
 
 WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
@@ -620,6 +783,7 @@ WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
         }
         jobs[i].task = *tasks++;
         jobs[i].task_fn = NULL;
+        jobs[i].node = -1;
         jobs[i].user_context = user_context;
         jobs[i].exit_status = 0;
         jobs[i].active_workers = 0;
@@ -638,7 +802,7 @@ WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
     for (int i = 0; i < num_tasks; i++) {
         // It doesn't matter what order we join the tasks in, because
         // we'll happily assist with siblings too.
-        worker_thread_already_locked(jobs + i);
+        worker_thread_already_locked(jobs + i, -1);
         if (jobs[i].exit_status != 0) {
             exit_status = jobs[i].exit_status;
         }
@@ -664,6 +828,33 @@ WEAK int halide_set_num_threads(int n) {
     return old;
 }
 
+WEAK int halide_get_num_threads() {
+    halide_mutex_lock(&work_queue.mutex);
+    if (!work_queue.desired_threads_working) {
+        work_queue.desired_threads_working = default_desired_num_threads();
+    }
+    int n = clamp_num_threads(work_queue.desired_threads_working);
+    halide_mutex_unlock(&work_queue.mutex);
+    return n;
+}
+
+WEAK int halide_set_thread_affinity(int affinity) {
+    if (affinity < halide_thread_affinity_none || affinity > halide_thread_affinity_scatter) {
+        halide_error(NULL, "halide_set_thread_affinity: unknown affinity.");
+        affinity = halide_thread_affinity_none;
+    }
+    halide_mutex_lock(&work_queue.mutex);
+    int old = work_queue.thread_affinity_chosen ? work_queue.desired_thread_affinity : default_thread_affinity();
+    work_queue.desired_thread_affinity = affinity;
+    work_queue.thread_affinity_chosen = true;
+    if (work_queue.initialized) {
+        // Workers created from now on use the new placement.
+        assign_worker_cpus(affinity);
+    }
+    halide_mutex_unlock(&work_queue.mutex);
+    return old;
+}
+
 WEAK void halide_shutdown_thread_pool() {
     if (work_queue.initialized) {
         // Wake everyone up and tell them the party's over and it's time
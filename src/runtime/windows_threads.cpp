@@ -28,6 +28,10 @@ extern WIN32API void DeleteCriticalSection(CriticalSection *);
 extern WIN32API void EnterCriticalSection(CriticalSection *);
 extern WIN32API void LeaveCriticalSection(CriticalSection *);
 extern WIN32API int32_t WaitForSingleObject(Thread, int32_t timeout);
+extern WIN32API Thread GetCurrentThread();
+extern WIN32API uintptr_t SetThreadAffinityMask(Thread, uintptr_t mask);
+extern WIN32API int32_t GetNumaHighestNodeNumber(uint32_t *highest);
+extern WIN32API int32_t GetNumaNodeProcessorMask(uint8_t node, uint64_t *mask);
 
 } // extern "C"
 
@@ -58,6 +62,38 @@ WEAK int halide_host_cpu_count() {
     }
 }
 
+// Affinity masks only cover the cpus of one processor group, so on
+// machines with more than 64 cpus only the first group is used.
+WEAK int halide_host_cpu_nodes(int *cpu_node, int max_cpus) {
+    for (int i = 0; i < max_cpus; i++) {
+        cpu_node[i] = -1;
+    }
+    uint32_t highest = 0;
+    if (!GetNumaHighestNodeNumber(&highest)) {
+        return 0;
+    }
+    for (uint32_t node = 0; node <= highest; node++) {
+        uint64_t mask = 0;
+        if (!GetNumaNodeProcessorMask((uint8_t)node, &mask)) {
+            continue;
+        }
+        for (int cpu = 0; cpu < 64 && cpu < max_cpus; cpu++) {
+            if (mask & ((uint64_t)1 << cpu)) {
+                cpu_node[cpu] = (int)node;
+            }
+        }
+    }
+    return (int)highest + 1;
+}
+
+WEAK int halide_pin_current_thread(int cpu) {
+    if (cpu < 0 || cpu >= (int)(sizeof(uintptr_t) * 8)) {
+        return -1;
+    }
+    // Returns the previous mask, or zero on failure.
+    return SetThreadAffinityMask(GetCurrentThread(), (uintptr_t)1 << cpu) ? 0 : -1;
+}
+
 WEAK halide_thread *halide_spawn_thread(void(*f)(void *), void *closure) {
     spawned_thread *t = (spawned_thread *)malloc(sizeof(spawned_thread));
     t->f = f;
@@ -0,0 +1,82 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int mallocs = 0;
+size_t largest_malloc = 0;
+
+void *my_malloc(void *, size_t sz) {
+    mallocs++;
+    largest_malloc = std::max(largest_malloc, sz);
+    return (uint8_t *)malloc(sz);
+}
+
+void my_free(void *, void *ptr) {
+    free(ptr);
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.has_gpu_feature() || t.has_large_buffers() || t.has_feature(Target::Profile)) {
+        printf("Arenas are not used for this target. Skipping test.\n");
+        printf("Success!\n");
+        return 0;
+    }
+    t.set_feature(Target::ArenaAllocations);
+
+    // A chain of compute_root stages. Each one is only live until
+    // the next one has been computed, so the arena should need only
+    // two slots, not one per stage.
+    const int stages = 8;
+    const int W = 256, H = 128;
+    Var x, y;
+    std::vector<Func> fs(stages);
+    fs[0](x, y) = x + y;
+    for (int i = 1; i < stages; i++) {
+        fs[i](x, y) = fs[i - 1](x, y) * 2 + fs[i - 1](x + 1, y) + i;
+    }
+    for (int i = 0; i < stages; i++) {
+        fs[i].compute_root();
+    }
+    Func out;
+    out(x, y) = fs[stages - 1](x, y);
+
+    out.set_custom_allocator(my_malloc, my_free);
+    Buffer<int> result = out.realize(W, H, t);
+
+    // Compute the correct answer.
+    Buffer<int> correct(W + stages, H);
+    correct.for_each_element([&](int x, int y) { correct(x, y) = x + y; });
+    for (int i = 1; i < stages; i++) {
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W + stages - i; x++) {
+                correct(x, y) = correct(x, y) * 2 + correct(x + 1, y) + i;
+            }
+        }
+    }
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (result(x, y) != correct(x, y)) {
+                printf("result(%d, %d) = %d instead of %d\n", x, y, result(x, y), correct(x, y));
+                return -1;
+            }
+        }
+    }
+
+    if (mallocs != 1) {
+        printf("Expected one allocation for the arena, but there were %d\n", mallocs);
+        return -1;
+    }
+
+    // Two slots of about (W + stages) * H ints each, plus padding.
+    size_t stage_size = (W + stages) * H * sizeof(int);
+    if (largest_malloc > 3 * stage_size) {
+        printf("The arena was %d bytes, but it should have been about %d\n",
+               (int)largest_malloc, (int)(2 * stage_size));
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <string>
+
+using namespace Halide;
+
+// The sequence of Funcs stored to, with consecutive repeats removed.
+std::string store_order;
+
+int my_trace(void *user_context, const halide_trace_event_t *e) {
+    if (e->event == halide_trace_store) {
+        char c = e->func[0];
+        if (store_order.empty() || store_order.back() != c) {
+            store_order += c;
+        }
+    }
+    return 0;
+}
+
+int run_test(bool with_update) {
+    ImageParam input(Int(32), 2);
+    Var x("x"), y("y");
+
+    Func f("f"), g("g"), h("h");
+    f(x, y) = input(x, y) + input(x + 1, y);
+    g(x, y) = input(x, y) * 2 - input(x, y + 1);
+    if (with_update) {
+        g(x, y) += 1;
+    }
+    h(x, y) = f(x, y) + g(x, y);
+
+    f.compute_root().auto_fuse().trace_stores();
+    g.compute_root().auto_fuse().trace_stores();
+
+    const int W = 32, H = 16;
+    Buffer<int> in(W + 1, H + 1);
+    in.for_each_element([&](int x, int y) { in(x, y) = x * 3 + y * 17; });
+    input.set(in);
+
+    store_order.clear();
+    h.set_custom_trace(my_trace);
+    Buffer<int> out = h.realize(W, H);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int f_val = in(x, y) + in(x + 1, y);
+            int g_val = in(x, y) * 2 - in(x, y + 1) + (with_update ? 1 : 0);
+            if (out(x, y) != f_val + g_val) {
+                printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), f_val + g_val);
+                return -1;
+            }
+        }
+    }
+
+    // If f and g were fused along y, their stores alternate row by
+    // row. Otherwise all of one is stored before all of the other.
+    bool fused = store_order.size() > 2;
+    if (fused == with_update) {
+        printf("f and g were %sfused, but should %shave been (store order: %s)\n",
+               fused ? "" : "not ", with_update ? "not " : "", store_order.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (run_test(false) != 0) {
+        return -1;
+    }
+
+    // Funcs with update definitions are never fused.
+    if (run_test(true) != 0) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <thread>
+
+using namespace Halide;
+
+int error_count = 0;
+void my_error_handler(void *user_context, const char *message) {
+    error_count++;
+}
+
+int main(int argc, char **argv) {
+    Param<int> offset("offset");
+    Param<float> scale("scale");
+    ImageParam in(Int(32), 1, "in");
+    Buffer<int> table(16);
+    for (int i = 0; i < 16; i++) {
+        table(i) = i * i;
+    }
+
+    Var x("x");
+    Func f("f");
+    f(x) = Tuple(in(x) + offset + table(x % 16), cast<float>(in(x)) * scale);
+
+    // The order of the arguments doesn't have to match the order
+    // inferred by the pipeline.
+    Callable c = f.compile_to_callable({scale, in, offset});
+    if (c.arguments().size() != 5) {
+        printf("Expected 5 arguments, got %d\n", (int)c.arguments().size());
+        return -1;
+    }
+
+    const int W = 64;
+    Buffer<int> input(W);
+    for (int i = 0; i < W; i++) {
+        input(i) = i * 3;
+    }
+
+    // Call the same Callable from many threads at once, each with
+    // different arguments.
+    const int num_threads = 8;
+    int failures[num_threads] = {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int iter = 0; iter < 100; iter++) {
+                Buffer<int> out0(W);
+                Buffer<float> out1(W);
+                int result = c(2.0f + t, input, t * 10, out0, out1);
+                for (int i = 0; i < W && result == 0; i++) {
+                    if (out0(i) != input(i) + t * 10 + table(i % 16) ||
+                        out1(i) != input(i) * (2.0f + t)) {
+                        failures[t]++;
+                    }
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    for (int t = 0; t < num_threads; t++) {
+        if (failures[t]) {
+            printf("Thread %d got %d incorrect results\n", t, failures[t]);
+            return -1;
+        }
+    }
+
+    // Errors are returned as the exit status when there's a custom
+    // error handler.
+    {
+        Func g("g");
+        g(x) = in(x) * 2;
+        g.set_error_handler(my_error_handler);
+        Callable cg = g.compile_to_callable({in});
+        Buffer<int> small(W / 2), out(W);
+        int result = cg(small, out);
+        if (result == 0 || error_count != 1) {
+            printf("Expected an out of bounds error\n");
+            return -1;
+        }
+        result = cg(input, out);
+        if (result != 0 || out(3) != input(3) * 2) {
+            printf("Unexpected failure\n");
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
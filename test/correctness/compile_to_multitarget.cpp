@@ -1,5 +1,7 @@
 #include "Halide.h"
 #include <stdio.h>
+#include <fstream>
+#include <sstream>
 
 #include "test/common/halide_test_dirs.h"
 
@@ -27,6 +29,78 @@ void testCompileToOutput(Func j) {
     Internal::assert_file_exists(expected_h);
 }
 
+// Variants for different ISAs are kept even when they lower to the
+// same Stmt, while a variant whose extra features don't change the
+// generated code is dropped. The variants that are kept have no argv
+// or metadata entry points of their own; the wrapper provides those.
+void testDistinctVariants() {
+    Target host = get_host_target();
+    if (host.arch != Target::X86 || host.bits != 64) {
+        return;
+    }
+
+    Func f;
+    Var x;
+    ImageParam in(Float(32), 1);
+    f(x) = in(x) * 2.0f + 1.0f;
+    // A fixed vector width, so that every target lowers to the same Stmt.
+    f.vectorize(x, 16);
+
+    std::string fn_object = Internal::get_test_tmp_dir() + "compile_to_multitarget_variants";
+    Target base(host.os, host.arch, host.bits);
+    std::vector<Target> targets = {
+        base.with_feature(Target::AVX512).with_feature(Target::AVX512_Skylake)
+            .with_feature(Target::AVX2).with_feature(Target::AVX).with_feature(Target::FMA)
+            .with_feature(Target::F16C).with_feature(Target::SSE41),
+        base.with_feature(Target::AVX2).with_feature(Target::AVX).with_feature(Target::FMA)
+            .with_feature(Target::F16C).with_feature(Target::SSE41),
+        // Only affects OpenCL, so generates the same code as the baseline.
+        base.with_feature(Target::CLDoubles),
+        base,
+    };
+
+    std::vector<std::string> expected_asm, unexpected_asm, variant_names;
+    for (const Target &t : targets) {
+        std::string suffix = "_" + Internal::replace_all(t.to_string(), "-", "_");
+        std::string asm_file = fn_object + suffix + ".s";
+        Internal::ensure_no_file_exists(asm_file);
+        if (t.has_feature(Target::CLDoubles)) {
+            unexpected_asm.push_back(asm_file);
+        } else {
+            expected_asm.push_back(asm_file);
+            variant_names.push_back("compile_to_multitarget_variants" + suffix);
+        }
+    }
+
+    auto module_producer = [&](const std::string &name, const Target &t) {
+        return f.compile_to_module({in}, name, t);
+    };
+#ifdef _MSC_VER
+    std::string lib = fn_object + ".lib";
+#else
+    std::string lib = fn_object + ".a";
+#endif
+    compile_multitarget("compile_to_multitarget_variants",
+                        Outputs().static_library(lib).assembly(fn_object + ".s"),
+                        targets, module_producer);
+
+    for (size_t i = 0; i < expected_asm.size(); i++) {
+        Internal::assert_file_exists(expected_asm[i]);
+        std::ifstream file(expected_asm[i]);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        for (const char *glue : {"_argv", "_metadata"}) {
+            if (contents.str().find(variant_names[i] + glue) != std::string::npos) {
+                printf("%s contains %s%s\n", expected_asm[i].c_str(), variant_names[i].c_str(), glue);
+                exit(-1);
+            }
+        }
+    }
+    for (const std::string &file : unexpected_asm) {
+        Internal::assert_no_file_exists(file);
+    }
+}
+
 int main(int argc, char **argv) {
     Param<float> factor("factor");
     Func f, g, h, j;
@@ -41,6 +115,7 @@ int main(int argc, char **argv) {
     h.compute_root();
 
     testCompileToOutput(j);
+    testDistinctVariants();
 
     printf("Success!\n");
     return 0;
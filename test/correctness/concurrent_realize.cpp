@@ -0,0 +1,94 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Per-thread state, found by the custom handlers via the user context.
+struct ThreadState {
+    int mallocs = 0;
+    int frees = 0;
+    int errors = 0;
+};
+
+void *my_malloc(void *ctx, size_t size) {
+    ThreadState *state = (ThreadState *)((JITUserContext *)ctx)->user_context;
+    state->mallocs++;
+    void *orig = malloc(size + 128);
+    void *ptr = (void *)((((size_t)orig + 128) >> 7) << 7);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+void my_free(void *ctx, void *ptr) {
+    ThreadState *state = (ThreadState *)((JITUserContext *)ctx)->user_context;
+    state->frees++;
+    free(((void **)ptr)[-1]);
+}
+
+void my_error(void *ctx, const char *message) {
+    ThreadState *state = (ThreadState *)((JITUserContext *)ctx)->user_context;
+    state->errors++;
+}
+
+int main(int argc, char **argv) {
+    Param<int> p("p");
+    Var x("x");
+    Func g("g"), f("f");
+    g(x) = x * p;
+    f(x) = g(x - 1) + g(x + 1);
+    g.compute_root();
+
+    Pipeline pipeline(f);
+    pipeline.compile_jit();
+
+    const int num_threads = 8, W = 1024;
+    ThreadState states[num_threads];
+    int failures[num_threads] = {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            JITUserContext context;
+            context.user_context = &states[t];
+            context.handlers.custom_malloc = my_malloc;
+            context.handlers.custom_free = my_free;
+            context.handlers.custom_error = my_error;
+            for (int iter = 0; iter < 50; iter++) {
+                if (iter & 1) {
+                    // Every other call fails, because the output has
+                    // the wrong type.
+                    Buffer<float> bad(W);
+                    pipeline.realize(&context, bad, Target(), {{p, t}});
+                    continue;
+                }
+                Buffer<int> out(W);
+                pipeline.realize(&context, out, Target(), {{p, t}});
+                for (int i = 0; i < W; i++) {
+                    if (out(i) != 2 * i * t) {
+                        failures[t]++;
+                    }
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        if (failures[t]) {
+            printf("Thread %d got %d incorrect results\n", t, failures[t]);
+            return -1;
+        }
+        if (states[t].mallocs != 25 || states[t].frees != 25 || states[t].errors != 25) {
+            printf("Thread %d: %d mallocs, %d frees, %d errors, instead of 25 of each\n",
+                   t, states[t].mallocs, states[t].frees, states[t].errors);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
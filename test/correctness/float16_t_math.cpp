@@ -0,0 +1,82 @@
+#include "Halide.h"
+#include <cmath>
+#include <stdio.h>
+
+using namespace Halide;
+
+// Check the accuracy of arithmetic on Float(16), whether it is done
+// natively or in Float(32).
+int main(int argc, char **argv) {
+    const int N = 1024;
+
+    Buffer<float16_t> a(N), b(N);
+    for (int i = 0; i < N; i++) {
+        // Values that are exactly representable in half precision.
+        a(i) = float16_t((rand() % 2048 - 1024) / 64.0f);
+        b(i) = float16_t((rand() % 1024 + 1) / 256.0f);
+    }
+
+    Target t = get_jit_target_from_environment();
+    const bool native = t.arch == Target::ARM && t.has_feature(Target::ARMFp16);
+
+    Var x("x");
+    for (bool relaxed : {false, true}) {
+        Target target = relaxed ? t.with_feature(Target::RelaxedFloat16) : t;
+        for (int vector_width : {1, 8, 16}) {
+            Func f("f"), g("g");
+            Expr av = a(x), bv = b(x);
+            f(x) = av * bv + av / bv - sqrt(bv) * min(av, bv);
+            g(x) = select(av > bv, av - bv, bv - av);
+            if (vector_width > 1) {
+                f.vectorize(x, vector_width);
+                g.vectorize(x, vector_width);
+            }
+
+            Buffer<float16_t> f_out = f.realize(N, target);
+            Buffer<float16_t> g_out = g.realize(N, target);
+
+            for (int i = 0; i < N; i++) {
+                double ra = (double)(float)a(i), rb = (double)(float)b(i);
+                double actual = (double)(float)f_out(i);
+
+                if (!relaxed && !native) {
+                    // Each operation should be rounded to half
+                    // precision, just as if it were done natively.
+                    float16_t s = float16_t(std::sqrt((float)b(i)));
+                    float16_t m = a(i) < b(i) ? a(i) : b(i);
+                    float16_t correct = (a(i) * b(i) + a(i) / b(i)) - s * m;
+                    if ((float)f_out(i) != (float)correct) {
+                        printf("f(%d) = %f instead of %f (vector width %d)\n",
+                               i, actual, (float)correct, vector_width);
+                        return -1;
+                    }
+                } else {
+                    // Each operation may or may not round to half
+                    // precision (native code may also fuse multiplies
+                    // and adds), so allow an error of a couple of ulps
+                    // of the magnitude of each term.
+                    double p = ra * rb, q = ra / rb, r = std::sqrt(rb) * std::min(ra, rb);
+                    double correct = p + q - r;
+                    double tolerance = (std::abs(p) + std::abs(q) + std::abs(r)) / 512 + 1e-3;
+                    if (std::abs(actual - correct) > tolerance) {
+                        printf("f(%d) = %f instead of %f (vector width %d%s)\n",
+                               i, actual, correct, vector_width, relaxed ? ", relaxed" : "");
+                        return -1;
+                    }
+                }
+
+                // The difference is a single operation, so it should be
+                // correctly rounded.
+                float16_t correct_g = float16_t((float)std::abs(ra - rb));
+                if ((float)g_out(i) != (float)correct_g) {
+                    printf("g(%d) = %f instead of %f (vector width %d%s)\n",
+                           i, (float)g_out(i), (float)correct_g, vector_width, relaxed ? ", relaxed" : "");
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// The float after 2.0f, which IRPrinter also prints as 2.
+const float nudged_two = 2.00000024f;
+
+class NudgeTwo : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Expr visit(const FloatImm *op) override {
+        if (op->value == 2.0) {
+            return FloatImm::make(op->type, nudged_two);
+        }
+        return op;
+    }
+};
+
+int main(int argc, char **argv) {
+    Func f("f"), g("g");
+    Var x("x"), y("y");
+    f(x, y) = x + y;
+    g(x, y) = f(x, y) + f(x + 1, y);
+
+    // Compile with one schedule, then another, then go back to the
+    // first one.
+    f.compute_root();
+    void *first = g.compile_jit();
+
+    f.compute_at(g, y);
+    void *second = g.compile_jit();
+
+    f.compute_root();
+    void *third = g.compile_jit();
+
+    if (second == first) {
+        printf("Different schedules should have been compiled separately\n");
+        return -1;
+    }
+
+    // Lowering the same schedule again gives the same code, so the
+    // code compiled the first time should be reused.
+    if (third != first) {
+        printf("Returning to a previous schedule should have reused its compiled code\n");
+        return -1;
+    }
+
+    Buffer<int> result = g.realize(100, 100);
+    for (int y = 0; y < 100; y++) {
+        for (int x = 0; x < 100; x++) {
+            int correct = 2 * (x + y) + 1;
+            if (result(x, y) != correct) {
+                printf("result(%d, %d) = %d instead of %d\n", x, y, result(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    // Lowerings that differ only in a float constant that prints the
+    // same way must not share code.
+    {
+        Func h("h");
+        Param<float> p;
+        h(x) = p * 2.0f;
+        p.set(1.0f);
+
+        void *a = h.compile_jit();
+        h.add_custom_lowering_pass(new NudgeTwo);
+        void *b = h.compile_jit();
+        Buffer<float> nudged = h.realize(10);
+        h.clear_custom_lowering_passes();
+        void *c = h.compile_jit();
+        Buffer<float> plain = h.realize(10);
+
+        if (a == b || c != a || nudged(0) != nudged_two || plain(0) != 2.0f) {
+            printf("Lowerings with different float constants should not share code\n");
+            return -1;
+        }
+    }
+
+    // Nor should lowerings that differ in how an update definition is
+    // scheduled.
+    {
+        Func h("h"), k("k");
+        h(x) = x;
+        h(x) += 1;
+        k(x) = h(x) * 2;
+        h.compute_root();
+
+        void *a = k.compile_jit();
+        h.update().vectorize(x, 4);
+        void *b = k.compile_jit();
+        Buffer<int> out = k.realize(10);
+
+        if (a == b || out(3) != 8) {
+            printf("Lowerings with different update schedules should not share code\n");
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Target host = get_jit_target_from_environment();
+    Target base(host.os, host.arch, host.bits);
+    base.set_feature(Target::JIT);
+
+    // Add features few hosts have. If the host does have them, this
+    // target will be chosen instead.
+    Target unlikely = host;
+    bool host_has_unlikely = true;
+    if (host.arch == Target::X86) {
+        unlikely.set_features({Target::AVX512_Cannonlake, Target::AVX512_Cooperlake});
+        host_has_unlikely = get_host_target().features_all_of({Target::AVX512_Cannonlake,
+                                                               Target::AVX512_Cooperlake});
+    } else if (host.arch == Target::ARM) {
+        unlikely.set_features({Target::ARMDotProd, Target::ARMFp16});
+        host_has_unlikely = get_host_target().features_all_of({Target::ARMDotProd,
+                                                               Target::ARMFp16});
+    }
+
+    struct {
+        std::vector<Target> targets;
+        Target expected;
+    } cases[] = {
+        {{unlikely, host, base}, host_has_unlikely ? unlikely : host},
+        {{unlikely, base}, host_has_unlikely ? unlikely : base},
+        {{host, base}, host},
+        {{base}, base},
+    };
+
+    Var x("x");
+    for (const auto &c : cases) {
+        Func f("f");
+        f(x) = x * 3 + 1;
+        f.vectorize(x, 8);
+        void *chosen = f.compile_jit(c.targets);
+
+        // Compiling again for the Target we expect to have been chosen
+        // should reuse the code compiled above.
+        void *expected = f.compile_jit(c.expected);
+        if (chosen != expected) {
+            printf("compile_jit did not choose %s\n", c.expected.to_string().c_str());
+            return -1;
+        }
+
+        Buffer<int> out = f.realize(100);
+        for (int i = 0; i < 100; i++) {
+            if (out(i) != i * 3 + 1) {
+                printf("out(%d) = %d instead of %d\n", i, out(i), i * 3 + 1);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
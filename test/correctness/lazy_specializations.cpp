@@ -0,0 +1,94 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Counts the number of times the pipeline is lowered, by counting
+// the producer nodes for the output, and the number of parallel loops
+// in what was lowered.
+int compile_count = 0;
+int parallel_count = 0;
+class CountCompiles : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Stmt visit(const For *op) override {
+        if (op->for_type == ForType::Parallel) {
+            parallel_count++;
+        }
+        return IRMutator2::visit(op);
+    }
+
+    Stmt visit(const ProducerConsumer *op) override {
+        if (op->is_producer && op->name == "f") {
+            compile_count++;
+        }
+        return IRMutator2::visit(op);
+    }
+};
+
+int main(int argc, char **argv) {
+    Param<int> mode("mode");
+    ImageParam in(Int(32), 1, "in");
+    Var x("x");
+    Func f("f");
+    f(x) = in(x) * mode + select(mode == 2, 1, 0);
+    for (int i = 0; i < 8; i++) {
+        f.specialize(mode == i).vectorize(x, 4 << (i % 2));
+    }
+    f.specialize(in.dim(0).stride() == 1);
+
+    Pipeline p(f);
+    p.add_custom_lowering_pass(new CountCompiles);
+    p.set_jit_lazy_specializations();
+
+    Buffer<int> input(64);
+    for (int i = 0; i < 64; i++) {
+        input(i) = i * 7 - 100;
+    }
+    in.set(input);
+
+    // Each distinct set of conditions should be compiled once, the
+    // first time it is used.
+    struct {
+        int mode, expected_compiles;
+    } calls[] = {{1, 1}, {1, 1}, {2, 2}, {1, 2}, {20, 3}, {2, 3}, {20, 3}};
+
+    for (auto c : calls) {
+        mode.set(c.mode);
+        Buffer<int> out = p.realize(64);
+        for (int i = 0; i < 64; i++) {
+            int correct = input(i) * c.mode + (c.mode == 2 ? 1 : 0);
+            if (out(i) != correct) {
+                printf("out(%d) = %d instead of %d for mode %d\n", i, out(i), correct, c.mode);
+                return -1;
+            }
+        }
+        if (compile_count != c.expected_compiles) {
+            printf("Pipeline compiled %d times instead of %d after mode %d\n",
+                   compile_count, c.expected_compiles, c.mode);
+            return -1;
+        }
+    }
+
+    // Variants compiled later from the same lazy cache should use the
+    // schedule the cache was made with, not the current one.
+    f.specialize(mode == 5).parallel(x);
+    mode.set(5);
+    p.realize(64);
+    if (compile_count != 4 || parallel_count != 0) {
+        printf("A schedule change leaked into a previously made lazy cache\n");
+        return -1;
+    }
+
+    // Once the cache is invalidated, the new schedule is used.
+    p.invalidate_cache();
+    p.realize(64);
+    if (compile_count != 5 || parallel_count == 0) {
+        printf("The new schedule was not used after invalidating the cache\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
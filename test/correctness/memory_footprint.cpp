@@ -0,0 +1,133 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Estimate the peak heap use of the lowered pipeline, assuming four
+// threads.
+class EstimateFootprint : public IRMutator2 {
+    Function output;
+
+public:
+    Expr heap;
+
+    EstimateFootprint(Function output) : output(output) {}
+
+    using IRMutator2::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        MemoryFootprint footprint = compute_memory_footprint(s);
+        heap = estimate_memory_footprint(footprint, s, {output}, 4).peak.heap;
+        return s;
+    }
+};
+
+bool check_estimate(Func out, int64_t correct) {
+    EstimateFootprint *pass = new EstimateFootprint(out.function());
+    out.add_custom_lowering_pass(pass);
+    out.compile_jit();
+    const int64_t *heap = as_const_int(pass->heap);
+    if (!heap || *heap != correct) {
+        std::cout << "Estimated peak heap use of " << out.name() << " was "
+                  << pass->heap << " instead of " << correct << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool error_occurred = false;
+void my_error_handler(void *user_context, const char *msg) {
+    printf("%s\n", msg);
+    error_occurred = true;
+}
+
+int main(int argc, char **argv) {
+    const int W = 200, H = 100;
+    Var x("x"), y("y");
+
+    {
+        // Two compute_root stages that are live at the same time.
+        Func g("g"), h("h"), out("out");
+        g(x, y) = x + y;
+        h(x, y) = g(x, y) + g(x + 1, y);
+        out(x, y) = h(x, y) * 2;
+        g.compute_root();
+        h.compute_root();
+        out.estimate(x, 0, W).estimate(y, 0, H);
+
+        // Each heap allocation is padded by one element.
+        int64_t g_size = (W + 1) * H * sizeof(int) + sizeof(int);
+        int64_t h_size = W * H * sizeof(int) + sizeof(int);
+        if (!check_estimate(out, g_size + h_size)) {
+            return -1;
+        }
+    }
+
+    {
+        // A row buffer computed per iteration of a parallel loop.
+        Func g("g"), out("out");
+        g(x, y) = x + y;
+        out(x, y) = g(x, y) + g(x + 1, y);
+        g.compute_at(out, y);
+        out.parallel(y);
+        out.estimate(x, 0, W).estimate(y, 0, H);
+
+        int64_t row_size = (W + 1) * sizeof(int) + sizeof(int);
+        if (!check_estimate(out, 4 * row_size)) {
+            return -1;
+        }
+    }
+
+    Target t = get_jit_target_from_environment();
+    if (t.features_any_of({Target::HVX_64, Target::HVX_128})) {
+        printf("Memory budgets are not supported for this target. Skipping the rest of the test.\n");
+        printf("Success!\n");
+        return 0;
+    }
+
+    {
+        Func g("g"), h("h"), out("out");
+        g(x, y) = x + y;
+        h(x, y) = g(x, y) + g(x + 1, y);
+        out(x, y) = h(x, y) * 2;
+        g.compute_root();
+        h.compute_root();
+        out.set_error_handler(my_error_handler);
+        out.compile_jit(t.with_feature(Target::MemoryBudget));
+
+        // The budget is read from the environment the first time a
+        // pipeline checks it.
+        static char budget[] = "HL_MEMORY_BUDGET=100k";
+        putenv(budget);
+
+        // This needs about 160k, so it should fail.
+        error_occurred = false;
+        out.realize(W, H);
+        if (!error_occurred) {
+            printf("Exceeding the memory budget should have been an error\n");
+            return -1;
+        }
+
+        // A quarter of the size needs about 40k.
+        error_occurred = false;
+        Buffer<int> result = out.realize(W / 2, H / 2);
+        if (error_occurred) {
+            printf("Staying within the memory budget should not have been an error\n");
+            return -1;
+        }
+        for (int y = 0; y < H / 2; y++) {
+            for (int x = 0; x < W / 2; x++) {
+                int correct = (2 * (x + y) + 1) * 2;
+                if (result(x, y) != correct) {
+                    printf("result(%d, %d) = %d instead of %d\n", x, y, result(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "Halide.h"
+#include <set>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// With the multiversion_loops feature, vectorized loops that access
+// input and output buffers get a second version for dense and aligned
+// buffers. Check that the second version is guarded by a check of the
+// stride and alignment of the input, and that we get the right answer
+// whichever version runs.
+
+// Find the condition guarding the aligned version of a loop nest over
+// the buffer "in".
+class FindAlignedVersion : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const IfThenElse *op) override {
+        const LetStmt *let = op->then_case.as<LetStmt>();
+        if (let && let->name == "in.aligned") {
+            condition = op->condition;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    Expr condition;
+};
+
+class CollectVariables : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) override {
+        names.insert(op->name);
+    }
+
+public:
+    std::set<std::string> names;
+};
+
+int check(Func f, ImageParam in, Buffer<float> input, const Target &t, const char *name) {
+    const int W = 256, H = 16;
+    in.set(input);
+    Buffer<float> out = f.realize(W, H, t);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float correct = input(x, y) * 2.0f + input(x + 1, y);
+            if (out(x, y) != correct) {
+                printf("%s: out(%d, %d) = %f instead of %f\n",
+                       name, x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+void fill(Buffer<float> &buf) {
+    buf.for_each_element([&](int x, int y) {
+        buf(x, y) = (float)(x * 3 + y * 7);
+    });
+}
+
+int main(int argc, char **argv) {
+    const int W = 256, H = 16;
+
+    ImageParam in(Float(32), 2, "in");
+    // Let the input have any stride in x, so that the dense case gets
+    // its own version too.
+    in.dim(0).set_stride(Expr());
+
+    Var x("x"), y("y");
+    Func f("f");
+    f(x, y) = in(x, y) * 2.0f + in(x + 1, y);
+    f.vectorize(x, 8);
+
+    Target t = get_jit_target_from_environment();
+    for (bool enabled : {false, true}) {
+        Module m = f.compile_to_module({in}, "f", enabled ? t.with_feature(Target::MultiversionLoops) : t);
+        FindAlignedVersion finder;
+        m.functions()[0].body.accept(&finder);
+        if (finder.condition.defined() != enabled) {
+            std::cout << "Loop over f was " << (finder.condition.defined() ? "" : "not ")
+                      << "multiversioned:\n" << m.functions()[0].body << "\n";
+            return -1;
+        }
+        if (enabled) {
+            // The aligned version must only run when the input is
+            // dense and its host pointer is aligned.
+            CollectVariables vars;
+            finder.condition.accept(&vars);
+            if (!vars.names.count("in.stride.0") || !vars.names.count("in")) {
+                std::cout << "The aligned version of the loop over f is guarded by "
+                          << finder.condition << ", which doesn't check the stride "
+                          << "and alignment of the input\n";
+                return -1;
+            }
+        }
+    }
+
+    t = t.with_feature(Target::MultiversionLoops);
+
+    // Dense, with aligned rows.
+    Buffer<float> dense(W + 8, H);
+    fill(dense);
+    if (check(f, in, dense, t, "dense")) return -1;
+
+    // Dense, but with a host pointer that isn't aligned.
+    Buffer<float> shifted(W + 2, H);
+    shifted.crop(0, 1, W + 1);
+    shifted.translate(0, -1);
+    fill(shifted);
+    if (check(f, in, shifted, t, "misaligned")) return -1;
+
+    // Every other element of a larger buffer.
+    Buffer<float> interleaved(2, W + 1, H);
+    Buffer<float> strided = interleaved.sliced(0, 0);
+    fill(strided);
+    if (check(f, in, strided, t, "strided")) return -1;
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int W = 64, H = 32;
+    ImageParam input(Float(32), 2), previous(Float(32), 2);
+    Var x, y;
+
+    // A running average over a stream of frames.
+    Func avg("avg");
+    avg(x, y) = previous(x, y) * 0.5f + input(x, y) * 0.5f;
+    avg.vectorize(x, 8);
+
+    Pipeline p(avg);
+    p.add_state(avg, previous);
+
+    Buffer<float> frame(W, H);
+    input.set(frame);
+
+    float correct = 0;
+    std::vector<const void *> storage;
+    for (int n = 0; n < 6; n++) {
+        frame.fill((float)(n + 1));
+        Buffer<float> result = p.realize(W, H);
+        correct = correct * 0.5f + (n + 1) * 0.5f;
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (result(x, y) != correct) {
+                    printf("Frame %d: result(%d, %d) = %f instead of %f\n",
+                           n, x, y, result(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+        storage.push_back(result.data());
+    }
+
+    // The state should alternate between two buffers rather than
+    // being copied into new ones.
+    for (size_t n = 2; n < storage.size(); n++) {
+        if (storage[n] != storage[n - 2]) {
+            printf("Frame %d was realized into new storage\n", (int)n);
+            return -1;
+        }
+    }
+
+    // Results the caller keeps must not be overwritten by later calls.
+    {
+        p.reset_state();
+        std::vector<Buffer<float>> results;
+        for (int n = 0; n < 4; n++) {
+            frame.fill((float)(n + 1));
+            results.push_back(p.realize(W, H));
+        }
+        correct = 0;
+        for (int n = 0; n < 4; n++) {
+            correct = correct * 0.5f + (n + 1) * 0.5f;
+            if (results[n](0, 0) != correct) {
+                printf("Kept frame %d: result(0, 0) = %f instead of %f\n",
+                       n, results[n](0, 0), correct);
+                return -1;
+            }
+        }
+    }
+
+    // After a reset, the previous values are zero again.
+    p.reset_state();
+    frame.fill(4.0f);
+    Buffer<float> result = p.realize(W, H);
+    if (result(0, 0) != 2.0f) {
+        printf("After resetting the state, result(0, 0) = %f instead of 2\n", result(0, 0));
+        return -1;
+    }
+
+    // State realized into a bare halide_buffer_t is copied, so the
+    // caller can free it before the next call.
+    {
+        Buffer<float> *out = new Buffer<float>(W, H);
+        frame.fill(6.0f);
+        p.realize(out->raw_buffer());
+        delete out;
+        frame.fill(2.0f);
+        Buffer<float> result = p.realize(W, H);
+        // (2 * 0.5 + 6 * 0.5) * 0.5 + 2 * 0.5
+        if (result(0, 0) != 3.0f) {
+            printf("After realizing into a halide_buffer_t, result(0, 0) = %f instead of 3\n", result(0, 0));
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -159,6 +159,36 @@ int test4(const Target &t) {
     return 0;
 }
 
+int test5(const Target &t) {
+    // An explicit prefetch takes precedence over an automatic one on
+    // the same loop, even if it was scheduled first.
+    auto prefetches = [](bool with_auto_prefetch) {
+        Func f("f"), g("g");
+        Var x("x");
+
+        f(x) = x;
+        g(x) = f(x) * 2;
+
+        f.compute_root();
+        g.prefetch(f, x, 8);
+        if (with_auto_prefetch) {
+            g.auto_prefetch(x);
+        }
+
+        Module m = g.compile_to_module({});
+        CollectPrefetches collect;
+        m.functions()[0].body.accept(&collect);
+        return collect.prefetches;
+    };
+
+    vector<vector<Expr>> expected = prefetches(false);
+    vector<vector<Expr>> result = prefetches(true);
+    if (expected.size() != 1 || !check(expected, result)) {
+        return -1;
+    }
+    return 0;
+}
+
 }  // anonymous namespace
 
 int main(int argc, char **argv) {
@@ -181,6 +211,11 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    printf("Running prefetch test5\n");
+    if (test5(t) != 0) {
+        return -1;
+    }
+
     printf("Success!\n");
     return 0;
 }
@@ -49,6 +49,8 @@ struct Test {
     bool use_avx2{false};
     bool use_avx512{false};
     bool use_avx512_cannonlake{false};
+    bool use_avx512_cascadelake{false};
+    bool use_avx512_cooperlake{false};
     bool use_avx512_knl{false};
     bool use_avx512_skylake{false};
     bool use_avx{false};
@@ -85,7 +87,9 @@ struct Test {
             .with_feature(Target::NoRuntime);
         use_avx512_knl = target.has_feature(Target::AVX512_KNL);
         use_avx512_cannonlake = target.has_feature(Target::AVX512_Cannonlake);
-        use_avx512_skylake = use_avx512_cannonlake || target.has_feature(Target::AVX512_Skylake);
+        use_avx512_cooperlake = target.has_feature(Target::AVX512_Cooperlake);
+        use_avx512_cascadelake = use_avx512_cooperlake || target.has_feature(Target::AVX512_Cascadelake);
+        use_avx512_skylake = use_avx512_cannonlake || use_avx512_cascadelake || target.has_feature(Target::AVX512_Skylake);
         use_avx512 = use_avx512_knl || use_avx512_skylake || use_avx512_cannonlake || target.has_feature(Target::AVX512);
         use_avx2 = use_avx512 || target.has_feature(Target::AVX2);
         use_avx = use_avx2 || target.has_feature(Target::AVX);
@@ -650,6 +654,27 @@ struct Test {
             check("vpmaxsq", 8, max(i64_1, i64_2));
             check("vpminsq", 8, min(i64_1, i64_2));
         }
+        if (use_avx512_cascadelake) {
+            Expr u8_4 = in_u8(x+48), i8_4 = in_i8(x+48), i16_4 = in_i16(x+48);
+            for (int w = 4; w <= 16; w *= 2) {
+                const char *suffix = w == 16 ? "zmm" : w == 8 ? "ymm" : "xmm";
+                check(std::string("vpdpbusd*") + suffix, w,
+                      i32_1 + i32(u8_1) * i8_1 + i32(u8_2) * i8_2 + i32(u8_3) * i8_3 + i32(u8_4) * i8_4);
+                check(std::string("vpdpbusd*") + suffix, w,
+                      i32(u8_1) * i8_1 + i32(u8_2) * i8_2 + i32(u8_3) * i8_3 + i32(u8_4) * i8_4);
+                check(std::string("vpdpwssd*") + suffix, w,
+                      i32_1 + i32(i16_1) * i16_2 + i32(i16_3) * i16_4);
+            }
+        }
+        if (use_avx512_cooperlake) {
+            // bfloat16 values stored in uint16s. Mask off the top bits
+            // of the exponent to keep the values small and finite.
+            auto bf16 = [](Expr e) {
+                return reinterpret<float>(u32(e & 0x3fff) << 16);
+            };
+            Expr u16_4 = in_u16(x+48);
+            check("vdpbf16ps", 16, f32_1 + bf16(u16_1) * bf16(u16_2) + bf16(u16_3) * bf16(u16_4));
+        }
     }
 
     void check_neon_all() {
@@ -1420,6 +1445,29 @@ struct Test {
         // Interleave or deinterleave two vectors. Given that we use
         // interleaving loads and stores, it's hard to hit this op with
         // halide.
+
+        // ARMv8.2 extensions. The dot products are only selected on
+        // AArch64.
+        if (target.has_feature(Target::ARMDotProd) && !arm32) {
+            Expr i8_4 = in_i8(x+48), u8_4 = in_u8(x+48);
+            for (int w = 4; w <= 8; w *= 2) {
+                check("sdot", w,
+                      i32_1 + i32(i8_1) * i8_2 + i32(i8_3) * i8_4 + i32(i8_2) * i8_3 + i32(i8_4) * i8_1);
+                check("udot", w,
+                      u32_1 + u32(u8_1) * u8_2 + u32(u8_3) * u8_4 + u32(u8_2) * u8_3 + u32(u8_4) * u8_1);
+                check("udot", w,
+                      i32(u8_1) * u8_2 + i32(u8_3) * u8_4 + i32(u8_2) * u8_3 + i32(u8_4) * u8_1);
+            }
+        }
+        if (target.has_feature(Target::ARMFp16)) {
+            // Keep the values small, so that products stay finite.
+            Expr f16_1 = cast(Float(16), f32_1 / 64), f16_2 = cast(Float(16), f32_2 / 64);
+            check(arm32 ? "vadd.f16" : "fadd*.8h", 8, f32(f16_1 + f16_2));
+            check(arm32 ? "vsub.f16" : "fsub*.8h", 8, f32(f16_1 - f16_2));
+            check(arm32 ? "vmul.f16" : "fmul*.8h", 8, f32(f16_1 * f16_2));
+            check(arm32 ? "vmin.f16" : "fmin*.8h", 8, f32(min(f16_1, f16_2)));
+            check(arm32 ? "vmax.f16" : "fmax*.8h", 8, f32(max(f16_1, f16_2)));
+        }
     }
 
     void check_hvx_all() {
@@ -0,0 +1,143 @@
+#include "Halide.h"
+#include <algorithm>
+#include <functional>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::ConciseCasts;
+
+// Check that reductions over a vectorized RVar are done with a
+// horizontal reduction, rather than racing on a single store.
+template<typename T>
+bool check(const char *name, Func f, std::function<T(int)> reference) {
+    Buffer<T> out = f.realize(16);
+    for (int x = 0; x < out.width(); x++) {
+        T correct = reference(x);
+        if (out(x) != correct) {
+            printf("%s(%d) = %f instead of %f\n", name, x, (double)out(x), (double)correct);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const int W = 16, R = 64;
+
+    Buffer<uint8_t> a(W * R), b(W * R);
+    Buffer<int16_t> c(W * R), d(W * R);
+    Buffer<int32_t> e(W * R);
+    Buffer<float> g(W * R);
+    for (int i = 0; i < W * R; i++) {
+        a(i) = rand() & 0xff;
+        b(i) = rand() & 0xff;
+        c(i) = (int16_t)(rand() & 0xffff);
+        d(i) = (int16_t)(rand() & 0xffff);
+        e(i) = rand() - RAND_MAX / 2;
+        // Small integers, so that the sums are exact regardless of
+        // the order of the reduction.
+        g(i) = (float)(rand() % 32 - 16);
+    }
+
+    Var x("x");
+    RDom r(0, R);
+    Expr idx = x * R + r;
+
+    for (int vec : {4, 8, 16, 32}) {
+        RVar ro("ro"), ri("ri");
+
+        // A widening sum of bytes.
+        {
+            Func f("sum_u8");
+            f(x) = cast<uint32_t>(0);
+            f(x) += u32(a(idx));
+            f.update().split(r, ro, ri, vec).allow_race_conditions().vectorize(ri);
+            if (!check<uint32_t>("sum_u8", f, [&](int x) {
+                        uint32_t s = 0;
+                        for (int i = 0; i < R; i++) s += a(x * R + i);
+                        return s;
+                    })) {
+                return -1;
+            }
+        }
+
+        // A dot product of 16-bit values.
+        {
+            Func f("dot_i16");
+            f(x) = 0;
+            f(x) += i32(c(idx)) * i32(d(idx));
+            f.update().split(r, ro, ri, vec).allow_race_conditions().vectorize(ri);
+            if (!check<int32_t>("dot_i16", f, [&](int x) {
+                        uint32_t s = 0;
+                        for (int i = 0; i < R; i++) s += (uint32_t)((int32_t)c(x * R + i) * d(x * R + i));
+                        return (int32_t)s;
+                    })) {
+                return -1;
+            }
+        }
+
+        // A dot product of unsigned and signed bytes.
+        {
+            Func f("dot_u8_i8");
+            f(x) = 0;
+            f(x) += i32(a(idx)) * i32(i8(b(idx)));
+            f.update().split(r, ro, ri, vec).allow_race_conditions().vectorize(ri);
+            if (!check<int32_t>("dot_u8_i8", f, [&](int x) {
+                        int32_t s = 0;
+                        for (int i = 0; i < R; i++) s += (int32_t)a(x * R + i) * (int8_t)b(x * R + i);
+                        return s;
+                    })) {
+                return -1;
+            }
+        }
+
+        // Min and max.
+        {
+            Func f("min_i32"), h("max_i32");
+            f(x) = e.type().max();
+            f(x) = min(f(x), e(idx));
+            f.update().split(r, ro, ri, vec).allow_race_conditions().vectorize(ri);
+            h(x) = e.type().min();
+            h(x) = max(h(x), e(idx));
+            h.update().split(r, ro, ri, vec).allow_race_conditions().vectorize(ri);
+            if (!check<int32_t>("min_i32", f, [&](int x) {
+                        int32_t s = e(x * R);
+                        for (int i = 0; i < R; i++) s = std::min(s, e(x * R + i));
+                        return s;
+                    }) ||
+                !check<int32_t>("max_i32", h, [&](int x) {
+                        int32_t s = e(x * R);
+                        for (int i = 0; i < R; i++) s = std::max(s, e(x * R + i));
+                        return s;
+                    })) {
+                return -1;
+            }
+        }
+
+        // Float sums and products.
+        {
+            Func f("sum_f32"), h("prod_f32");
+            f(x) = 0.0f;
+            f(x) += g(idx);
+            f.update().split(r, ro, ri, vec).allow_race_conditions().vectorize(ri);
+            h(x) = 1.0f;
+            h(x) *= select(g(idx) > 0, 2.0f, 1.0f);
+            h.update().split(r, ro, ri, vec).allow_race_conditions().vectorize(ri);
+            if (!check<float>("sum_f32", f, [&](int x) {
+                        float s = 0.0f;
+                        for (int i = 0; i < R; i++) s += g(x * R + i);
+                        return s;
+                    }) ||
+                !check<float>("prod_f32", h, [&](int x) {
+                        float s = 1.0f;
+                        for (int i = 0; i < R; i++) s *= g(x * R + i) > 0 ? 2.0f : 1.0f;
+                        return s;
+                    })) {
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
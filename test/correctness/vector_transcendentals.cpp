@@ -0,0 +1,175 @@
+#include "Halide.h"
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <string.h>
+
+using namespace Halide;
+
+// Vectorized sin, cos, tan, atan, atan2, and tanh use polynomial
+// approximations instead of calling libm once per lane. Check that
+// they're accurate to within a few ulp, that large arguments, nans
+// and infinities are handled, and that strict_float gets the libm
+// versions instead.
+
+// The distance between two floats in units in the last place.
+int ulp_distance(float a, float b) {
+    int32_t ia, ib;
+    memcpy(&ia, &a, 4);
+    memcpy(&ib, &b, 4);
+    // Make the bit patterns of negative floats ordered too.
+    if (ia < 0) ia = INT32_MIN - ia;
+    if (ib < 0) ib = INT32_MIN - ib;
+    return (int)std::min<int64_t>(std::abs((int64_t)ia - (int64_t)ib), INT32_MAX);
+}
+
+// Near a root, the reduction of the argument modulo pi/2 limits the
+// relative accuracy, so also accept a small absolute error.
+bool close_enough(float result, double correct, int max_ulps) {
+    return (ulp_distance(result, (float)correct) <= max_ulps ||
+            std::abs(result - correct) <= max_ulps * std::ldexp(1.0, -24));
+}
+
+int check(const char *name, Buffer<float> result, Buffer<float> a, Buffer<float> b,
+          double (*correct)(double, double), int max_ulps) {
+    int worst = 0;
+    for (int i = 0; i < result.width(); i++) {
+        double c = correct(a(i), b(i));
+        if (!close_enough(result(i), c, max_ulps)) {
+            printf("%s(%1.10f, %1.10f) = %1.10f instead of %1.10f\n",
+                   name, a(i), b(i), result(i), c);
+            return -1;
+        }
+        worst = std::max(worst, ulp_distance(result(i), (float)c));
+    }
+    printf("%s: worst error %d ulp\n", name, worst);
+    return 0;
+}
+
+double sin_ref(double x, double) { return std::sin(x); }
+double cos_ref(double x, double) { return std::cos(x); }
+double tan_ref(double x, double) { return std::tan(x); }
+double atan_ref(double x, double) { return std::atan(x); }
+double atan2_ref(double y, double x) { return std::atan2(y, x); }
+double tanh_ref(double x, double) { return std::tanh(x); }
+
+int main(int argc, char **argv) {
+    const int N = 1 << 18;
+
+    // Evenly spaced inputs in [-100, 100], and a second input in a
+    // different order for atan2.
+    Buffer<float> a(N), b(N), small(N);
+    for (int i = 0; i < N; i++) {
+        a(i) = -100.0f + (200.0f * i) / N;
+        b(i) = -100.0f + (200.0f * ((i * 7919) % N)) / N;
+        small(i) = a(i) * 0.1f;
+    }
+
+    Var x;
+    struct Test {
+        const char *name;
+        Expr e;
+        Buffer<float> a, b;
+        double (*correct)(double, double);
+        int max_ulps;
+    };
+    std::vector<Test> tests = {
+        {"sin", sin(a(x)), a, a, sin_ref, 3},
+        {"cos", cos(a(x)), a, a, cos_ref, 3},
+        {"tan", tan(a(x)), a, a, tan_ref, 4},
+        {"atan", atan(a(x)), a, a, atan_ref, 4},
+        {"atan2", atan2(a(x), b(x)), a, b, atan2_ref, 4},
+        {"tanh", tanh(small(x)), small, small, tanh_ref, 4},
+    };
+
+    for (const Test &t : tests) {
+        Func f;
+        f(x) = t.e;
+        f.vectorize(x, 8);
+        Buffer<float> result = f.realize(N);
+        if (check(t.name, result, t.a, t.b, t.correct, t.max_ulps)) {
+            return -1;
+        }
+    }
+
+    // Arguments too large for the range reduction fall back to libm,
+    // even when only one lane of a vector is large.
+    Buffer<float> large(N);
+    for (int i = 0; i < N; i++) {
+        float mag = std::pow(10.0f, 3.0f + 27.0f * ((i * 7919) % N) / N);
+        large(i) = (i % 16 == 0) ? a(i) : ((i & 1) ? -mag : mag);
+    }
+    tests = {
+        {"sin (large)", sin(large(x)), large, large, sin_ref, 3},
+        {"cos (large)", cos(large(x)), large, large, cos_ref, 3},
+        {"tan (large)", tan(large(x)), large, large, tan_ref, 4},
+        {"atan (large)", atan(large(x)), large, large, atan_ref, 4},
+        {"atan2 (large)", atan2(large(x), b(x)), large, b, atan2_ref, 4},
+        {"tanh (large)", tanh(large(x)), large, large, tanh_ref, 4},
+    };
+    for (const Test &t : tests) {
+        Func f;
+        f(x) = t.e;
+        f.vectorize(x, 8);
+        Buffer<float> result = f.realize(N);
+        if (check(t.name, result, t.a, t.b, t.correct, t.max_ulps)) {
+            return -1;
+        }
+    }
+
+    // Nans should propagate, and infinities should give the same
+    // results as libm. atan2 of two infinities is documented as nan,
+    // so only one of its arguments is ever infinite here.
+    const float inf = INFINITY, nan = NAN;
+    const int S = 16;
+    Buffer<float> special_a(S), special_b(S);
+    const float sa[S] = {nan, inf, -inf, 0.5f, nan, -2.0f, inf, 1e5f,
+                         0.0f, nan, -inf, 3.0f, 1.0f, 2.0f, -1.0f, 8.0f};
+    const float sb[S] = {1.0f, 1.0f, -1.0f, nan, nan, inf, 2.0f, -inf,
+                         nan, 0.0f, 0.0f, -inf, 1.0f, -3.0f, nan, 4.0f};
+    for (int i = 0; i < S; i++) {
+        special_a(i) = sa[i];
+        special_b(i) = sb[i];
+    }
+    tests = {
+        {"sin", sin(special_a(x)), special_a, special_a, sin_ref, 3},
+        {"cos", cos(special_a(x)), special_a, special_a, cos_ref, 3},
+        {"tan", tan(special_a(x)), special_a, special_a, tan_ref, 4},
+        {"atan", atan(special_a(x)), special_a, special_a, atan_ref, 4},
+        {"atan2", atan2(special_a(x), special_b(x)), special_a, special_b, atan2_ref, 4},
+        {"tanh", tanh(special_a(x)), special_a, special_a, tanh_ref, 4},
+    };
+    for (const Test &t : tests) {
+        Func f;
+        f(x) = t.e;
+        f.vectorize(x, 8);
+        Buffer<float> result = f.realize(S);
+        for (int i = 0; i < S; i++) {
+            double c = t.correct(t.a(i), t.b(i));
+            bool ok = std::isnan(c) ? std::isnan(result(i)) : close_enough(result(i), c, t.max_ulps);
+            if (!ok) {
+                printf("%s(%f, %f) = %f instead of %f\n",
+                       t.name, t.a(i), t.b(i), result(i), c);
+                return -1;
+            }
+        }
+    }
+
+    // With strict_float, we should get exactly what libm gives us.
+    Target strict = get_jit_target_from_environment().with_feature(Target::StrictFloat);
+    Func f;
+    f(x) = sin(a(x)) + atan2(a(x), b(x));
+    f.vectorize(x, 8);
+    Buffer<float> result = f.realize(N, strict);
+    for (int i = 0; i < N; i++) {
+        float correct = sinf(a(i)) + atan2f(a(i), b(i));
+        if (result(i) != correct) {
+            printf("With strict_float, sin(%f) + atan2(%f, %f) = %1.10f instead of %1.10f\n",
+                   a(i), a(i), b(i), result(i), correct);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+
+#include "HalideBuffer.h"
+#include "batch.h"
+
+using namespace Halide::Runtime;
+
+int main(int argc, char **argv) {
+    const int W = 64, H = 32, N = 8;
+
+    // The pipeline reads one pixel beyond each edge of the output.
+    Buffer<float> input(W + 2, H + 2, N);
+    input.set_min(-1, -1, 0);
+    input.for_each_element([&](int x, int y, int n) {
+        input(x, y, n) = (float)((x * 3 + y * 5 + n * 7) % 17);
+    });
+    Buffer<float> output(W, H, N);
+
+    int result = batch(input, 2.0f, output);
+    if (result != 0) {
+        printf("batch returned %d\n", result);
+        return -1;
+    }
+
+    for (int n = 0; n < N; n++) {
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                float correct = 0;
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        correct += input(x + dx, y + dy, n);
+                    }
+                }
+                correct *= 2.0f;
+                if (output(x, y, n) != correct) {
+                    printf("output(%d, %d, %d) = %f instead of %f\n",
+                           x, y, n, output(x, y, n), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A bounds query should ask for the whole batch, with each
+    // element expanded by the footprint of the pipeline.
+    Buffer<float> query(nullptr, 0, 0, 0);
+    result = batch(query, 2.0f, output);
+    if (result != 0) {
+        printf("bounds query returned %d\n", result);
+        return -1;
+    }
+    if (query.dim(0).min() != -1 || query.dim(0).extent() != W + 2 ||
+        query.dim(1).min() != -1 || query.dim(1).extent() != H + 2 ||
+        query.dim(2).min() != 0 || query.dim(2).extent() != N) {
+        printf("Bad bounds query result: [%d, %d] x [%d, %d] x [%d, %d]\n",
+               query.dim(0).min(), query.dim(0).extent(),
+               query.dim(1).min(), query.dim(1).extent(),
+               query.dim(2).min(), query.dim(2).extent());
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
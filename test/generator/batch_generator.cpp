@@ -0,0 +1,28 @@
+#include "Halide.h"
+
+namespace {
+
+// Written for a single image; compiled with batch=true, so that the
+// Inputs and Outputs get an extra outermost dimension.
+class Batch : public Halide::Generator<Batch> {
+public:
+    Input<Buffer<float>> input{"input", 2};
+    Input<float> scale{"scale"};
+    Output<Buffer<float>> output{"output", 2};
+
+    void generate() {
+        Var x("x"), y("y");
+
+        Func blur_x("blur_x");
+        blur_x(x, y) = input(x - 1, y) + input(x, y) + input(x + 1, y);
+        output(x, y) = (blur_x(x, y - 1) + blur_x(x, y) + blur_x(x, y + 1)) * scale;
+
+        const int v = natural_vector_size<float>();
+        blur_x.compute_root().vectorize(x, v);
+        output.vectorize(x, v);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(Batch, batch)
@@ -0,0 +1,176 @@
+#include "HalideRuntime.h"
+#include "HalideBuffer.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <vector>
+
+#include "frame_pipeline.h"
+
+using namespace Halide::Runtime;
+
+const int W = 64, H = 64;
+const int frames = 32;
+
+// A stream of frames run through three stages: the row sums of the
+// input, computed in C++; the frame_pipeline generator, which adds
+// them to the input; and a last stage that reads both.
+struct Stream {
+    std::vector<Buffer<float>> inputs, row_sums, outputs;
+    std::atomic<int> sums_done[frames], outputs_done[frames];
+    std::atomic<int> in_flight{0}, max_in_flight{0}, last_started{-1};
+    std::atomic<int> next_frame[3];
+    std::atomic<bool> out_of_order{false};
+    int failing_frame = -1;
+
+    void reset() {
+        for (int n = 0; n < frames; n++) {
+            sums_done[n] = 0;
+            outputs_done[n] = 0;
+        }
+        for (int i = 0; i < 3; i++) {
+            next_frame[i] = 0;
+        }
+        in_flight = 0;
+        max_in_flight = 0;
+        last_started = -1;
+        out_of_order = false;
+    }
+
+    // Check that each stage sees its frames in order.
+    void start(int stage, int frame) {
+        if (next_frame[stage]++ != frame) {
+            out_of_order = true;
+        }
+    }
+};
+
+void atomic_max(std::atomic<int> &a, int v) {
+    int prev = a;
+    while (v > prev && !a.compare_exchange_weak(prev, v)) {
+    }
+}
+
+int sum_rows(void *user_context, int frame, uint8_t *closure) {
+    Stream *s = (Stream *)closure;
+    s->start(0, frame);
+    atomic_max(s->last_started, frame);
+    atomic_max(s->max_in_flight, ++s->in_flight);
+    for (int y = 0; y < H; y++) {
+        float sum = 0;
+        for (int x = 0; x < W; x++) {
+            sum += s->inputs[frame](x, y);
+        }
+        s->row_sums[frame](y) = sum;
+    }
+    s->sums_done[frame] = 1;
+    return 0;
+}
+
+int add_sums(void *user_context, int frame, uint8_t *closure) {
+    Stream *s = (Stream *)closure;
+    s->start(1, frame);
+    if (!s->sums_done[frame]) {
+        s->out_of_order = true;
+    }
+    if (frame == s->failing_frame) {
+        return -1;
+    }
+    int ret = frame_pipeline(s->inputs[frame], s->row_sums[frame], s->outputs[frame]);
+    s->outputs_done[frame] = 1;
+    return ret;
+}
+
+int finish(void *user_context, int frame, uint8_t *closure) {
+    Stream *s = (Stream *)closure;
+    s->start(2, frame);
+    if (!s->sums_done[frame] || !s->outputs_done[frame]) {
+        s->out_of_order = true;
+    }
+    s->in_flight--;
+    return 0;
+}
+
+int run(Stream &s, int max_in_flight) {
+    static const int stage_0[] = {0};
+    static const int stages_0_and_1[] = {0, 1};
+    halide_frame_stage_t stages[3] = {
+        {sum_rows, (uint8_t *)&s, nullptr, 0},
+        {add_sums, (uint8_t *)&s, stage_0, 1},
+        {finish, (uint8_t *)&s, stages_0_and_1, 2},
+    };
+    s.reset();
+    return halide_do_frames(nullptr, 3, stages, frames, max_in_flight);
+}
+
+int main(int argc, char **argv) {
+    const int max_in_flight = 4;
+
+    Stream s;
+    for (int n = 0; n < frames; n++) {
+        Buffer<float> in(W, H), sums(H), out(W, H);
+        in.fill((float)n);
+        s.inputs.push_back(in);
+        s.row_sums.push_back(sums);
+        s.outputs.push_back(out);
+    }
+
+    int ret = run(s, max_in_flight);
+    if (ret) {
+        printf("Non zero exit code: %d\n", ret);
+        return -1;
+    }
+
+    if (s.out_of_order) {
+        printf("A stage ran before its producers, or ran its frames out of order\n");
+        return -1;
+    }
+
+    if (s.max_in_flight > max_in_flight) {
+        printf("%d frames were in flight at once, but the limit was %d\n",
+               (int)s.max_in_flight, max_in_flight);
+        return -1;
+    }
+
+    for (int n = 0; n < frames; n++) {
+        float correct = n + (float)n * W;
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (s.outputs[n](x, y) != correct) {
+                    printf("Frame %d: output(%d, %d) = %f instead of %f\n",
+                           n, x, y, s.outputs[n](x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A failing stage's error is returned, and the stages that depend
+    // on it don't run on that frame.
+    s.failing_frame = 5;
+    ret = run(s, max_in_flight);
+    if (ret != -1) {
+        printf("Expected the failing stage's exit code, got %d\n", ret);
+        return -1;
+    }
+    if (s.next_frame[2] > s.failing_frame) {
+        printf("The last stage ran on frame %d, after the failure\n", (int)s.next_frame[2] - 1);
+        return -1;
+    }
+
+    // A failed frame never frees its slot, so with one frame in
+    // flight no later frame starts.
+    ret = run(s, 1);
+    if (ret != -1) {
+        printf("Expected the failing stage's exit code, got %d\n", ret);
+        return -1;
+    }
+    if (s.last_started != s.failing_frame) {
+        printf("Frame %d was started after frame %d failed\n",
+               (int)s.last_started, s.failing_frame);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include "Halide.h"
+
+namespace {
+
+// The second stage of the stream in frame_pipeline_aottest: add the
+// row sums computed by the first stage to each row of the input.
+class FramePipeline : public Halide::Generator<FramePipeline> {
+public:
+    Input<Buffer<float>> input{"input", 2};
+    Input<Buffer<float>> row_sums{"row_sums", 1};
+    Output<Buffer<float>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+
+        output(x, y) = input(x, y) + row_sums(y);
+
+        output.parallel(y);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(FramePipeline, frame_pipeline)
@@ -0,0 +1,106 @@
+#include "HalideRuntime.h"
+#include "HalideBuffer.h"
+
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "thread_affinity.h"
+
+using namespace Halide::Runtime;
+
+// Count the tasks run by workers, and how many of them ran on a
+// worker that isn't pinned to a single cpu.
+std::thread::id main_thread;
+std::atomic<int> worker_tasks{0}, unpinned_worker_tasks{0};
+
+int check_affinity_do_task(void *user_context, halide_task_t f, int idx, uint8_t *closure) {
+#ifdef __linux__
+    if (std::this_thread::get_id() != main_thread) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+            worker_tasks++;
+            if (CPU_COUNT(&cpus) != 1) {
+                unpinned_worker_tasks++;
+            }
+        }
+    }
+#endif
+    return halide_default_do_task(user_context, f, idx, closure);
+}
+
+bool run_and_check(const char *name, bool expect_pinned) {
+    Buffer<int> out(256, 256);
+    worker_tasks = 0;
+    unpinned_worker_tasks = 0;
+    int ret = thread_affinity(out);
+    if (ret) {
+        printf("Non zero exit code with %s affinity: %d\n", name, ret);
+        return false;
+    }
+    if (expect_pinned && unpinned_worker_tasks > 0) {
+        printf("With %s affinity, %d of %d tasks ran on workers that weren't pinned\n",
+               name, (int)unpinned_worker_tasks, (int)worker_tasks);
+        return false;
+    }
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            if (out(x, y) != x * y) {
+                printf("With %s affinity, out(%d, %d) = %d instead of %d\n",
+                       name, x, y, out(x, y), x * y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    halide_set_num_threads(4);
+    main_thread = std::this_thread::get_id();
+    halide_set_custom_do_task(check_affinity_do_task);
+
+    // Workers keep the placement they were created with, so restart
+    // the thread pool for each affinity.
+    const struct {
+        int affinity;
+        const char *name;
+    } affinities[] = {
+        {halide_thread_affinity_scatter, "scatter"},
+        {halide_thread_affinity_compact, "compact"},
+        {halide_thread_affinity_none, "none"},
+    };
+    int previous = halide_set_thread_affinity(halide_thread_affinity_none);
+    for (const auto &a : affinities) {
+        int old = halide_set_thread_affinity(a.affinity);
+        if (old != previous) {
+            printf("halide_set_thread_affinity returned %d instead of %d\n", old, previous);
+            return -1;
+        }
+        previous = a.affinity;
+        if (!run_and_check(a.name, a.affinity != halide_thread_affinity_none)) {
+            return -1;
+        }
+        halide_shutdown_thread_pool();
+    }
+
+    // Changing the affinity while the pool is running only affects
+    // workers created afterwards.
+    halide_set_thread_affinity(halide_thread_affinity_scatter);
+    if (!run_and_check("scatter", true)) {
+        return -1;
+    }
+    halide_set_thread_affinity(halide_thread_affinity_compact);
+    halide_set_num_threads(8);
+    if (!run_and_check("compact", true)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include "Halide.h"
+
+namespace {
+
+class ThreadAffinity : public Halide::Generator<ThreadAffinity> {
+public:
+    Output<Buffer<int>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+
+        output(x, y) = x * y;
+        output.parallel(y);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(ThreadAffinity, thread_affinity)
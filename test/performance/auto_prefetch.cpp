@@ -0,0 +1,69 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// A bandwidth-bound downsample with a large stride between rows, which
+// the hardware prefetcher handles poorly.
+Func make_downsample(ImageParam in) {
+    Var x("x"), y("y");
+    Func f("downsample");
+    Expr sum = 0;
+    for (int dy = 0; dy < 4; dy++) {
+        for (int dx = 0; dx < 4; dx++) {
+            sum += cast<uint16_t>(in(4 * x + dx, 4 * y + dy));
+        }
+    }
+    f(x, y) = cast<uint8_t>(sum / 16);
+    f.vectorize(x, 16);
+    return f;
+}
+
+int main(int argc, char **argv) {
+    const int W = 8192, H = 4096;
+    Buffer<uint8_t> input(W, H);
+    input.for_each_value([](uint8_t &v) { v = rand() & 0xff; });
+
+    ImageParam in(UInt(8), 2);
+    in.set(input);
+
+    Func no_prefetch = make_downsample(in);
+    Func auto_prefetch = make_downsample(in);
+    auto_prefetch.auto_prefetch(Var("y"));
+
+    Buffer<uint8_t> out1(W / 4, H / 4), out2(W / 4, H / 4);
+    no_prefetch.compile_jit();
+    auto_prefetch.compile_jit();
+
+    double t1 = benchmark([&]() {
+        no_prefetch.realize(out1);
+    });
+    double t2 = benchmark([&]() {
+        auto_prefetch.realize(out2);
+    });
+
+    for (int y = 0; y < out1.height(); y++) {
+        for (int x = 0; x < out1.width(); x++) {
+            if (out1(x, y) != out2(x, y)) {
+                printf("out1(%d, %d) = %d, out2(%d, %d) = %d\n",
+                       x, y, out1(x, y), x, y, out2(x, y));
+                return -1;
+            }
+        }
+    }
+
+    printf("No prefetch:   %f ms\n", t1 * 1e3);
+    printf("Auto prefetch: %f ms\n", t2 * 1e3);
+
+    // Prefetching is a hint, and its benefit depends heavily on the
+    // machine, so only fail if it made things much worse.
+    if (t2 > t1 * 1.5) {
+        printf("Automatic prefetching made the pipeline much slower.\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
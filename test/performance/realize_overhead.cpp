@@ -129,6 +129,20 @@ int main(int argc, char **argv) {
         std::cout << "One argument Pipeline realize reusing Realization/Target/ParamMap time " << t * 1e6 << "us.\n";
     }
 
+    {
+        Func f;
+        Param<int> in;
+
+        f() = in + 42;
+
+        Callable c = f.compile_to_callable({in});
+
+        auto buf = Buffer<int32_t>::make_scalar();
+        int val = 0;
+        double t = benchmark([&]() { c(val, buf); });
+        std::cout << "One argument Callable call time " << t * 1e6 << "us.\n";
+    }
+
     for (int i = 10; i < 100; i += 10) {
         Func f;
         std::vector<Param<int>> params(i);
@@ -145,6 +159,17 @@ int main(int argc, char **argv) {
         auto buf = Buffer<int32_t>::make_scalar();
         double t = benchmark([&]() { f.realize(buf); });
         std::cout << std::to_string(i) << "-argument Func realize to Buffer time " << t * 1e6 << "us.\n";
+
+        std::vector<Argument> args(params.begin(), params.end());
+        Callable c = f.compile_to_callable(args);
+        std::vector<Callable::Arg> call_args;
+        int val = 1;
+        for (size_t j = 0; j < params.size(); j++) {
+            call_args.push_back(val);
+        }
+        call_args.push_back(buf);
+        t = benchmark([&]() { c.call(call_args.size(), call_args.data()); });
+        std::cout << std::to_string(i) << "-argument Callable call time " << t * 1e6 << "us.\n";
     }
 
     std::cout << "Success!\n";
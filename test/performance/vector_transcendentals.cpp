@@ -0,0 +1,68 @@
+#include "Halide.h"
+#include <cstdio>
+#include <cmath>
+#include "halide_benchmark.h"
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// Wrap libm, so that we can compare against calling it once per
+// element.
+extern "C" DLLEXPORT float sin_ref(float x) {
+    return sinf(x);
+}
+HalideExtern_1(float, sin_ref, float);
+
+extern "C" DLLEXPORT float atan2_ref(float y, float x) {
+    return atan2f(y, x);
+}
+HalideExtern_2(float, atan2_ref, float, float);
+
+extern "C" DLLEXPORT float tanh_ref(float x) {
+    return tanhf(x);
+}
+HalideExtern_1(float, tanh_ref, float);
+
+int main(int argc, char **argv) {
+    Var x, y;
+    Expr u = (x - 1024) / 64.0f;
+    Expr v = (y - 384) / 32.0f;
+
+    struct Test {
+        const char *name;
+        Expr ref, vec;
+    } tests[] = {
+        {"sin", sin_ref(u + v), sin(u + v)},
+        {"atan2", atan2_ref(v, u), atan2(v, u)},
+        {"tanh", tanh_ref(u * v), tanh(u * v)},
+    };
+
+    Buffer<float> timing_scratch(2048, 768);
+    for (const Test &t : tests) {
+        Func f, g;
+        f(x, y) = t.ref;
+        g(x, y) = t.vec;
+        f.vectorize(x, 8);
+        g.vectorize(x, 8);
+        f.compile_jit();
+        g.compile_jit();
+
+        double t_ref = benchmark([&]() { f.realize(timing_scratch); });
+        double t_vec = benchmark([&]() { g.realize(timing_scratch); });
+
+        int N = timing_scratch.width() * timing_scratch.height();
+        // Some libms are vectorized themselves, so just report the
+        // timings rather than requiring the approximation to win.
+        printf("%s: libm %f ns per pixel, Halide %f ns per pixel\n",
+               t.name, 1e9 * t_ref / N, 1e9 * t_vec / N);
+    }
+
+    printf("Success!\n");
+    return 0;
+}